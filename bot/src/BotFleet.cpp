@@ -0,0 +1,160 @@
+#include "BotFleet.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * @brief Constructs a worker without bots.
+ *
+ * @param server Endpoints of the server.
+ * @param script The inputs the bots hold.
+ * @param hello The HELLO the bots open their sessions with.
+ */
+BotFleet::Worker::Worker(const asio::ip::tcp::resolver::results_type& server, const InputScript& script, const Protocol::HelloPayload& hello)
+    : io_context(1),
+      context{io_context, stats, script, server, hello, std::vector<std::uint8_t>(Datagram::MAX_SIZE),
+              std::vector<std::uint8_t>(SnapshotStream::PACKET_DATAGRAM_SIZE)},
+      timer(io_context) {}
+
+/**
+ * @brief Creates the bots, not connected yet.
+ *
+ * Bot i runs on worker i % threads, so the load stays balanced while the fleet ramps up.
+ *
+ * @param host The server's IP address or hostname.
+ * @param port The server's port.
+ * @param script The inputs every bot holds.
+ * @param options How many bots to run and how.
+ */
+BotFleet::BotFleet(const std::string& host, const std::string& port, const InputScript& script, const FleetOptions& options)
+    : options_(options) {
+    asio::io_context resolverContext;
+    asio::ip::tcp::resolver resolver(resolverContext);
+    asio::ip::tcp::resolver::results_type server = resolver.resolve(host, port);
+
+    unsigned threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, std::max<std::size_t>(options.sessions, 1)));
+    Protocol::HelloPayload hello;
+    hello.capabilities = options.capabilities;
+    for (unsigned i = 0; i < threads; ++i)
+        workers_.push_back(std::make_unique<Worker>(server, script, hello));
+    for (std::size_t i = 0; i < options.sessions; ++i) {
+        Worker& worker = *workers_[i % threads];
+        worker.sessions.push_back(std::make_unique<BotSession>(worker.context, options.seed + static_cast<std::uint32_t>(i)));
+    }
+    double perTick = static_cast<double>(options.rampPerSecond) * Protocol::TICK_INTERVAL_MS / 1000.0 / threads;
+    startsPerTick_ = std::max<std::size_t>(1, static_cast<std::size_t>(perTick));
+}
+
+/**
+ * @brief Stops every thread; the bots are destroyed once no handler can run anymore.
+ */
+BotFleet::~BotFleet() {
+    for (std::unique_ptr<Worker>& worker : workers_)
+        worker->io_context.stop();
+    for (std::unique_ptr<Worker>& worker : workers_) {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+/**
+ * @brief Connects the bots and reports every second until the run ends.
+ *
+ * A summary of the whole run is printed at the end, with per-bot rates averaged over the
+ * bots connected each second.
+ */
+void BotFleet::run() {
+    std::cout << "Running " << options_.sessions << " bot(s) on " << workers_.size() << " thread(s)." << std::endl;
+    for (std::unique_ptr<Worker>& worker : workers_) {
+        Worker* running = worker.get();
+        running->nextTick = std::chrono::steady_clock::now();
+        asio::post(running->io_context, [this, running]() { tick(*running); });
+        running->thread = std::thread([running]() { running->io_context.run(); });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    LoadSample first = sample();
+    LoadSample previous = first;
+    auto previousTime = start;
+    std::uint64_t connectedSeconds = 0;
+    unsigned second = 1;
+    for (; options_.durationSeconds == 0 || second <= options_.durationSeconds; ++second) {
+        std::this_thread::sleep_until(start + std::chrono::seconds(second));
+        auto now = std::chrono::steady_clock::now();
+        LoadSample current = sample();
+        report("[" + std::to_string(second) + "s]", current.since(previous), std::chrono::duration<double>(now - previousTime).count());
+        previous = current;
+        previousTime = now;
+        connectedSeconds += current.connected;
+    }
+    LoadSample total = previous.since(first);
+    total.connected = connectedSeconds / std::max(1u, second - 1);
+    report("Total", total, std::chrono::duration<double>(previousTime - start).count());
+}
+
+/**
+ * @brief Connects the next bots of the ramp and ticks every connected bot.
+ *
+ * Ticks are scheduled at fixed times rather than a fixed interval after the previous one,
+ * so a slow tick does not shift the following ones; ticks missed entirely are skipped.
+ *
+ * @param worker The worker to tick.
+ */
+void BotFleet::tick(Worker& worker) {
+    for (std::size_t i = 0; i < startsPerTick_ && worker.started < worker.sessions.size(); ++i)
+        worker.sessions[worker.started++]->start();
+
+    auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < worker.started; ++i)
+        worker.sessions[i]->tick(now);
+
+    worker.nextTick += std::chrono::milliseconds(Protocol::TICK_INTERVAL_MS);
+    if (worker.nextTick < now)
+        worker.nextTick = now;
+    worker.timer.expires_at(worker.nextTick);
+    worker.timer.async_wait([this, &worker](const asio::error_code& ec) {
+        if (!ec)
+            tick(worker);
+    });
+}
+
+/**
+ * @brief Sums the counters of every worker.
+ *
+ * @return LoadSample The counters of the whole fleet.
+ */
+LoadSample BotFleet::sample() const {
+    LoadSample total;
+    for (const std::unique_ptr<Worker>& worker : workers_)
+        total += worker->stats.sample();
+    return total;
+}
+
+/**
+ * @brief Prints the activity of an interval.
+ *
+ * The tick rate is the number of snapshots each connected bot received per second, which
+ * matches the server's tick rate as long as it keeps up and no snapshot is lost.
+ *
+ * @param label Prefix of the line.
+ * @param activity The activity over the interval.
+ * @param seconds Length of the interval.
+ */
+void BotFleet::report(const std::string& label, const LoadSample& activity, double seconds) const {
+    if (seconds <= 0.0)
+        return;
+    double connected = static_cast<double>(std::max<std::uint64_t>(activity.connected, 1));
+    double received = static_cast<double>(activity.tcpBytesReceived + activity.udpBytesReceived);
+    std::size_t worst = 0;
+    for (std::size_t i = 0; i < LoadSample::LATENCY_BUCKETS; ++i) {
+        if (activity.latencies[i] > 0)
+            worst = i;
+    }
+    std::cout << std::fixed << std::setprecision(1) << label << " " << activity.connected << "/" << options_.sessions << " connected, tick rate "
+              << static_cast<double>(activity.snapshots) / seconds / connected << " Hz, latency p50 " << activity.latencyPercentile(50.0)
+              << " ms p99 " << activity.latencyPercentile(99.0) << " ms max " << worst << " ms, down " << received / seconds / 1000.0
+              << " kB/s (" << received / seconds / connected << " B/s per bot), up " << static_cast<double>(activity.bytesSent) / seconds / 1000.0
+              << " kB/s, " << activity.staleSnapshots << " stale, " << activity.inputsSkipped << " skipped, " << activity.failures << " failures, "
+              << activity.gamesOver << " games over" << std::endl;
+}
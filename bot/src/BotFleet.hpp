@@ -0,0 +1,113 @@
+#pragma once
+
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BotSession.hpp"
+#include "InputScript.hpp"
+#include "LoadStats.hpp"
+
+/**
+ * @struct FleetOptions
+ * @brief How many bots to run and how.
+ */
+struct FleetOptions {
+    std::size_t sessions = 1;                                 ///< Number of bots.
+    unsigned threads = 0;                                     ///< Threads running the bots; 0 starts one per hardware thread.
+    unsigned rampPerSecond = 200;                             ///< Bots connected per second at startup, sparing the server a connection storm.
+    unsigned durationSeconds = 0;                             ///< Length of the run; 0 runs until the process is killed.
+    std::uint32_t seed = 1;                                   ///< Seed of the bots' random inputs; bot i uses seed + i.
+    std::uint32_t capabilities = Protocol::ALL_CAPABILITIES;  ///< Capabilities the bots offer in HELLO.
+};
+
+/**
+ * @class BotFleet
+ * @brief Runs thousands of bots against one server and reports the load they see.
+ *
+ * The bots are split evenly across threads, each with its own IO context, so a bot's
+ * handlers never run concurrently and need no locking. Each thread ticks all of its bots
+ * from a single timer instead of one timer per bot, and connects them progressively at
+ * startup. Once per second, the counters of every thread are summed and the activity of
+ * the last second is printed.
+ */
+class BotFleet {
+   public:
+    /**
+     * @brief Creates the bots, not connected yet.
+     *
+     * @param host The server's IP address or hostname.
+     * @param port The server's port.
+     * @param script The inputs every bot holds.
+     * @param options How many bots to run and how.
+     */
+    BotFleet(const std::string& host, const std::string& port, const InputScript& script, const FleetOptions& options);
+
+    BotFleet(const BotFleet&) = delete;
+    BotFleet& operator=(const BotFleet&) = delete;
+
+    /**
+     * @brief Stops every thread.
+     */
+    ~BotFleet();
+
+    /**
+     * @brief Connects the bots and reports every second until the run ends.
+     */
+    void run();
+
+   private:
+    /**
+     * @struct Worker
+     * @brief A thread and the bots it runs.
+     */
+    struct Worker {
+        /**
+         * @brief Constructs a worker without bots.
+         *
+         * @param server Endpoints of the server.
+         * @param script The inputs the bots hold.
+         * @param hello The HELLO the bots open their sessions with.
+         */
+        Worker(const asio::ip::tcp::resolver::results_type& server, const InputScript& script, const Protocol::HelloPayload& hello);
+
+        asio::io_context io_context;                        ///< IO context of the worker's bots.
+        LoadStats stats;                                    ///< Counters of the worker's bots.
+        BotContext context;                                 ///< What the worker's bots share.
+        asio::steady_timer timer;                           ///< Fires once per tick.
+        std::chrono::steady_clock::time_point nextTick;     ///< When the next tick is due.
+        std::vector<std::unique_ptr<BotSession>> sessions;  ///< The worker's bots.
+        std::size_t started = 0;                            ///< Number of bots connected so far.
+        std::thread thread;                                 ///< Thread running the IO context.
+    };
+
+    /**
+     * @brief Connects the next bots of the ramp and ticks every connected bot.
+     *
+     * @param worker The worker to tick.
+     */
+    void tick(Worker& worker);
+
+    /**
+     * @brief Sums the counters of every worker.
+     *
+     * @return LoadSample The counters of the whole fleet.
+     */
+    LoadSample sample() const;
+
+    /**
+     * @brief Prints the activity of an interval.
+     *
+     * @param label Prefix of the line.
+     * @param activity The activity over the interval.
+     * @param seconds Length of the interval.
+     */
+    void report(const std::string& label, const LoadSample& activity, double seconds) const;
+
+    FleetOptions options_;                          ///< How many bots to run and how.
+    std::size_t startsPerTick_ = 1;                 ///< Bots each worker connects per tick during the ramp.
+    std::vector<std::unique_ptr<Worker>> workers_;  ///< The threads and their bots.
+};
@@ -0,0 +1,273 @@
+#include "BotSession.hpp"
+
+/**
+ * @brief Constructs an idle session.
+ *
+ * @param context What the bots of the running thread share.
+ * @param seed Seed of the session's random inputs.
+ */
+BotSession::BotSession(BotContext& context, std::uint32_t seed)
+    : context_(context),
+      socket_(context.io_context),
+      udpSocket_(context.io_context),
+      timer_(context.io_context),
+      cursor_(context.script.start(seed)) {}
+
+/**
+ * @brief Connects to the server, starting over from a blank protocol state.
+ */
+void BotSession::start() {
+    active_ = true;
+    assigned_ = false;
+    welcomed_ = false;
+    acknowledged_ = false;
+    writing_ = false;
+    inputSequence_ = 0;
+    receiveFrames_.reset();
+    asio::async_connect(socket_, context_.server, [this](const asio::error_code& ec, const asio::ip::tcp::endpoint&) {
+        if (ec) {
+            fail();
+            return;
+        }
+        asio::error_code error;
+        socket_.set_option(asio::ip::tcp::no_delay(true), error);
+        connected_ = true;
+        LoadStats::add(context_.stats.connects);
+        LoadStats::add(context_.stats.connected);
+        Message::serialize(context_.hello, hello_);
+        writing_ = true;
+        asio::async_write(socket_, asio::buffer(hello_), [this](const asio::error_code& ec, std::size_t length) {
+            writing_ = false;
+            if (ec) {
+                fail();
+                return;
+            }
+            LoadStats::add(context_.stats.bytesSent, length);
+        });
+        startRead();
+    });
+}
+
+/**
+ * @brief Sends the input of the tick, once the server accepted the session.
+ *
+ * An input is skipped rather than queued while the previous one is still being written,
+ * so a congested connection shows up in the skipped count instead of in growing queues.
+ *
+ * @param now The time of the tick.
+ */
+void BotSession::tick(std::chrono::steady_clock::time_point now) {
+    if (!welcomed_)
+        return;
+    if (writing_) {
+        LoadStats::add(context_.stats.inputsSkipped);
+        return;
+    }
+    Protocol::InputPayload input = context_.script.next(cursor_, inputSequence_++);
+    sentAt_[input.sequence % SENT_INPUTS] = now;
+    Message::serialize(input, input_);
+    writing_ = true;
+    asio::async_write(socket_, asio::buffer(input_), [this](const asio::error_code& ec, std::size_t length) {
+        writing_ = false;
+        if (ec) {
+            fail();
+            return;
+        }
+        LoadStats::add(context_.stats.inputsSent);
+        LoadStats::add(context_.stats.bytesSent, length);
+    });
+}
+
+/**
+ * @brief Starts an asynchronous read of server messages.
+ */
+void BotSession::startRead() {
+    std::span<std::uint8_t> space = receiveFrames_.prepare();
+    socket_.async_read_some(asio::buffer(space.data(), space.size()), [this](const asio::error_code& ec, std::size_t length) {
+        if (ec) {
+            fail();
+            return;
+        }
+        LoadStats::add(context_.stats.tcpBytesReceived, length);
+        receiveFrames_.commit(length);
+        if (!receiveFrames_.consume([this](const Message& message) { handleMessage(message); })) {
+            fail();
+            return;
+        }
+        if (active_)
+            startRead();
+    });
+}
+
+/**
+ * @brief Processes a message received over TCP, or an event received over UDP.
+ *
+ * Spawns, deaths and despawns carry nothing a bot needs to track, so they are only counted
+ * as received bytes.
+ *
+ * @param message The message.
+ */
+void BotSession::handleMessage(const Message& message) {
+    if (message.type() == RFC::WELCOME) {
+        Protocol::WelcomePayload welcome;
+        if (!message.decode(welcome) || welcome.version == 0) {
+            fail();
+            return;
+        }
+        welcomed_ = true;
+    }
+    if (message.type() == RFC::STATE_UPDATE) {
+        if (Protocol::decodeStateUpdate(message, decoded_))
+            applySnapshot(decoded_);
+    }
+    if (message.type() == RFC::PLAYER_ASSIGNED) {
+        Protocol::PlayerAssignedPayload assigned;
+        if (message.decode(assigned)) {
+            playerId_ = assigned.entityId;
+            assigned_ = true;
+        }
+    }
+    if (message.type() == RFC::GAME_OVER)
+        LoadStats::add(context_.stats.gamesOver);
+    if (message.type() == RFC::UDP_BIND) {
+        Protocol::UdpBindPayload bind;
+        if (message.decode(bind))
+            this->bind(bind.token);
+    }
+}
+
+/**
+ * @brief Opens the UDP socket and starts binding it to the session.
+ *
+ * @param token The bind token received in a UDP_BIND message.
+ */
+void BotSession::bind(std::uint32_t token) {
+    asio::error_code ec;
+    asio::ip::tcp::endpoint server = socket_.remote_endpoint(ec);
+    if (ec)
+        return;
+    serverEndpoint_ = asio::ip::udp::endpoint(server.address(), server.port());
+    if (!udpSocket_.is_open()) {
+        udpSocket_.open(serverEndpoint_.protocol(), ec);
+        if (ec) {
+            fail();
+            return;
+        }
+        udpSocket_.non_blocking(true, ec);
+        startReceive();
+    }
+    stream_.reset();
+
+    Protocol::UdpBindPayload bind;
+    bind.token = token;
+    SnapshotStream::encodeControl(bind, bindDatagram_);
+    sendBind();
+}
+
+/**
+ * @brief Sends the bind datagram and schedules a retry until the first snapshot arrives.
+ */
+void BotSession::sendBind() {
+    if (stream_.isReceiving() || !udpSocket_.is_open())
+        return;
+    asio::error_code ec;
+    udpSocket_.send_to(asio::buffer(bindDatagram_), serverEndpoint_, 0, ec);
+    LoadStats::add(context_.stats.bytesSent, bindDatagram_.size());
+    timer_.expires_after(std::chrono::milliseconds(BIND_RETRY_MS));
+    timer_.async_wait([this](const asio::error_code& ec) {
+        if (!ec)
+            sendBind();
+    });
+}
+
+/**
+ * @brief Waits asynchronously for the UDP socket to become readable.
+ */
+void BotSession::startReceive() {
+    udpSocket_.async_wait(asio::ip::udp::socket::wait_read, [this](const asio::error_code& ec) {
+        if (ec)
+            return;
+        drain();
+        startReceive();
+    });
+}
+
+/**
+ * @brief Reads every datagram queued on the UDP socket into the thread's shared buffer.
+ */
+void BotSession::drain() {
+    for (;;) {
+        asio::error_code ec;
+        asio::ip::udp::endpoint sender;
+        std::size_t length = udpSocket_.receive_from(asio::buffer(context_.datagramBuffer), sender, 0, ec);
+        if (ec)
+            return;
+        LoadStats::add(context_.stats.udpBytesReceived, length);
+        handleDatagram(std::span<const std::uint8_t>(context_.datagramBuffer.data(), length));
+    }
+}
+
+/**
+ * @brief Hands a datagram to the stream and sends the acknowledgements it produces.
+ *
+ * The stream is the one SnapshotReceiver uses, so the bots drop, rebuild and acknowledge
+ * exactly what the game client does. Events received over UDP go through handleMessage()
+ * like those received over TCP.
+ *
+ * @param datagram The received datagram.
+ */
+void BotSession::handleDatagram(std::span<const std::uint8_t> datagram) {
+    auto send = [this](std::span<const std::uint8_t> reply) {
+        asio::error_code ec;
+        udpSocket_.send_to(asio::buffer(reply.data(), reply.size()), serverEndpoint_, 0, ec);
+        LoadStats::add(context_.stats.bytesSent, reply.size());
+    };
+    auto onSnapshot = [this](const Snapshot& snapshot) { applySnapshot(snapshot); };
+    auto onEvent = [this](const Message& event) { handleMessage(event); };
+    if (!stream_.receive(datagram, SnapshotStream::Clock::now(), context_.reliableBuffer, onSnapshot, onEvent, send))
+        LoadStats::add(context_.stats.staleSnapshots);
+}
+
+/**
+ * @brief Counts a snapshot and measures the latency of the newest input it acknowledges.
+ *
+ * Inputs older than the last SENT_INPUTS have no send time left and are not measured.
+ *
+ * @param snapshot The snapshot.
+ */
+void BotSession::applySnapshot(const Snapshot& snapshot) {
+    LoadStats::add(context_.stats.snapshots);
+    if (!assigned_)
+        return;
+    const Protocol::InputAck* ack = snapshot.findInputAck(playerId_);
+    if (!ack || (acknowledged_ && !Datagram::isNewer(ack->sequence, lastAcknowledged_)))
+        return;
+    acknowledged_ = true;
+    lastAcknowledged_ = ack->sequence;
+    if (inputSequence_ - ack->sequence <= SENT_INPUTS)
+        context_.stats.recordLatency(std::chrono::steady_clock::now() - sentAt_[ack->sequence % SENT_INPUTS]);
+}
+
+/**
+ * @brief Closes the connection and schedules a reconnection.
+ *
+ * Called by every handler that fails; only the first call of a connection has an effect.
+ */
+void BotSession::fail() {
+    if (!active_)
+        return;
+    active_ = false;
+    if (connected_) {
+        connected_ = false;
+        context_.stats.connected.fetch_sub(1, std::memory_order_relaxed);
+    }
+    LoadStats::add(context_.stats.failures);
+    asio::error_code ec;
+    socket_.close(ec);
+    udpSocket_.close(ec);
+    timer_.expires_after(std::chrono::milliseconds(RECONNECT_DELAY_MS));
+    timer_.async_wait([this](const asio::error_code& ec) {
+        if (!ec)
+            start();
+    });
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Datagram.hpp"
+#include "FrameAssembler.hpp"
+#include "InputScript.hpp"
+#include "LoadStats.hpp"
+#include "Message.hpp"
+#include "Snapshot.hpp"
+#include "SnapshotStream.hpp"
+
+/**
+ * @struct BotContext
+ * @brief What the bots run by one thread share.
+ *
+ * A thread runs its bots one handler at a time, so they can share a single buffer to
+ * receive datagrams into, and one to build acknowledgements into, instead of holding one each.
+ */
+struct BotContext {
+    asio::io_context& io_context;                  ///< IO context of the thread running the bots.
+    LoadStats& stats;                              ///< Counters of the bots of the thread.
+    const InputScript& script;                     ///< Inputs the bots hold.
+    asio::ip::tcp::resolver::results_type server;  ///< Endpoints of the server.
+    Protocol::HelloPayload hello;                  ///< HELLO every bot opens its session with.
+    std::vector<std::uint8_t> datagramBuffer;      ///< Buffer every datagram is received into.
+    std::vector<std::uint8_t> reliableBuffer;      ///< Buffer reliable packet acknowledgements are built into.
+};
+
+/**
+ * @class BotSession
+ * @brief A headless game client driven by an input script.
+ *
+ * The session speaks the same protocol as GameClient: it connects over TCP, opens the
+ * session with HELLO, binds the UDP snapshot channel with the token it is offered,
+ * rebuilds full and delta snapshots, and acknowledges them so the server keeps
+ * delta-encoding. Instead of keyboard state, it sends
+ * the inputs of its script once per tick, and instead of rendering, it only counts what it
+ * receives. When the connection ends, after a game over or an error, it reconnects after
+ * RECONNECT_DELAY_MS, so a run keeps its load.
+ *
+ * Snapshot latency is measured from the moment an input is sent to the first snapshot
+ * acknowledging it, which covers the uplink, the wait for the next tick, the tick itself
+ * and the downlink.
+ */
+class BotSession {
+   public:
+    static constexpr unsigned RECONNECT_DELAY_MS = 1000;  ///< Wait before reconnecting after the connection ended.
+    static constexpr unsigned BIND_RETRY_MS = 200;        ///< Interval between bind datagrams until a snapshot arrives.
+    static constexpr std::size_t SENT_INPUTS = 64;        ///< Send times of the latest inputs kept to measure latency.
+
+    /**
+     * @brief Constructs an idle session.
+     *
+     * @param context What the bots of the running thread share.
+     * @param seed Seed of the session's random inputs.
+     */
+    BotSession(BotContext& context, std::uint32_t seed);
+
+    BotSession(const BotSession&) = delete;
+    BotSession& operator=(const BotSession&) = delete;
+
+    /**
+     * @brief Connects to the server; must be called from the thread running the session.
+     */
+    void start();
+
+    /**
+     * @brief Sends the input of the tick, once the session is accepted; called once per tick.
+     *
+     * @param now The time of the tick.
+     */
+    void tick(std::chrono::steady_clock::time_point now);
+
+   private:
+    /**
+     * @brief Starts an asynchronous read of server messages.
+     */
+    void startRead();
+
+    /**
+     * @brief Processes a message received over TCP, or an event received over UDP.
+     *
+     * @param message The message.
+     */
+    void handleMessage(const Message& message);
+
+    /**
+     * @brief Opens the UDP socket and starts binding it to the session.
+     *
+     * @param token The bind token received in a UDP_BIND message.
+     */
+    void bind(std::uint32_t token);
+
+    /**
+     * @brief Sends the bind datagram and schedules a retry until the first snapshot arrives.
+     */
+    void sendBind();
+
+    /**
+     * @brief Waits asynchronously for the UDP socket to become readable.
+     */
+    void startReceive();
+
+    /**
+     * @brief Reads every datagram queued on the UDP socket.
+     */
+    void drain();
+
+    /**
+     * @brief Hands a datagram to the stream and sends the acknowledgements it produces.
+     *
+     * @param datagram The received datagram.
+     */
+    void handleDatagram(std::span<const std::uint8_t> datagram);
+
+    /**
+     * @brief Counts a snapshot and measures the latency of the newest input it acknowledges.
+     *
+     * @param snapshot The snapshot.
+     */
+    void applySnapshot(const Snapshot& snapshot);
+
+    /**
+     * @brief Closes the connection and schedules a reconnection.
+     */
+    void fail();
+
+    BotContext& context_;                                                                   ///< What the bots of the thread share.
+    asio::ip::tcp::socket socket_;                                                          ///< Connection to the server.
+    asio::ip::udp::socket udpSocket_;                                                       ///< Socket receiving snapshots.
+    asio::ip::udp::endpoint serverEndpoint_;                                                ///< The server's UDP endpoint.
+    asio::steady_timer timer_;                                                              ///< Bind retries and reconnection delay.
+    FrameAssembler receiveFrames_;                                                          ///< Reassembles server messages.
+    InputScript::Cursor cursor_;                                                            ///< Position in the input script.
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::InputPayload::SIZE> input_;  ///< Input being written.
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::HelloPayload::SIZE> hello_;  ///< HELLO being written.
+    SnapshotStream::ControlDatagram<Protocol::UdpBindPayload> bindDatagram_;                ///< Datagram echoing the bind token.
+    std::array<std::chrono::steady_clock::time_point, SENT_INPUTS> sentAt_;                 ///< Send time of the latest inputs, by sequence.
+    SnapshotStream stream_;                                                                 ///< Drops, rebuilds and acknowledges snapshots and events.
+    Snapshot decoded_;                                                                      ///< Scratch snapshot a TCP state update is decoded into.
+    bool active_ = false;                                                                   ///< Whether the session is connecting or connected.
+    bool connected_ = false;                                                                ///< Whether the TCP connection is established.
+    bool welcomed_ = false;                                                                 ///< Whether the server accepted the session.
+    bool writing_ = false;                                                                  ///< Whether an input write is in progress.
+    bool assigned_ = false;                                                                 ///< Whether the server assigned a player entity.
+    bool acknowledged_ = false;                                                             ///< Whether a snapshot acknowledged an input yet.
+    std::int32_t playerId_ = 0;                                                             ///< The session's player entity.
+    std::uint32_t inputSequence_ = 0;                                                       ///< Sequence number of the next input.
+    std::uint32_t lastAcknowledged_ = 0;                                                    ///< Newest input acknowledged by a snapshot.
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Message.hpp"
+
+/**
+ * @class InputScript
+ * @brief The inputs a bot holds, tick after tick.
+ *
+ * A script is a comma-separated list of steps, each a set of held keys (U, D, L and R, or
+ * "-" for none) and the number of ticks it is held for, such as "UR:10,D:5,-:3"; the
+ * script loops. The script "random" instead holds random key combinations for random
+ * durations, drawn from each bot's own seeded generator. The script itself is shared by
+ * every bot; each bot only keeps a Cursor into it.
+ */
+class InputScript {
+   public:
+    static constexpr unsigned RANDOM_MIN_TICKS = 5;   ///< Shortest hold of a random combination.
+    static constexpr unsigned RANDOM_MAX_TICKS = 30;  ///< Longest hold of a random combination.
+
+    /**
+     * @struct Cursor
+     * @brief Position of one bot in the script.
+     */
+    struct Cursor {
+        std::mt19937 random;       ///< Generator of the random holds.
+        std::size_t step = 0;      ///< Index of the step being held.
+        unsigned ticksLeft = 0;    ///< Ticks left in the current step or random hold.
+        std::uint8_t buttons = 0;  ///< Keys held by the current random hold.
+    };
+
+    /**
+     * @brief Parses a script.
+     *
+     * @param spec "random", or steps such as "UR:10,D:5,-:3".
+     * @param out Filled with the parsed script.
+     * @return true if the script is valid, false otherwise.
+     */
+    static bool parse(const std::string& spec, InputScript& out) {
+        InputScript script;
+        if (spec == "random") {
+            out = script;
+            return true;
+        }
+        std::istringstream steps(spec);
+        std::string text;
+        while (std::getline(steps, text, ',')) {
+            std::size_t separator = text.find(':');
+            if (separator == std::string::npos || separator == 0)
+                return false;
+            Step step;
+            for (char key : text.substr(0, separator)) {
+                if (key == 'U')
+                    step.input.press(InputAction::UP);
+                else if (key == 'D')
+                    step.input.press(InputAction::DOWN);
+                else if (key == 'L')
+                    step.input.press(InputAction::LEFT);
+                else if (key == 'R')
+                    step.input.press(InputAction::RIGHT);
+                else if (key != '-')
+                    return false;
+            }
+            try {
+                int ticks = std::stoi(text.substr(separator + 1));
+                if (ticks < 1)
+                    return false;
+                step.ticks = static_cast<unsigned>(ticks);
+            } catch (const std::exception&) {
+                return false;
+            }
+            script.steps_.push_back(step);
+        }
+        if (script.steps_.empty())
+            return false;
+        out = script;
+        return true;
+    }
+
+    /**
+     * @brief Starts a bot at the beginning of the script.
+     *
+     * @param seed The seed of the bot's random holds.
+     * @return Cursor The bot's position in the script.
+     */
+    Cursor start(std::uint32_t seed) const {
+        Cursor cursor;
+        cursor.random.seed(seed);
+        if (!steps_.empty())
+            cursor.ticksLeft = steps_.front().ticks;
+        return cursor;
+    }
+
+    /**
+     * @brief Gets the keys a bot holds this tick and advances it by one tick.
+     *
+     * @param cursor The bot's position in the script.
+     * @param sequence The sequence number to stamp the input with.
+     * @return Protocol::InputPayload The held keys.
+     */
+    Protocol::InputPayload next(Cursor& cursor, std::uint32_t sequence) const {
+        Protocol::InputPayload input;
+        if (steps_.empty()) {
+            if (cursor.ticksLeft == 0) {
+                cursor.buttons = static_cast<std::uint8_t>(std::uniform_int_distribution<unsigned>(0, 15)(cursor.random));
+                cursor.ticksLeft = std::uniform_int_distribution<unsigned>(RANDOM_MIN_TICKS, RANDOM_MAX_TICKS)(cursor.random);
+            }
+            input.buttons = cursor.buttons;
+        } else {
+            if (cursor.ticksLeft == 0) {
+                cursor.step = (cursor.step + 1) % steps_.size();
+                cursor.ticksLeft = steps_[cursor.step].ticks;
+            }
+            input = steps_[cursor.step].input;
+        }
+        --cursor.ticksLeft;
+        input.sequence = sequence;
+        return input;
+    }
+
+   private:
+    /**
+     * @struct Step
+     * @brief Keys held for a number of ticks.
+     */
+    struct Step {
+        Protocol::InputPayload input;  ///< The held keys.
+        unsigned ticks = 1;            ///< Number of ticks they are held for.
+    };
+
+    std::vector<Step> steps_;  ///< Steps of the script; empty for random holds.
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @struct LoadSample
+ * @brief Counters of a group of bots, read at one instant.
+ *
+ * Every counter is cumulative, so the activity over an interval is the difference of two
+ * samples, and the samples of several groups add up.
+ */
+struct LoadSample {
+    static constexpr std::size_t LATENCY_BUCKETS = 1000;  ///< One bucket per millisecond; the last one holds every longer latency.
+
+    std::uint64_t connected = 0;                             ///< Sessions currently connected.
+    std::uint64_t connects = 0;                              ///< Connections established.
+    std::uint64_t failures = 0;                              ///< Connections refused, lost or ended by the server.
+    std::uint64_t gamesOver = 0;                             ///< GAME_OVER messages received.
+    std::uint64_t snapshots = 0;                             ///< Snapshots applied.
+    std::uint64_t staleSnapshots = 0;                        ///< Snapshots dropped as late, malformed or missing their baseline.
+    std::uint64_t inputsSent = 0;                            ///< Inputs written to the server.
+    std::uint64_t inputsSkipped = 0;                         ///< Inputs not sent because the previous write was still in progress.
+    std::uint64_t tcpBytesReceived = 0;                      ///< Bytes read from the TCP connections.
+    std::uint64_t udpBytesReceived = 0;                      ///< Bytes of the datagrams received.
+    std::uint64_t bytesSent = 0;                             ///< Bytes written over TCP and UDP.
+    std::array<std::uint64_t, LATENCY_BUCKETS> latencies{};  ///< Input-to-snapshot latencies, by millisecond.
+
+    /**
+     * @brief Adds the counters of another sample.
+     *
+     * @param other The sample to add.
+     * @return LoadSample& This sample.
+     */
+    LoadSample& operator+=(const LoadSample& other) {
+        connected += other.connected;
+        connects += other.connects;
+        failures += other.failures;
+        gamesOver += other.gamesOver;
+        snapshots += other.snapshots;
+        staleSnapshots += other.staleSnapshots;
+        inputsSent += other.inputsSent;
+        inputsSkipped += other.inputsSkipped;
+        tcpBytesReceived += other.tcpBytesReceived;
+        udpBytesReceived += other.udpBytesReceived;
+        bytesSent += other.bytesSent;
+        for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i)
+            latencies[i] += other.latencies[i];
+        return *this;
+    }
+
+    /**
+     * @brief Gets the activity between an earlier sample and this one.
+     *
+     * The connected count is a level, not a total, so it is kept as is.
+     *
+     * @param earlier The earlier sample.
+     * @return LoadSample The difference of every cumulative counter.
+     */
+    LoadSample since(const LoadSample& earlier) const {
+        LoadSample delta = *this;
+        delta.connects -= earlier.connects;
+        delta.failures -= earlier.failures;
+        delta.gamesOver -= earlier.gamesOver;
+        delta.snapshots -= earlier.snapshots;
+        delta.staleSnapshots -= earlier.staleSnapshots;
+        delta.inputsSent -= earlier.inputsSent;
+        delta.inputsSkipped -= earlier.inputsSkipped;
+        delta.tcpBytesReceived -= earlier.tcpBytesReceived;
+        delta.udpBytesReceived -= earlier.udpBytesReceived;
+        delta.bytesSent -= earlier.bytesSent;
+        for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i)
+            delta.latencies[i] -= earlier.latencies[i];
+        return delta;
+    }
+
+    /**
+     * @brief Gets a percentile of the recorded latencies.
+     *
+     * @param percent The percentile, between 0 and 100.
+     * @return std::size_t The latency in milliseconds, or 0 if none was recorded.
+     */
+    std::size_t latencyPercentile(double percent) const {
+        std::uint64_t total = 0;
+        for (std::uint64_t count : latencies)
+            total += count;
+        if (total == 0)
+            return 0;
+        std::uint64_t rank = static_cast<std::uint64_t>(static_cast<double>(total - 1) * percent / 100.0);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += latencies[i];
+            if (seen > rank)
+                return i;
+        }
+        return LATENCY_BUCKETS - 1;
+    }
+};
+
+/**
+ * @class LoadStats
+ * @brief Live counters of a group of bots, updated by the thread running them.
+ *
+ * Only the thread running the group writes the counters, so relaxed atomics are enough:
+ * the reporting thread may see one counter a few events ahead of another, which does not
+ * matter once averaged over a reporting interval.
+ */
+class LoadStats {
+   public:
+    /**
+     * @brief Adds to a counter.
+     *
+     * @param counter The counter.
+     * @param amount The amount to add.
+     */
+    static void add(std::atomic<std::uint64_t>& counter, std::uint64_t amount = 1) { counter.fetch_add(amount, std::memory_order_relaxed); }
+
+    /**
+     * @brief Records the latency between sending an input and receiving the first snapshot applying it.
+     *
+     * @param latency The latency.
+     */
+    void recordLatency(std::chrono::steady_clock::duration latency) {
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(latency).count();
+        std::size_t bucket = milliseconds < 0 ? 0 : static_cast<std::size_t>(milliseconds);
+        add(latencies[std::min(bucket, LoadSample::LATENCY_BUCKETS - 1)]);
+    }
+
+    /**
+     * @brief Reads every counter.
+     *
+     * @return LoadSample The counters.
+     */
+    LoadSample sample() const {
+        LoadSample sample;
+        sample.connected = connected.load(std::memory_order_relaxed);
+        sample.connects = connects.load(std::memory_order_relaxed);
+        sample.failures = failures.load(std::memory_order_relaxed);
+        sample.gamesOver = gamesOver.load(std::memory_order_relaxed);
+        sample.snapshots = snapshots.load(std::memory_order_relaxed);
+        sample.staleSnapshots = staleSnapshots.load(std::memory_order_relaxed);
+        sample.inputsSent = inputsSent.load(std::memory_order_relaxed);
+        sample.inputsSkipped = inputsSkipped.load(std::memory_order_relaxed);
+        sample.tcpBytesReceived = tcpBytesReceived.load(std::memory_order_relaxed);
+        sample.udpBytesReceived = udpBytesReceived.load(std::memory_order_relaxed);
+        sample.bytesSent = bytesSent.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < LoadSample::LATENCY_BUCKETS; ++i)
+            sample.latencies[i] = latencies[i].load(std::memory_order_relaxed);
+        return sample;
+    }
+
+    std::atomic<std::uint64_t> connected{0};                                          ///< Sessions currently connected.
+    std::atomic<std::uint64_t> connects{0};                                           ///< Connections established.
+    std::atomic<std::uint64_t> failures{0};                                           ///< Connections refused, lost or ended.
+    std::atomic<std::uint64_t> gamesOver{0};                                          ///< GAME_OVER messages received.
+    std::atomic<std::uint64_t> snapshots{0};                                          ///< Snapshots applied.
+    std::atomic<std::uint64_t> staleSnapshots{0};                                     ///< Snapshots dropped.
+    std::atomic<std::uint64_t> inputsSent{0};                                         ///< Inputs written to the server.
+    std::atomic<std::uint64_t> inputsSkipped{0};                                      ///< Inputs not sent behind a pending write.
+    std::atomic<std::uint64_t> tcpBytesReceived{0};                                   ///< Bytes read over TCP.
+    std::atomic<std::uint64_t> udpBytesReceived{0};                                   ///< Bytes received over UDP.
+    std::atomic<std::uint64_t> bytesSent{0};                                          ///< Bytes written over TCP and UDP.
+    std::array<std::atomic<std::uint64_t>, LoadSample::LATENCY_BUCKETS> latencies{};  ///< Input-to-snapshot latencies, by millisecond.
+};
@@ -0,0 +1,148 @@
+/**
+ * @file main.cpp
+ * @brief Entry point for the load-testing bot application.
+ *
+ * Parses the command line, then runs a fleet of headless bots against a server and
+ * reports the load they see every second.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "BotFleet.hpp"
+#include "CommonDefs.hpp"
+#include "InputScript.hpp"
+
+const int SERVER_PORT = 4242;
+
+/**
+ * @brief Displays the usage information for the bot application.
+ *
+ * @param returnValue The return value to be propagated back through the function call.
+ * @return int The return value provided as an argument.
+ */
+static int help(const int returnValue) {
+    std::cout << "USAGE:\n\t./r-type_bot <server_ip> <sessions> [options]\n"
+              << "sessions: Number of bots to connect.\n"
+              << "--port <port>: Server port, " << SERVER_PORT << " by default.\n"
+              << "--threads <count>: Threads running the bots, 0 (default) for one per hardware thread.\n"
+              << "--ramp <count>: Bots connected per second at startup, 200 by default.\n"
+              << "--duration <seconds>: Length of the run, 0 (default) to run until killed.\n"
+              << "--inputs <script>: \"random\" (default), or steps of held keys and ticks such as UR:10,D:5,-:3.\n"
+              << "--seed <seed>: Seed of the random inputs, 1 by default.\n"
+              << "--capabilities <list>: Capabilities offered in HELLO, comma-separated among udp,delta,reliable,spectator;\n"
+              << "\tall but spectator by default, \"none\" for TCP only. Mixes old and new clients when testing a rollout;\n"
+              << "\twith spectator, the bots watch matches, e.g. to load a match with hundreds of viewers." << std::endl;
+    return returnValue;
+}
+
+/**
+ * @brief Parses a non-negative integer option.
+ *
+ * @param arg The argument.
+ * @param value Filled with the parsed value.
+ * @return true if the argument is a non-negative integer, false otherwise.
+ */
+static bool parseCount(const std::string& arg, unsigned long& value) {
+    try {
+        std::size_t end = 0;
+        long long parsed = std::stoll(arg, &end);
+        if (end != arg.size() || parsed < 0)
+            return false;
+        value = static_cast<unsigned long>(parsed);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Parses a comma-separated list of capability names.
+ *
+ * @param arg The argument, such as "udp,delta", or "none" for an empty list.
+ * @param capabilities Filled with the capability mask.
+ * @return true if every name is a known capability, false otherwise.
+ */
+static bool parseCapabilities(const std::string& arg, std::uint32_t& capabilities) {
+    capabilities = 0;
+    if (arg == "none")
+        return true;
+    std::size_t begin = 0;
+    while (begin <= arg.size()) {
+        std::size_t end = std::min(arg.find(',', begin), arg.size());
+        std::string name = arg.substr(begin, end - begin);
+        bool known = false;
+        for (Capability capability : {Capability::UDP_SNAPSHOTS, Capability::DELTA_SNAPSHOTS, Capability::RELIABLE_EVENTS, Capability::SPECTATOR}) {
+            if (name == Protocol::capabilityName(capability)) {
+                capabilities |= Protocol::capabilityBit(capability);
+                known = true;
+            }
+        }
+        if (!known)
+            return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+/**
+ * @brief The main function, entry point for the bot application.
+ *
+ * @param ac Argument count.
+ * @param av Argument vector.
+ * @return int The exit status of the application.
+ */
+int main(int ac, char** av) {
+    if (ac < 3 || ac % 2 == 0)
+        return help(84);
+
+    FleetOptions options;
+    std::string port = std::to_string(SERVER_PORT);
+    std::string inputs = "random";
+    unsigned long value = 0;
+    if (!parseCount(av[2], value) || value == 0)
+        return help(84);
+    options.sessions = value;
+    for (int i = 3; i + 1 < ac; i += 2) {
+        std::string option = av[i];
+        std::string arg = av[i + 1];
+        if (option == "--inputs") {
+            inputs = arg;
+            continue;
+        }
+        if (option == "--capabilities") {
+            if (!parseCapabilities(arg, options.capabilities))
+                return help(84);
+            continue;
+        }
+        if (!parseCount(arg, value))
+            return help(84);
+        if (option == "--port")
+            port = arg;
+        else if (option == "--threads")
+            options.threads = static_cast<unsigned>(value);
+        else if (option == "--ramp" && value > 0)
+            options.rampPerSecond = static_cast<unsigned>(value);
+        else if (option == "--duration")
+            options.durationSeconds = static_cast<unsigned>(value);
+        else if (option == "--seed")
+            options.seed = static_cast<std::uint32_t>(value);
+        else
+            return help(84);
+    }
+    InputScript script;
+    if (!InputScript::parse(inputs, script)) {
+        std::cerr << "Error: invalid input script \"" << inputs << "\"." << std::endl;
+        return help(84);
+    }
+
+    try {
+        BotFleet fleet(av[1], port, script, options);
+        fleet.run();
+    } catch (std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 84;
+    }
+    return SUCCESS;
+}
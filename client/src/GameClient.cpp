@@ -1,4 +1,5 @@
 #include "GameClient.hpp"
+#include <algorithm>
 
 /**
  * @brief Construct a new Game Client object.
@@ -6,9 +7,20 @@
  * @param io_context ASIO IO context for asynchronous operations.
  * @param server The server's IP address or hostname.
  * @param port The server's port number as a string.
+ * @param interpolationDelay How far behind the newest snapshot remote entities are rendered.
+ * @param spectate Whether to watch a match instead of playing.
  */
-GameClient::GameClient(asio::io_context& io_context, const std::string& server, const std::string& port)
-    : io_context_(io_context), socket_(io_context), gs(int(1920), int(1080)) {
+GameClient::GameClient(asio::io_context& io_context, const std::string& server, const std::string& port,
+                       std::chrono::milliseconds interpolationDelay, bool spectate)
+    : io_context_(io_context),
+      socket_(io_context),
+      reconnectTimer_(io_context),
+      snapshots_(
+          io_context, [this](const Snapshot& snapshot) { updateGameState(snapshot); }, [this](const Message& event) { receiveUpdates(event); }),
+      gs(int(1920), int(1080)),
+      interpolator_(interpolationDelay),
+      spectate_(spectate),
+      tickIntervalMs_(Protocol::TICK_INTERVAL_MS) {
     loadTextures();
     connectToServer(server, port);
 }
@@ -33,14 +45,20 @@ void GameClient::loadTextures() {
  */
 void GameClient::run() {
     gs.factory(0, "Background");
+    nextInputSample_ = std::chrono::steady_clock::now();
     while (gs.window->isOpen()) {
         handleInput();
+        renderRemoteEntities();
         gs.displayAll();
     }
 }
 
 /**
- * @brief Handles user input, translates it into game actions, and sends it to the server.
+ * @brief Handles window events and sends the held movement keys to the server.
+ *
+ * The keys are sampled every server tick, as announced in WELCOME, regardless of the
+ * frame rate and of key repeat, and every sample is sent, so the server receives one
+ * input per tick. Nothing is sent before the handshake completes, nor by a spectator.
  */
 void GameClient::handleInput() {
     std::vector<std::string> events = gs.eventSystem.getEvents(*gs.window);
@@ -48,71 +66,217 @@ void GameClient::handleInput() {
         if (events[i] == "EXIT") {
             std::exit(0);
         }
-        sendInput(events[i]);
     }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < nextInputSample_)
+        return;
+    nextInputSample_ += std::chrono::milliseconds(tickIntervalMs_.load());
+    if (nextInputSample_ < now)
+        nextInputSample_ = now;  // A slow frame must not cause a burst of samples
+    if (!connected_ || spectate_)
+        return;
+    Protocol::InputPayload input = sampleInput();
+    sendInput(input);
+    Protocol::EntityState predicted;
+    if (prediction_.predict(input, predicted))
+        gs.setNewPos(predicted.x, predicted.y, predicted.entityId);
 }
 
 /**
- * @brief Updates the game state based on the state data received from the server.
+ * @brief Samples the movement keys currently held.
+ *
+ * Keys are ignored while the window does not have the focus.
  *
- * @param stateData Serialized state data received from the server.
+ * @return Protocol::InputPayload The held keys, stamped with the next input sequence number.
  */
-void GameClient::updateGameState(const std::string& stateData) {
-    std::set<int> activePlayerIds;
-    std::set<int> activeEnemyIds;
-    std::istringstream iss(stateData);
-    std::string token;
+Protocol::InputPayload GameClient::sampleInput() {
+    Protocol::InputPayload input;
+    input.sequence = inputSequence_++;
+    if (!gs.window->hasFocus())
+        return input;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
+        input.press(InputAction::UP);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
+        input.press(InputAction::DOWN);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left))
+        input.press(InputAction::LEFT);
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right))
+        input.press(InputAction::RIGHT);
+    return input;
+}
 
-    while (std::getline(iss, token, ',')) {
-        std::istringstream tokenStream(token);
-        float x, y;
-        int entityId;
+/**
+ * @brief Updates the game state based on the latest snapshot received from the server.
+ *
+ * Remote entities are buffered and rendered later by renderRemoteEntities(). The local
+ * player is reconciled right away instead: its inputs the server has not applied yet are
+ * replayed on top of the authoritative position.
+ *
+ * @param snapshot The full snapshot received from the server.
+ */
+void GameClient::updateGameState(const Snapshot& snapshot) {
+    interpolator_.push(snapshot);
 
-        tokenStream >> entityId >> x >> y;
-        gs.setNewPos(x, y, entityId);
-    }
+    Protocol::EntityState predicted;
+    if (prediction_.reconcile(snapshot, predicted))
+        gs.setNewPos(predicted.x, predicted.y, predicted.entityId);
+}
+
+/**
+ * @brief Moves the remote entities to their interpolated positions for the current frame.
+ *
+ * The local player is skipped, since its position comes from the prediction.
+ */
+void GameClient::renderRemoteEntities() {
+    std::int32_t playerId = 0;
+    bool predicting = prediction_.getPlayer(playerId);
+    interpolator_.sample(SnapshotInterpolator::Clock::now(), [&](const Protocol::EntityState& state) {
+        if (!predicting || state.entityId != playerId)
+            gs.setNewPos(state.x, state.y, state.entityId);
+    });
+}
+
+/**
+ * @brief Gets the statistics of the snapshot interpolation buffer.
+ *
+ * @return SnapshotInterpolator::Stats A copy of the counters.
+ */
+SnapshotInterpolator::Stats GameClient::getInterpolationStats() {
+    return interpolator_.getStats();
 }
 
 /**
  * @brief Initiates the connection to the game server.
  *
+ * The endpoints are resolved once and kept, so that a lost connection can be reopened.
+ *
  * @param server The server's IP address or hostname.
  * @param port The server's port number as a string.
  */
 void GameClient::connectToServer(const std::string& server, const std::string& port) {
     try {
         asio::ip::tcp::resolver resolver(io_context_);
-        asio::ip::tcp::resolver::results_type endpoints = resolver.resolve(server, port);
-        asio::async_connect(socket_, endpoints, [this](std::error_code ec, asio::ip::tcp::endpoint) {
-            if (!ec) {
-                std::cout << "Connected to the server!" << std::endl;
-                startRead();
-            } else {
-                std::cerr << "Failed to connect: " << ec.message() << std::endl;
-            }
-        });
+        endpoints_ = resolver.resolve(server, port);
+        connect();
     } catch (std::exception& e) {
         std::cerr << "Exception in connectToServer: " << e.what() << std::endl;
     }
 }
 
 /**
- * @brief Sends a player's input to the server.
+ * @brief Connects to the resolved server endpoints.
  *
- * @param input The player's input as a string.
+ * Once connected, a new client opens the session with HELLO, offering every capability it
+ * supports; the session starts when the server answers with WELCOME. A client that holds a
+ * session token sends RESUME instead, and gets its player back.
  */
-void GameClient::sendInput(const std::string& input) {
-    Message message;
-    message.type = RFC::INPUT;
-    message.content = input;
-
-    std::string serializedMessage = message.serialize();
-
-    asio::async_write(socket_, asio::buffer(serializedMessage), [this](std::error_code ec, std::size_t /*length*/) {
-        if (!ec) {
+void GameClient::connect() {
+    asio::async_connect(socket_, endpoints_, [this](std::error_code ec, asio::ip::tcp::endpoint) {
+        if (ec) {
+            std::cerr << "Failed to connect: " << ec.message() << std::endl;
+            if (sessionToken_ != 0)
+                scheduleReconnect();
+            return;
+        }
+        receiveFrames.reset();
+        if (sessionToken_ != 0) {
+            std::cout << "Reconnected to the server, resuming the session." << std::endl;
+            sendResume();
         } else {
-            std::cerr << "Failed to send input: " << ec.message() << std::endl;
+            std::cout << "Connected to the server!" << std::endl;
+            sendHello();
         }
+        startRead();
+    });
+}
+
+/**
+ * @brief Sends HELLO, opening the session.
+ *
+ * A spectating client asks for SPECTATOR on top of the capabilities it supports.
+ * Runs on the IO thread, which owns the socket.
+ */
+void GameClient::sendHello() {
+    Protocol::HelloPayload hello;
+    if (spectate_)
+        hello.capabilities |= Protocol::capabilityBit(Capability::SPECTATOR);
+    auto serializedMessage = std::make_shared<std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::HelloPayload::SIZE>>();
+    Message::serialize(hello, *serializedMessage);
+    asio::async_write(socket_, asio::buffer(*serializedMessage), [serializedMessage](std::error_code ec, std::size_t /*length*/) {
+        if (ec)
+            std::cerr << "Failed to send HELLO: " << ec.message() << std::endl;
+    });
+}
+
+/**
+ * @brief Sends RESUME with the session token, reopening the session.
+ *
+ * Runs on the IO thread, which owns the socket.
+ */
+void GameClient::sendResume() {
+    Protocol::ResumePayload resume;
+    resume.token = sessionToken_;
+    auto serializedMessage = std::make_shared<std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::ResumePayload::SIZE>>();
+    Message::serialize(resume, *serializedMessage);
+    asio::async_write(socket_, asio::buffer(*serializedMessage), [serializedMessage](std::error_code ec, std::size_t /*length*/) {
+        if (ec)
+            std::cerr << "Failed to send RESUME: " << ec.message() << std::endl;
+    });
+}
+
+/**
+ * @brief Handles a connection dropped by the network or the server.
+ *
+ * If the server gave the client a session token and the game is not over, the client
+ * reconnects every RECONNECT_INTERVAL until the resume window elapses; meanwhile no input
+ * is sent and the entities stand still.
+ */
+void GameClient::connectionLost() {
+    disconnect();
+    if (sessionToken_ == 0 || gs.isGameOver)
+        return;
+    std::cout << "Lost the connection to the server, trying to resume the session." << std::endl;
+    resumeDeadline_ = std::chrono::steady_clock::now() + resumeWindow_;
+    scheduleReconnect();
+}
+
+/**
+ * @brief Schedules the next attempt to resume the session.
+ *
+ * Gives up once the next attempt would come after the server forgot the session.
+ */
+void GameClient::scheduleReconnect() {
+    if (std::chrono::steady_clock::now() + RECONNECT_INTERVAL > resumeDeadline_) {
+        std::cerr << "Could not resume the session before it expired." << std::endl;
+        sessionToken_ = 0;
+        return;
+    }
+    reconnectTimer_.expires_after(RECONNECT_INTERVAL);
+    reconnectTimer_.async_wait([this](std::error_code ec) {
+        if (!ec)
+            connect();
+    });
+}
+
+/**
+ * @brief Sends a player's input to the server.
+ *
+ * The write is started from the IO thread, which owns the socket.
+ *
+ * @param input The sampled input.
+ */
+void GameClient::sendInput(const Protocol::InputPayload& input) {
+    auto serializedMessage = std::make_shared<std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::InputPayload::SIZE>>();
+    Message::serialize(input, *serializedMessage);
+
+    asio::post(io_context_, [this, serializedMessage]() {
+        asio::async_write(socket_, asio::buffer(*serializedMessage), [serializedMessage](std::error_code ec, std::size_t /*length*/) {
+            if (!ec) {
+            } else {
+                std::cerr << "Failed to send input: " << ec.message() << std::endl;
+            }
+        });
     });
 }
 
@@ -120,24 +284,20 @@ void GameClient::sendInput(const std::string& input) {
  * @brief Starts the asynchronous read operation to receive data from the server.
  */
 void GameClient::startRead() {
-    receiveBuffer.resize(1024);
+    std::span<std::uint8_t> space = receiveFrames.prepare();
 
-    socket_.async_read_some(asio::buffer(receiveBuffer), [this](std::error_code ec, std::size_t length) {
+    socket_.async_read_some(asio::buffer(space.data(), space.size()), [this](std::error_code ec, std::size_t length) {
         if (!ec) {
-            std::string receivedData(receiveBuffer.begin(), receiveBuffer.begin() + length);
-            std::stringstream ss(receivedData);
-            std::string token;
-
-            while (std::getline(ss, token, ';')) {
-                if (!token.empty()) {
-                    Message receivedMessage = Message::deserialize(token);
-                    receiveUpdates(receivedMessage);
-                }
+            receiveFrames.commit(length);
+            if (!receiveFrames.consume([this](const Message& receivedMessage) { receiveUpdates(receivedMessage); })) {
+                std::cerr << "Received a malformed frame from the server." << std::endl;
+                disconnect();
+                return;
             }
-            Message receivedMessage = Message::deserialize(receivedData);
             startRead();
-        } else {
+        } else if (ec != asio::error::operation_aborted) {
             std::cerr << "Failed to read: " << ec.message() << std::endl;
+            connectionLost();
         }
     });
 }
@@ -148,24 +308,104 @@ void GameClient::startRead() {
  * @param message The message received from the server.
  */
 void GameClient::receiveUpdates(const Message& message) {
-    if (message.type == RFC::STATE_UPDATE) {
-        updateGameState(message.content);
+    if (message.type() == RFC::WELCOME) {
+        Protocol::WelcomePayload welcome;
+        if (!message.decode(welcome) || welcome.version == 0) {
+            std::cerr << "The server speaks none of protocol versions " << int(Protocol::MIN_VERSION) << " to " << int(Protocol::VERSION) << "."
+                      << std::endl;
+            disconnect();
+            return;
+        }
+        if (spectate_ && !welcome.has(Capability::SPECTATOR)) {
+            std::cerr << "The server does not accept spectators." << std::endl;
+            disconnect();
+            return;
+        }
+        if (welcome.tickIntervalMs > 0)
+            tickIntervalMs_ = welcome.tickIntervalMs;
+        connected_ = true;
+        return;
+    }
+    if (message.type() == RFC::SESSION) {
+        Protocol::SessionPayload session;
+        if (!message.decode(session))
+            return;
+        if (session.token == 0) {
+            std::cerr << "The session expired; restart the client to join a new match." << std::endl;
+            sessionToken_ = 0;
+            disconnect();
+            return;
+        }
+        sessionToken_ = session.token;
+        resumeWindow_ = std::chrono::milliseconds(session.resumeWindowMs);
+    }
+    if (message.type() == RFC::WORLD_STATE)
+        applyWorldState(message);
+    if (message.type() == RFC::STATE_UPDATE) {
+        if (Protocol::decodeStateUpdate(message, tcpSnapshot_)) {
+            // STATE_UPDATE carries no sequence over TCP; the server sends one per tick
+            tcpSnapshot_.sequence = ++tcpSequence_;
+            updateGameState(tcpSnapshot_);
+        }
     }
-    if (message.type == RFC::GAME_OVER) {
+    if (message.type() == RFC::PLAYER_ASSIGNED) {
+        Protocol::PlayerAssignedPayload assigned;
+        if (message.decode(assigned))
+            prediction_.setPlayer(assigned.entityId);
+    }
+    if (message.type() == RFC::GAME_OVER) {
         gs.isGameOver = true;
     }
-    if (message.type == RFC::NEW_ENTITY) {
-        std::istringstream iss(message.content);
-        std::string entityType;
-        int entityId;
+    if (message.type() == RFC::NEW_ENTITY) {
+        Protocol::NewEntityPayload newEntity;
+        if (!message.decode(newEntity) || gs.em.getIndex(newEntity.entityId) != -1)
+            return;  // An entity coming back into view is still known, only hidden
+        std::cout << "creating instruction: " << Protocol::entityTypeName(newEntity.entityType) << " " << newEntity.entityId << std::endl;
+        gs.factory(newEntity.entityId, Protocol::entityTypeName(newEntity.entityType));
+    }
+    if (message.type() == RFC::ENTITY_DEAD) {
+        Protocol::EntityDeadPayload death;
+        if (!message.decode(death))
+            return;
+        gs.factory(-1, "Explosion", death.entityId);
+        gs.removeEntity(death.entityId);
+    }
+    if (message.type() == RFC::ENTITY_DESPAWN) {
+        Protocol::EntityDespawnPayload despawn;
+        if (message.decode(despawn))
+            gs.hideEntity(despawn.entityId);
+    }
+    if (message.type() == RFC::UDP_BIND) {
+        Protocol::UdpBindPayload bind;
+        asio::error_code ec;
+        auto serverEndpoint = socket_.remote_endpoint(ec);
+        if (!message.decode(bind) || ec)
+            return;
+        snapshots_.bind(bind.token, asio::ip::udp::endpoint(serverEndpoint.address(), serverEndpoint.port()));
+    }
+}
 
-        std::cout << "creating instruction: " << message.content << std::endl;
-        iss >> entityType >> entityId;
-        gs.factory(entityId, entityType);
+/**
+ * @brief Replaces the entities known to the client with those of a WORLD_STATE.
+ *
+ * After a resume, the server describes every entity the client sees at once rather than
+ * replaying the events missed while disconnected: unknown entities are created, every
+ * entity is moved to its current position, and known entities the server no longer
+ * reports are hidden.
+ *
+ * @param message The WORLD_STATE message.
+ */
+void GameClient::applyWorldState(const Message& message) {
+    if (!Protocol::WorldState::decode(message, worldEntities_))
+        return;
+    for (const Protocol::WorldEntity& entity : worldEntities_) {
+        if (gs.em.getIndex(entity.entityId) == -1)
+            gs.factory(entity.entityId, Protocol::entityTypeName(entity.entityType));
+        gs.setNewPos(entity.x, entity.y, entity.entityId);
     }
-    if (message.type == RFC::ENTITY_DEAD) {
-        gs.factory(-1, "Explosion", std::stoi(message.content));
-        gs.removeEntity(std::stoi(message.content));
+    for (const auto& [entityId, type] : gs.em.serverEntitiesId) {
+        if (entityId > 0 && !std::ranges::binary_search(worldEntities_, entityId, {}, &Protocol::WorldEntity::entityId))
+            gs.hideEntity(entityId);
     }
 }
 
@@ -173,6 +413,8 @@ void GameClient::receiveUpdates(const Message& message) {
  * @brief Disconnects the client from the server, closing the socket.
  */
 void GameClient::disconnect() {
+    connected_ = false;
+    snapshots_.close();
     if (socket_.is_open()) {
         std::error_code ec;
         socket_.close(ec);
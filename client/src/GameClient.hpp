@@ -1,26 +1,44 @@
 #pragma once
 
+#include <array>
 #include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../../libs/ecs/FrameAssembler.hpp"
 #include "../../libs/ecs/Message.hpp"
+#include "../../libs/ecs/Snapshot.hpp"
 #include "../../libs/ecs/systems/GraphicSystem/GraphicSystem.hpp"
+#include "PlayerPrediction.hpp"
+#include "SnapshotInterpolator.hpp"
+#include "SnapshotReceiver.hpp"
 
 /**
  * @class GameClient
  * @brief Handles the client-side game logic and network communication.
  *
  * This class manages the connection to the server, processes incoming and outgoing messages,
- * and integrates the graphics system for rendering the game state.
+ * and integrates the graphics system for rendering the game state. When the connection
+ * drops during a game, the client reconnects and resumes its session with the token the
+ * server sent in SESSION, until the server's resume window elapses.
  */
 class GameClient {
    public:
+    static constexpr std::chrono::milliseconds RECONNECT_INTERVAL{500};  ///< Delay between two attempts to resume the session.
+
     /**
      * @brief Constructs a new Game Client object and initiates a connection to the server.
      *
      * @param io_context ASIO IO context for asynchronous operations.
      * @param server The server's IP address or hostname.
      * @param port The server's port as a string.
+     * @param interpolationDelay How far behind the newest snapshot remote entities are rendered.
+     * @param spectate Whether to watch a match instead of playing.
      */
-    GameClient(asio::io_context& io_context, const std::string& server, const std::string& port);
+    GameClient(asio::io_context& io_context, const std::string& server, const std::string& port,
+               std::chrono::milliseconds interpolationDelay = SnapshotInterpolator::DEFAULT_DELAY, bool spectate = false);
 
     /**
      * @brief Loads the texture assets required for the game.
@@ -38,26 +56,77 @@ class GameClient {
     void handleInput();
 
     /**
-     * @brief Updates the game state based on the latest data received from the server.
+     * @brief Moves the remote entities to their interpolated positions for the current frame.
+     */
+    void renderRemoteEntities();
+
+    /**
+     * @brief Gets the statistics of the snapshot interpolation buffer.
+     *
+     * @return SnapshotInterpolator::Stats A copy of the counters.
+     */
+    SnapshotInterpolator::Stats getInterpolationStats();
+
+    /**
+     * @brief Updates the game state based on the latest snapshot received from the server.
      *
-     * @param stateData The serialized state data as a string.
+     * @param snapshot The full snapshot, received over TCP or rebuilt by the snapshot receiver.
      */
-    void updateGameState(const std::string& stateData);
+    void updateGameState(const Snapshot& snapshot);
 
     /**
-     * @brief Establishes a connection to the server.
+     * @brief Resolves the server's address and establishes a connection to it.
      *
      * @param server The server's IP address or hostname.
      * @param port The server's port as a string.
      */
     void connectToServer(const std::string& server, const std::string& port);
 
+    /**
+     * @brief Connects to the resolved server, then opens the session or resumes it.
+     */
+    void connect();
+
+    /**
+     * @brief Sends HELLO, opening the session.
+     */
+    void sendHello();
+
+    /**
+     * @brief Sends RESUME, reopening the session after a lost connection.
+     */
+    void sendResume();
+
+    /**
+     * @brief Handles a connection dropped by the network or the server, trying to resume the session.
+     */
+    void connectionLost();
+
+    /**
+     * @brief Schedules the next attempt to resume the session, unless it expired by then.
+     */
+    void scheduleReconnect();
+
+    /**
+     * @brief Replaces the entities known to the client with those of a WORLD_STATE.
+     *
+     * @param message The WORLD_STATE message received after resuming the session.
+     */
+    void applyWorldState(const Message& message);
+
+    /**
+     * @brief Samples the movement keys currently held.
+     *
+     * @return Protocol::InputPayload The held keys, stamped with the next input sequence number.
+     */
+    Protocol::InputPayload sampleInput();
+
     /**
      * @brief Sends the player's input to the server for processing.
      *
-     * @param input The player's input as a string.
+     * @param input The sampled input.
      */
-    void sendInput(const std::string& input);
+    void sendInput(const Protocol::InputPayload& input);
 
     /**
      * @brief Starts an asynchronous read operation to receive updates from the server.
@@ -77,8 +146,24 @@ class GameClient {
     void disconnect();
 
    private:
-    asio::io_context& io_context_;    ///< The ASIO IO context for handling asynchronous operations.
-    asio::ip::tcp::socket socket_;    ///< The socket used for network communication with the server.
-    std::vector<char> receiveBuffer;  ///< Buffer used for receiving data from the server.
-    GraphicSystem gs;                 ///< The graphics system for rendering the game state.
+    asio::io_context& io_context_;                           ///< The ASIO IO context for handling asynchronous operations.
+    asio::ip::tcp::socket socket_;                           ///< The socket used for network communication with the server.
+    asio::ip::tcp::resolver::results_type endpoints_;        ///< The server's resolved endpoints, reused to reconnect.
+    asio::steady_timer reconnectTimer_;                      ///< Paces the attempts to resume the session.
+    SnapshotReceiver snapshots_;                             ///< Receives state snapshots over UDP.
+    FrameAssembler receiveFrames;                            ///< Reassembles server messages split or coalesced by TCP.
+    GraphicSystem gs;                                        ///< The graphics system for rendering the game state.
+    PlayerPrediction prediction_;                            ///< Predicts the local player's movement ahead of the server.
+    SnapshotInterpolator interpolator_;                      ///< Buffers snapshots to render remote entities smoothly.
+    Snapshot tcpSnapshot_;                                   ///< Snapshot decoded from the last STATE_UPDATE received over TCP.
+    std::uint32_t tcpSequence_ = 0;                          ///< Sequence assigned to snapshots received over TCP.
+    std::atomic<bool> connected_{false};                     ///< Whether the server accepted the session with WELCOME.
+    bool spectate_;                                          ///< Whether the client asks to watch a match instead of playing.
+    std::atomic<unsigned> tickIntervalMs_;                   ///< Server tick announced in WELCOME; the input sampling interval.
+    std::uint32_t inputSequence_ = 0;                        ///< Sequence number of the next input sample.
+    std::chrono::steady_clock::time_point nextInputSample_;  ///< When the next input sample is due.
+    std::uint64_t sessionToken_ = 0;                         ///< Token to resume the session with, 0 until SESSION is received.
+    std::chrono::milliseconds resumeWindow_{0};              ///< How long the server keeps the player after the connection drops.
+    std::chrono::steady_clock::time_point resumeDeadline_;   ///< When the session being resumed expires.
+    std::vector<Protocol::WorldEntity> worldEntities_;       ///< Entities decoded from the last WORLD_STATE.
 };
@@ -0,0 +1,87 @@
+#include "PlayerPrediction.hpp"
+#include "../../libs/ecs/Datagram.hpp"
+#include "../../libs/ecs/PlayerMovement.hpp"
+
+/**
+ * @brief Sets the entity controlled by the local player and forgets any previous prediction.
+ *
+ * @param entityId The identifier of the player entity.
+ */
+void PlayerPrediction::setPlayer(std::int32_t entityId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assigned_ = true;
+    hasBase_ = false;
+    playerId_ = entityId;
+    pendingInputs_.clear();
+}
+
+/**
+ * @brief Gets the entity controlled by the local player.
+ *
+ * @param entityId Filled with the identifier of the player entity.
+ * @return true if a player entity was assigned, false otherwise.
+ */
+bool PlayerPrediction::getPlayer(std::int32_t& entityId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entityId = playerId_;
+    return assigned_;
+}
+
+/**
+ * @brief Applies a freshly sampled input to the predicted position.
+ *
+ * @param input The input that was just sent to the server.
+ * @param predicted Filled with the new predicted state of the player.
+ * @return true if a prediction is available, false otherwise.
+ */
+bool PlayerPrediction::predict(const Protocol::InputPayload& input, Protocol::EntityState& predicted) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!assigned_ || !hasBase_)
+        return false;
+    pendingInputs_.push_back(input);
+    if (pendingInputs_.size() > MAX_PENDING_INPUTS)
+        pendingInputs_.pop_front();
+    PlayerMovement::apply(input, predicted_.x, predicted_.y);
+    predicted = predicted_;
+    return true;
+}
+
+/**
+ * @brief Reconciles the prediction with an authoritative snapshot.
+ *
+ * @param snapshot The snapshot received from the server.
+ * @param predicted Filled with the reconciled predicted state of the player.
+ * @return true if the snapshot contains the player, false otherwise.
+ */
+bool PlayerPrediction::reconcile(const Snapshot& snapshot, Protocol::EntityState& predicted) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!assigned_)
+        return false;
+    const Protocol::EntityState* authoritative = snapshot.find(playerId_);
+    if (!authoritative)
+        return false;
+
+    const Protocol::InputAck* ack = snapshot.findInputAck(playerId_);
+    if (ack) {
+        while (!pendingInputs_.empty() && !Datagram::isNewer(pendingInputs_.front().sequence, ack->sequence))
+            pendingInputs_.pop_front();
+    }
+
+    predicted_ = *authoritative;
+    hasBase_ = true;
+    for (const Protocol::InputPayload& input : pendingInputs_) {
+        PlayerMovement::apply(input, predicted_.x, predicted_.y);
+    }
+    predicted = predicted_;
+    return true;
+}
+
+/**
+ * @brief Gets the number of inputs the server has not acknowledged yet.
+ *
+ * @return std::size_t The pending input count.
+ */
+std::size_t PlayerPrediction::getPendingCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pendingInputs_.size();
+}
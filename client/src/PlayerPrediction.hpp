@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include "../../libs/ecs/Message.hpp"
+#include "../../libs/ecs/Snapshot.hpp"
+
+/**
+ * @class PlayerPrediction
+ * @brief Predicts the local player's position ahead of the server.
+ *
+ * Every sampled input is applied locally right away with the server's movement rules
+ * (PlayerMovement) and kept until a snapshot acknowledges it. When a snapshot arrives,
+ * the predicted position is reset to the authoritative one and the inputs the server
+ * has not applied yet are replayed on top of it, so the player sees its own ship move
+ * without waiting a round trip, and mispredictions are corrected smoothly.
+ *
+ * The server applies exactly one input per sequence number: when an input is late, it
+ * repeats the previous keys under the late input's number and drops the input itself
+ * (see InputQueue), so replaying the unacknowledged inputs never counts a step twice.
+ *
+ * Inputs are sampled on the render thread while snapshots arrive on the IO thread, so
+ * every method is synchronized.
+ */
+class PlayerPrediction {
+   public:
+    static constexpr std::size_t MAX_PENDING_INPUTS = 128;  ///< Unacknowledged inputs kept before the oldest are dropped.
+
+    /**
+     * @brief Sets the entity controlled by the local player and forgets any previous prediction.
+     *
+     * @param entityId The identifier of the player entity.
+     */
+    void setPlayer(std::int32_t entityId);
+
+    /**
+     * @brief Gets the entity controlled by the local player.
+     *
+     * @param entityId Filled with the identifier of the player entity.
+     * @return true if a player entity was assigned, false otherwise.
+     */
+    bool getPlayer(std::int32_t& entityId);
+
+    /**
+     * @brief Applies a freshly sampled input to the predicted position.
+     *
+     * @param input The input that was just sent to the server.
+     * @param predicted Filled with the new predicted state of the player.
+     * @return true if a prediction is available, false before the first snapshot containing the player.
+     */
+    bool predict(const Protocol::InputPayload& input, Protocol::EntityState& predicted);
+
+    /**
+     * @brief Reconciles the prediction with an authoritative snapshot.
+     *
+     * Drops the inputs the snapshot acknowledges and replays the others from the player's
+     * position in the snapshot.
+     *
+     * @param snapshot The snapshot received from the server.
+     * @param predicted Filled with the reconciled predicted state of the player.
+     * @return true if the snapshot contains the player, false otherwise.
+     */
+    bool reconcile(const Snapshot& snapshot, Protocol::EntityState& predicted);
+
+    /**
+     * @brief Gets the number of inputs the server has not acknowledged yet.
+     *
+     * @return std::size_t The pending input count.
+     */
+    std::size_t getPendingCount();
+
+   private:
+    std::mutex mutex_;                                  ///< Protects the prediction between the render and IO threads.
+    bool assigned_ = false;                             ///< Whether playerId_ is known.
+    bool hasBase_ = false;                              ///< Whether predicted_ is based on a snapshot.
+    std::int32_t playerId_ = 0;                         ///< Entity controlled by the local player.
+    Protocol::EntityState predicted_;                   ///< Predicted state of the player.
+    std::deque<Protocol::InputPayload> pendingInputs_;  ///< Inputs sent but not yet acknowledged, oldest first.
+};
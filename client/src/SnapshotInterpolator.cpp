@@ -0,0 +1,109 @@
+#include "SnapshotInterpolator.hpp"
+#include <cmath>
+
+/**
+ * @brief Constructs a new Snapshot Interpolator.
+ *
+ * @param delay How far behind the estimated server time entities are rendered.
+ */
+SnapshotInterpolator::SnapshotInterpolator(std::chrono::milliseconds delay) : delay_(delay) {}
+
+/**
+ * @brief Records the entity positions of a snapshot.
+ *
+ * The clock offset follows the earliest arrival immediately and later arrivals slowly, so
+ * it tracks the least delayed path without jumping on a single late packet. Snapshots older
+ * than the newest one are ignored, and a jump of the server time by more than
+ * RESET_THRESHOLD_MS (a new source or a server restart) restarts the timeline.
+ *
+ * @param snapshot The snapshot received from the server.
+ * @param arrival When the snapshot was received.
+ */
+void SnapshotInterpolator::push(const Snapshot& snapshot, Clock::time_point arrival) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    double time = static_cast<double>(snapshot.sequence) * Protocol::TICK_INTERVAL_MS;
+    double local = std::chrono::duration<double, std::milli>(arrival - epoch_).count();
+
+    if (!started_ || std::fabs(time - lastTime_) > RESET_THRESHOLD_MS) {
+        if (started_)
+            ++stats_.resets;
+        started_ = true;
+        entities_.clear();
+        offset_ = local - time;
+    } else if (time <= lastTime_) {
+        return;
+    } else {
+        double observed = local - time;
+        if (observed < offset_)
+            offset_ = observed;
+        else
+            offset_ += (observed - offset_) * OFFSET_DRIFT;
+    }
+    lastTime_ = time;
+
+    std::erase_if(entities_, [&snapshot](const auto& entity) { return !snapshot.find(entity.first); });
+    for (const Protocol::EntityState& state : snapshot.states) {
+        std::deque<Sample>& samples = entities_[state.entityId];
+        samples.push_back({time, state.x, state.y});
+        if (samples.size() > MAX_SAMPLES)
+            samples.pop_front();
+    }
+}
+
+/**
+ * @brief Changes the interpolation delay.
+ *
+ * @param delay How far behind the estimated server time entities are rendered.
+ */
+void SnapshotInterpolator::setDelay(std::chrono::milliseconds delay) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    delay_ = delay;
+}
+
+/**
+ * @brief Gets the buffer statistics.
+ *
+ * @return Stats A copy of the counters.
+ */
+SnapshotInterpolator::Stats SnapshotInterpolator::getStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+/**
+ * @brief Converts a local time to the estimated server time.
+ *
+ * @param local The local time.
+ * @return double The server time, in milliseconds.
+ */
+double SnapshotInterpolator::toServerTime(Clock::time_point local) const {
+    return std::chrono::duration<double, std::milli>(local - epoch_).count() - offset_;
+}
+
+/**
+ * @brief Interpolates an entity at a render time and drops the samples no longer needed.
+ *
+ * An entity whose first sample is newer than the render time is shown at that sample, and
+ * one whose newest sample is older than the render time holds it.
+ *
+ * @param samples The samples of the entity, oldest first; never empty.
+ * @param renderTime The server time to render, in milliseconds.
+ * @param state Filled with the interpolated position.
+ * @return true if a sample newer than the render time was available, false on underrun.
+ */
+bool SnapshotInterpolator::interpolate(std::deque<Sample>& samples, double renderTime, Protocol::EntityState& state) {
+    while (samples.size() > 1 && samples[1].time <= renderTime)
+        samples.pop_front();
+
+    const Sample& from = samples.front();
+    if (from.time >= renderTime || samples.size() == 1) {
+        state.x = from.x;
+        state.y = from.y;
+        return from.time >= renderTime;
+    }
+    const Sample& to = samples[1];
+    float t = static_cast<float>((renderTime - from.time) / (to.time - from.time));
+    state.x = from.x + (to.x - from.x) * t;
+    state.y = from.y + (to.y - from.y) * t;
+    return true;
+}
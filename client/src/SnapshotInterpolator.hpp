@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include "../../libs/ecs/Message.hpp"
+#include "../../libs/ecs/Snapshot.hpp"
+
+/**
+ * @class SnapshotInterpolator
+ * @brief Buffers snapshots and renders remote entities a fixed delay in the past.
+ *
+ * Snapshots are stamped with the server time of their tick (sequence number times the
+ * tick interval). The offset between that time and the local clock is estimated from the
+ * earliest arrivals, so network jitter delays packets without shifting the timeline. Each
+ * frame is rendered at "now minus the delay" on that timeline, interpolating every entity
+ * between the two samples around it. As long as a snapshot is late by less than the delay,
+ * motion stays smooth; when it is later, the entity holds its newest position and the
+ * frame is counted as an underrun.
+ *
+ * Snapshots arrive on the IO thread while frames are sampled on the render thread, so
+ * every method is synchronized.
+ */
+class SnapshotInterpolator {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Clock used to time arrivals and frames.
+
+    static constexpr std::chrono::milliseconds DEFAULT_DELAY{100};  ///< About three server ticks.
+    static constexpr std::size_t MAX_SAMPLES = 32;                  ///< Samples kept per entity.
+    static constexpr double RESET_THRESHOLD_MS = 1000.0;            ///< Timeline jump that restarts the buffer.
+    static constexpr double OFFSET_DRIFT = 0.01;                    ///< Weight of a later arrival in the clock offset.
+
+    /**
+     * @struct Stats
+     * @brief Counters describing how well the buffer absorbs the network.
+     */
+    struct Stats {
+        std::uint64_t frames = 0;     ///< Frames sampled.
+        std::uint64_t underruns = 0;  ///< Frames where at least one entity had no sample newer than the render time.
+        std::uint64_t resets = 0;     ///< Times the timeline was restarted after a discontinuity.
+    };
+
+    /**
+     * @brief Constructs a new Snapshot Interpolator.
+     *
+     * @param delay How far behind the estimated server time entities are rendered.
+     */
+    explicit SnapshotInterpolator(std::chrono::milliseconds delay = DEFAULT_DELAY);
+
+    /**
+     * @brief Records the entity positions of a snapshot.
+     *
+     * @param snapshot The snapshot received from the server.
+     * @param arrival When the snapshot was received.
+     */
+    void push(const Snapshot& snapshot, Clock::time_point arrival = Clock::now());
+
+    /**
+     * @brief Computes the position of every buffered entity for a frame.
+     *
+     * @tparam Function Callable taking a const Protocol::EntityState&.
+     * @param now The time of the frame.
+     * @param function The function called with the interpolated state of each entity.
+     */
+    template <typename Function>
+    void sample(Clock::time_point now, Function&& function) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!started_)
+            return;
+        double renderTime = toServerTime(now) - static_cast<double>(delay_.count());
+        bool underrun = false;
+        for (auto& [entityId, samples] : entities_) {
+            Protocol::EntityState state;
+            underrun |= !interpolate(samples, renderTime, state);
+            state.entityId = entityId;
+            function(state);
+        }
+        ++stats_.frames;
+        if (underrun)
+            ++stats_.underruns;
+    }
+
+    /**
+     * @brief Changes the interpolation delay.
+     *
+     * @param delay How far behind the estimated server time entities are rendered.
+     */
+    void setDelay(std::chrono::milliseconds delay);
+
+    /**
+     * @brief Gets the buffer statistics.
+     *
+     * @return Stats A copy of the counters.
+     */
+    Stats getStats();
+
+   private:
+    /**
+     * @struct Sample
+     * @brief Position of an entity at a server time.
+     */
+    struct Sample {
+        double time = 0.0;  ///< Server time of the snapshot, in milliseconds.
+        float x = 0.0f;     ///< X coordinate.
+        float y = 0.0f;     ///< Y coordinate.
+    };
+
+    /**
+     * @brief Converts a local time to the estimated server time.
+     *
+     * @param local The local time.
+     * @return double The server time, in milliseconds.
+     */
+    double toServerTime(Clock::time_point local) const;
+
+    /**
+     * @brief Interpolates an entity at a render time and drops the samples no longer needed.
+     *
+     * @param samples The samples of the entity, oldest first.
+     * @param renderTime The server time to render, in milliseconds.
+     * @param state Filled with the interpolated position.
+     * @return true if a sample newer than the render time was available, false on underrun.
+     */
+    static bool interpolate(std::deque<Sample>& samples, double renderTime, Protocol::EntityState& state);
+
+    std::mutex mutex_;                                               ///< Protects the buffer between the IO and render threads.
+    std::chrono::milliseconds delay_;                                ///< Interpolation delay.
+    bool started_ = false;                                           ///< Whether offset_ has been estimated.
+    double offset_ = 0.0;                                            ///< Local time minus server time, in milliseconds.
+    double lastTime_ = 0.0;                                          ///< Server time of the newest snapshot.
+    Clock::time_point epoch_ = Clock::now();                         ///< Origin of the local timeline.
+    std::unordered_map<std::int32_t, std::deque<Sample>> entities_;  ///< Samples of each entity, oldest first.
+    Stats stats_;                                                    ///< Buffer statistics.
+};
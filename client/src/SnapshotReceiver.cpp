@@ -0,0 +1,143 @@
+#include "SnapshotReceiver.hpp"
+#include <iostream>
+
+/**
+ * @brief Constructs a new Snapshot Receiver.
+ *
+ * @param io_context ASIO IO context for asynchronous operations.
+ * @param handler Function called with every snapshot that is not stale.
+ * @param eventHandler Function called with every event, in the order the server sent them.
+ */
+SnapshotReceiver::SnapshotReceiver(asio::io_context& io_context, std::function<void(const Snapshot&)> handler,
+                                   std::function<void(const Message&)> eventHandler)
+    : socket_(io_context),
+      bindTimer_(io_context),
+      handler_(std::move(handler)),
+      eventHandler_(std::move(eventHandler)),
+      receiveBuffers_(RECEIVE_BATCH * Datagram::MAX_SIZE) {}
+
+/**
+ * @brief Opens the UDP socket and binds it to the session identified by a token.
+ *
+ * @param token The bind token received in a UDP_BIND message.
+ * @param serverEndpoint The server's UDP endpoint.
+ */
+void SnapshotReceiver::bind(std::uint32_t token, const asio::ip::udp::endpoint& serverEndpoint) {
+    asio::error_code ec;
+    if (!socket_.is_open()) {
+        socket_.open(serverEndpoint.protocol(), ec);
+        if (ec) {
+            std::cerr << "Failed to open UDP socket: " << ec.message() << std::endl;
+            return;
+        }
+        socket_.non_blocking(true, ec);
+        startReceive();
+    }
+    serverEndpoint_ = serverEndpoint;
+    stream_.reset();
+
+    Protocol::UdpBindPayload bind;
+    bind.token = token;
+    SnapshotStream::encodeControl(bind, bindDatagram_);
+    sendBind();
+}
+
+/**
+ * @brief Closes the UDP socket and cancels pending operations.
+ */
+void SnapshotReceiver::close() {
+    asio::error_code ec;
+    bindTimer_.cancel(ec);
+    if (socket_.is_open())
+        socket_.close(ec);
+}
+
+/**
+ * @brief Gets the number of datagrams dropped because they were stale or malformed.
+ *
+ * @return std::uint64_t The dropped datagram count.
+ */
+std::uint64_t SnapshotReceiver::getDroppedCount() const {
+    return dropped_;
+}
+
+/**
+ * @brief Sends the bind datagram and schedules a retry until the first snapshot arrives.
+ *
+ * The bind datagram can itself be lost, so it is repeated every 200 ms.
+ */
+void SnapshotReceiver::sendBind() {
+    if (stream_.isReceiving() || !socket_.is_open())
+        return;
+    asio::error_code ec;
+    socket_.send_to(asio::buffer(bindDatagram_), serverEndpoint_, 0, ec);
+    bindTimer_.expires_after(std::chrono::milliseconds(200));
+    bindTimer_.async_wait([this](const std::error_code& ec) {
+        if (!ec)
+            sendBind();
+    });
+}
+
+/**
+ * @brief Waits asynchronously for the socket to become readable.
+ */
+void SnapshotReceiver::startReceive() {
+    socket_.async_wait(asio::ip::udp::socket::wait_read, [this](std::error_code ec) {
+        if (!ec) {
+            drain();
+            startReceive();
+        } else if (ec != asio::error::operation_aborted) {
+            std::cerr << "UDP wait failed: " << ec.message() << std::endl;
+        }
+    });
+}
+
+/**
+ * @brief Reads every datagram currently queued on the socket.
+ *
+ * On Linux, up to RECEIVE_BATCH datagrams are read per recvmmsg call; elsewhere one
+ * receive_from is issued per datagram.
+ */
+void SnapshotReceiver::drain() {
+#ifdef __linux__
+    for (;;) {
+        for (std::size_t i = 0; i < RECEIVE_BATCH; ++i) {
+            iovecs_[i] = {receiveBuffers_.data() + i * Datagram::MAX_SIZE, Datagram::MAX_SIZE};
+            headers_[i] = mmsghdr{};
+            headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+            headers_[i].msg_hdr.msg_iovlen = 1;
+        }
+        int received = ::recvmmsg(socket_.native_handle(), headers_.data(), RECEIVE_BATCH, MSG_DONTWAIT, nullptr);
+        if (received <= 0)
+            return;
+        for (int i = 0; i < received; ++i) {
+            handleDatagram(std::span<const std::uint8_t>(receiveBuffers_.data() + i * Datagram::MAX_SIZE, headers_[i].msg_len));
+        }
+        if (static_cast<std::size_t>(received) < RECEIVE_BATCH)
+            return;
+    }
+#else
+    for (;;) {
+        asio::error_code ec;
+        asio::ip::udp::endpoint sender;
+        std::size_t length = socket_.receive_from(asio::buffer(receiveBuffers_.data(), Datagram::MAX_SIZE), sender, 0, ec);
+        if (ec)
+            return;
+        handleDatagram(std::span<const std::uint8_t>(receiveBuffers_.data(), length));
+    }
+#endif
+}
+
+/**
+ * @brief Hands a datagram to the stream and sends the acknowledgements it produces.
+ *
+ * @param datagram The received datagram.
+ */
+void SnapshotReceiver::handleDatagram(std::span<const std::uint8_t> datagram) {
+    auto send = [this](std::span<const std::uint8_t> reply) {
+        asio::error_code ec;
+        socket_.send_to(asio::buffer(reply.data(), reply.size()), serverEndpoint_, 0, ec);
+    };
+    if (!stream_.receive(datagram, SnapshotStream::Clock::now(), reliableDatagram_, handler_, eventHandler_, send))
+        ++dropped_;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <asio.hpp>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+#include "../../libs/ecs/Datagram.hpp"
+#include "../../libs/ecs/Message.hpp"
+#include "../../libs/ecs/Snapshot.hpp"
+#include "../../libs/ecs/SnapshotStream.hpp"
+
+/**
+ * @class SnapshotReceiver
+ * @brief Receives state snapshots and events from the server's UDP snapshot channel.
+ *
+ * Owns the UDP socket and hands every datagram to a SnapshotStream, which drops stale
+ * snapshots, rebuilds deltas against their baseline, orders the events and builds the
+ * acknowledgements sent back. On Linux, queued datagrams are drained with recvmmsg in
+ * batches.
+ */
+class SnapshotReceiver {
+   public:
+    static constexpr std::size_t RECEIVE_BATCH = 8;  ///< Maximum number of datagrams drained per syscall.
+
+    /**
+     * @brief Constructs a new Snapshot Receiver.
+     *
+     * @param io_context ASIO IO context for asynchronous operations.
+     * @param handler Function called with every snapshot that is not stale.
+     * @param eventHandler Function called with every event, in the order the server sent them.
+     */
+    SnapshotReceiver(asio::io_context& io_context, std::function<void(const Snapshot&)> handler,
+                     std::function<void(const Message&)> eventHandler);
+
+    /**
+     * @brief Opens the UDP socket and binds it to the session identified by a token.
+     *
+     * The token received over TCP is echoed to the server until the first snapshot arrives.
+     *
+     * @param token The bind token received in a UDP_BIND message.
+     * @param serverEndpoint The server's UDP endpoint.
+     */
+    void bind(std::uint32_t token, const asio::ip::udp::endpoint& serverEndpoint);
+
+    /**
+     * @brief Closes the UDP socket and cancels pending operations.
+     */
+    void close();
+
+    /**
+     * @brief Gets the number of datagrams dropped because they were stale or malformed.
+     *
+     * @return std::uint64_t The dropped datagram count.
+     */
+    std::uint64_t getDroppedCount() const;
+
+   private:
+    /**
+     * @brief Sends the bind datagram and schedules a retry until the first snapshot arrives.
+     */
+    void sendBind();
+
+    /**
+     * @brief Waits asynchronously for the socket to become readable.
+     */
+    void startReceive();
+
+    /**
+     * @brief Reads every datagram currently queued on the socket.
+     */
+    void drain();
+
+    /**
+     * @brief Hands a datagram to the stream and sends the acknowledgements it produces.
+     *
+     * @param datagram The received datagram.
+     */
+    void handleDatagram(std::span<const std::uint8_t> datagram);
+
+    /// Encoded reliable packet datagram: sequence prefix followed by a RELIABLE message.
+    using ReliableDatagram = std::array<std::uint8_t, SnapshotStream::PACKET_DATAGRAM_SIZE>;
+
+    asio::ip::udp::socket socket_;                                            ///< Socket receiving snapshots.
+    asio::ip::udp::endpoint serverEndpoint_;                                  ///< The server's UDP endpoint.
+    asio::steady_timer bindTimer_;                                            ///< Timer for bind retries.
+    std::function<void(const Snapshot&)> handler_;                            ///< Called for each fresh snapshot.
+    std::function<void(const Message&)> eventHandler_;                        ///< Called for each event, in order.
+    SnapshotStream::ControlDatagram<Protocol::UdpBindPayload> bindDatagram_;  ///< Datagram echoing the bind token.
+    SnapshotStream stream_;                                                   ///< Drops, rebuilds and acknowledges snapshots and events.
+    std::uint64_t dropped_ = 0;                                               ///< Number of stale, malformed or undecodable datagrams.
+    std::vector<std::uint8_t> receiveBuffers_;                                ///< RECEIVE_BATCH contiguous datagram buffers.
+    ReliableDatagram reliableDatagram_;                                       ///< Datagram acknowledging events.
+#ifdef __linux__
+    std::array<mmsghdr, RECEIVE_BATCH> headers_;  ///< Per-datagram headers of the recvmmsg batch.
+    std::array<iovec, RECEIVE_BATCH> iovecs_;     ///< Buffer descriptors of the recvmmsg batch.
+#endif
+};
@@ -1,5 +1,10 @@
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 #include "GameClient.hpp"
+#include "NetworkSimulator.hpp"
 
 const int SERVER_PORT = 4242;
 
@@ -7,18 +12,53 @@ const int SERVER_PORT = 4242;
  * @brief The entry point for the game client.
  *
  * @param argc The count of command-line arguments.
- * @param argv The command-line arguments, expected to include the server's IP address.
+ * @param argv The command-line arguments: the server's IP address, then optionally the
+ *             interpolation delay of remote entities in milliseconds. Anywhere among them,
+ *             --netsim followed by network conditions routes the connection through a local
+ *             network simulator, and --spectate watches a match instead of playing.
  * @return int The exit status of the application.
  */
 int main(int argc, char* argv[]) {
     try {
-        if (argc != 2) {
-            std::cout << "Usage: " << argv[0] << " <server_ip>" << std::endl;
+        std::vector<std::string> args;
+        std::optional<NetworkConditions> conditions;
+        bool spectate = false;
+        for (int i = 1; i < argc; i++) {
+            if (std::string(argv[i]) == "--spectate") {
+                spectate = true;
+                continue;
+            }
+            if (std::string(argv[i]) != "--netsim") {
+                args.push_back(argv[i]);
+                continue;
+            }
+            conditions.emplace();
+            if (++i >= argc || !NetworkConditions::parse(argv[i], *conditions)) {
+                args.clear();
+                break;
+            }
+        }
+        if (args.size() != 1 && args.size() != 2) {
+            std::cout << "Usage: " << argv[0] << " <server_ip> [interpolation_delay_ms] [--netsim settings] [--spectate]" << std::endl
+                      << "settings: e.g. latency=80,jitter=20,loss=2,reorder=1,bandwidth=512,seed=7" << std::endl;
             return 0;
         }
+        std::chrono::milliseconds delay = SnapshotInterpolator::DEFAULT_DELAY;
+        if (args.size() == 2)
+            delay = std::chrono::milliseconds(std::stoi(args[1]));
+
+        std::string host = args[0];
+        std::string port = std::to_string(SERVER_PORT);
+        std::unique_ptr<NetworkSimulator> simulator;
+        if (conditions) {
+            asio::ip::tcp::endpoint listen(asio::ip::make_address("127.0.0.1"), 0);
+            simulator = std::make_unique<NetworkSimulator>(listen, host, port, *conditions);
+            host = "127.0.0.1";
+            port = std::to_string(simulator->getPort());
+        }
 
         asio::io_context io_context;
-        GameClient client(io_context, argv[1], std::to_string(SERVER_PORT));
+        GameClient client(io_context, host, port, delay, spectate);
 
         std::thread clientThread([&io_context]() { io_context.run(); });
 
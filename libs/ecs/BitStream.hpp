@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * @class BitWriter
+ * @brief Packs fields of arbitrary bit width into a caller-provided byte buffer.
+ *
+ * Bits are written least significant first, filling each byte from its lowest bit, so a
+ * 16-bit field written at a byte boundary has the same layout as a little-endian u16.
+ * Like ByteWriter, the writer never allocates and sets an overflow flag instead of
+ * writing past the end of the buffer. Unused bits of the last byte are zero.
+ */
+class BitWriter {
+   public:
+    /**
+     * @brief Construct a new Bit Writer over the given buffer.
+     *
+     * @param buffer The destination buffer.
+     */
+    explicit BitWriter(std::span<std::uint8_t> buffer) : buffer_(buffer) {}
+
+    /**
+     * @brief Writes the low bits of a value.
+     *
+     * @param value The value to write; bits above count are ignored.
+     * @param count Number of bits to write, at most 32.
+     */
+    void writeBits(std::uint32_t value, unsigned count) {
+        if (overflow_ || count > remainingBits()) {
+            overflow_ = true;
+            return;
+        }
+        while (count > 0) {
+            std::size_t index = bitOffset_ / 8;
+            unsigned shift = bitOffset_ % 8;
+            unsigned width = std::min(8u - shift, count);
+            std::uint8_t kept = static_cast<std::uint8_t>(buffer_[index] & ((1u << shift) - 1));
+            buffer_[index] = static_cast<std::uint8_t>(kept | ((value & ((1u << width) - 1)) << shift));
+            value >>= width;
+            bitOffset_ += width;
+            count -= width;
+        }
+    }
+
+    /**
+     * @brief Writes a single bit.
+     *
+     * @param value The bit to write.
+     */
+    void writeBool(bool value) { writeBits(value ? 1 : 0, 1); }
+
+    /**
+     * @brief Writes an unsigned value as a variable-length integer.
+     *
+     * The value is split in 7-bit groups, least significant first, each followed by a
+     * continuation bit, so values below 128 take 8 bits and the largest take 40.
+     *
+     * @param value The value to write.
+     */
+    void writeVarUInt(std::uint32_t value) {
+        do {
+            std::uint32_t group = value & 0x7F;
+            value >>= 7;
+            writeBits(group | (value != 0 ? 0x80 : 0), 8);
+        } while (value != 0 && !overflow_);
+    }
+
+    /**
+     * @brief Overwrites a field that has already been written.
+     *
+     * Used to patch count fields once the rest of a message is known.
+     *
+     * @param bitOffset The bit offset of the field to patch.
+     * @param value The value to write.
+     * @param count Width of the field in bits, at most 32.
+     */
+    void patchBits(std::size_t bitOffset, std::uint32_t value, unsigned count) {
+        if (bitOffset + count > bitOffset_)
+            return;
+        while (count > 0) {
+            std::size_t index = bitOffset / 8;
+            unsigned shift = bitOffset % 8;
+            unsigned width = std::min(8u - shift, count);
+            std::uint8_t mask = static_cast<std::uint8_t>(((1u << width) - 1) << shift);
+            buffer_[index] = static_cast<std::uint8_t>((buffer_[index] & ~mask) | ((value << shift) & mask));
+            value >>= width;
+            bitOffset += width;
+            count -= width;
+        }
+    }
+
+    /**
+     * @brief Gets the number of bits written so far.
+     *
+     * @return std::size_t The current write offset in bits.
+     */
+    std::size_t bitSize() const { return bitOffset_; }
+
+    /**
+     * @brief Gets the number of bytes holding the bits written so far.
+     *
+     * @return std::size_t The written size rounded up to whole bytes.
+     */
+    std::size_t size() const { return (bitOffset_ + 7) / 8; }
+
+    /**
+     * @brief Gets the number of bits still available in the buffer.
+     *
+     * @return std::size_t The remaining capacity in bits.
+     */
+    std::size_t remainingBits() const { return buffer_.size() * 8 - bitOffset_; }
+
+    /**
+     * @brief Checks whether every write so far fitted in the buffer.
+     *
+     * @return true if no write overflowed, false otherwise.
+     */
+    bool ok() const { return !overflow_; }
+
+   private:
+    std::span<std::uint8_t> buffer_;  ///< Destination buffer.
+    std::size_t bitOffset_ = 0;       ///< Current write offset in bits.
+    bool overflow_ = false;           ///< Set once a write did not fit.
+};
+
+/**
+ * @class BitReader
+ * @brief Reads fields packed by a BitWriter without copying the buffer.
+ *
+ * Reading past the end of the buffer, or a variable-length integer longer than 32 bits,
+ * returns zero and sets an error flag, so a malformed message is detected by checking
+ * ok() after decoding.
+ */
+class BitReader {
+   public:
+    /**
+     * @brief Construct a new Bit Reader over the given buffer.
+     *
+     * @param buffer The source buffer.
+     */
+    explicit BitReader(std::span<const std::uint8_t> buffer) : buffer_(buffer) {}
+
+    /**
+     * @brief Reads a field of the given width.
+     *
+     * @param count Number of bits to read, at most 32.
+     * @return std::uint32_t The value read, or 0 on underflow.
+     */
+    std::uint32_t readBits(unsigned count) {
+        if (error_ || count > remainingBits()) {
+            error_ = true;
+            return 0;
+        }
+        std::uint32_t value = 0;
+        unsigned position = 0;
+        while (position < count) {
+            std::size_t index = bitOffset_ / 8;
+            unsigned shift = bitOffset_ % 8;
+            unsigned width = std::min(8u - shift, count - position);
+            value |= static_cast<std::uint32_t>((buffer_[index] >> shift) & ((1u << width) - 1)) << position;
+            bitOffset_ += width;
+            position += width;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Reads a single bit.
+     *
+     * @return bool The bit read, or false on underflow.
+     */
+    bool readBool() { return readBits(1) != 0; }
+
+    /**
+     * @brief Reads a variable-length integer written by BitWriter::writeVarUInt.
+     *
+     * @return std::uint32_t The value read, or 0 if it is truncated or too long.
+     */
+    std::uint32_t readVarUInt() {
+        std::uint32_t value = 0;
+        for (unsigned shift = 0; shift < 35; shift += 7) {
+            std::uint32_t group = readBits(8);
+            value |= (group & 0x7F) << shift;
+            if ((group & 0x80) == 0)
+                return error_ ? 0 : value;
+        }
+        error_ = true;
+        return 0;
+    }
+
+    /**
+     * @brief Skips fields that have already been validated.
+     *
+     * @param count Number of bits to skip.
+     */
+    void skipBits(std::size_t count) {
+        if (error_ || count > remainingBits()) {
+            error_ = true;
+            return;
+        }
+        bitOffset_ += count;
+    }
+
+    /**
+     * @brief Gets the number of bits consumed so far.
+     *
+     * @return std::size_t The current read offset in bits.
+     */
+    std::size_t bitOffset() const { return bitOffset_; }
+
+    /**
+     * @brief Gets the number of bits left to read.
+     *
+     * @return std::size_t The remaining bit count.
+     */
+    std::size_t remainingBits() const { return buffer_.size() * 8 - bitOffset_; }
+
+    /**
+     * @brief Checks whether everything but the padding of the last byte has been read.
+     *
+     * @return true if fewer than 8 bits are left, false otherwise.
+     */
+    bool atEnd() const { return remainingBits() < 8; }
+
+    /**
+     * @brief Checks whether every read so far was valid.
+     *
+     * @return true if no read underflowed or was malformed, false otherwise.
+     */
+    bool ok() const { return !error_; }
+
+   private:
+    std::span<const std::uint8_t> buffer_;  ///< Source buffer.
+    std::size_t bitOffset_ = 0;             ///< Current read offset in bits.
+    bool error_ = false;                    ///< Set once a read went past the end or was malformed.
+};
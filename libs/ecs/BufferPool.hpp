@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <span>
+#include <vector>
+#include "Message.hpp"
+
+class BufferPool;
+
+/**
+ * @class BufferBlock
+ * @brief Reference-counted block holding one encoded message, followed in memory by its bytes.
+ *
+ * Blocks are handed out by a BufferPool and referenced through SharedBuffer handles; the
+ * last handle released gives the block back to its pool.
+ */
+class BufferBlock {
+   public:
+    /**
+     * @brief Gets the encoded bytes.
+     *
+     * @return const std::uint8_t* The first byte of the message.
+     */
+    const std::uint8_t* data() const { return reinterpret_cast<const std::uint8_t*>(this + 1); }
+
+    /**
+     * @brief Gets the size of the encoded message.
+     *
+     * @return std::size_t The size in bytes.
+     */
+    std::size_t size() const { return size_; }
+
+    /**
+     * @brief Gets the first byte of the message, for range-based algorithms.
+     *
+     * @return const std::uint8_t* The first byte.
+     */
+    const std::uint8_t* begin() const { return data(); }
+
+    /**
+     * @brief Gets one past the last byte of the message, for range-based algorithms.
+     *
+     * @return const std::uint8_t* One past the last byte.
+     */
+    const std::uint8_t* end() const { return data() + size_; }
+
+   private:
+    friend class BufferPool;
+    friend class SharedBuffer;
+
+    /**
+     * @brief Gets the writable bytes, for the pool filling a new block.
+     *
+     * @return std::uint8_t* The first byte of the block's storage.
+     */
+    std::uint8_t* bytes() { return reinterpret_cast<std::uint8_t*>(this + 1); }
+
+    std::atomic<std::uint32_t> references_{0};  ///< Number of SharedBuffer handles.
+    std::uint32_t size_ = 0;                    ///< Size of the message.
+    std::uint32_t sizeClass_ = 0;               ///< Index of the pool size class, or BufferPool::FALLBACK_CLASS.
+    BufferPool* pool_ = nullptr;                ///< Pool the block returns to.
+};
+
+/**
+ * @class BufferPool
+ * @brief Recycles fixed-size message blocks, so the steady-state send path does not allocate.
+ *
+ * Blocks come in a few size classes. Each class grows by slabs of contiguous blocks, up to
+ * a block limit, and keeps released blocks on a free list for reuse. A message larger than
+ * the largest class, or arriving while its class is at the limit with no free block, is
+ * served by a plain allocation instead, counted as a fallback and freed on release.
+ *
+ * Blocks are acquired by the match workers and released by the IO threads once written,
+ * so every free list is guarded by its own short-held mutex.
+ */
+class BufferPool {
+   public:
+    static constexpr std::uint32_t FALLBACK_CLASS = UINT32_MAX;  ///< Size class of blocks allocated outside the pool.
+
+    /**
+     * @struct SizeClass
+     * @brief Layout of the blocks of one size class.
+     */
+    struct SizeClass {
+        std::size_t blockSize;      ///< Largest message a block holds.
+        std::size_t blocksPerSlab;  ///< Blocks allocated at once when the class grows.
+        std::size_t maxBlocks;      ///< Largest number of blocks the class owns.
+    };
+
+    /**
+     * @brief Default size classes: events and small snapshots, large snapshots, and the largest message.
+     */
+    static constexpr std::array<SizeClass, 3> DEFAULT_CLASSES = {{{256, 256, 16384}, {4096, 32, 2048}, {Protocol::MAX_MESSAGE_SIZE, 4, 64}}};
+
+    /**
+     * @struct Stats
+     * @brief Pool occupancy and fallback counters.
+     */
+    struct Stats {
+        std::size_t blocksInUse = 0;            ///< Pooled blocks referenced by at least one handle.
+        std::size_t blocksOwned = 0;            ///< Pooled blocks allocated so far, in use or free.
+        std::size_t fallbacksInUse = 0;         ///< Fallback blocks referenced by at least one handle.
+        std::uint64_t fallbackAllocations = 0;  ///< Messages served outside the pool since it was created.
+    };
+
+    /**
+     * @brief Constructs an empty pool; slabs are allocated on first use.
+     */
+    BufferPool() = default;
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * @brief Frees every slab. Blocks must not be referenced anymore.
+     */
+    ~BufferPool() {
+        for (Class& sizeClass : classes_) {
+            for (std::uint8_t* slab : sizeClass.slabs) {
+                ::operator delete(slab);
+            }
+        }
+    }
+
+    /**
+     * @brief Takes a block and copies a message into it.
+     *
+     * The smallest size class holding the message is used; if it is at its limit with no
+     * free block, the message is served outside the pool rather than by a larger class.
+     *
+     * @param bytes The encoded message.
+     * @return BufferBlock* The block, with no reference yet.
+     */
+    BufferBlock* acquire(std::span<const std::uint8_t> bytes) {
+        BufferBlock* block = nullptr;
+        auto fits = std::find_if(DEFAULT_CLASSES.begin(), DEFAULT_CLASSES.end(),
+                                 [&](const SizeClass& layout) { return bytes.size() <= layout.blockSize; });
+        if (fits != DEFAULT_CLASSES.end())
+            block = acquireFrom(static_cast<std::uint32_t>(fits - DEFAULT_CLASSES.begin()));
+        if (!block) {
+            fallbackAllocations_.fetch_add(1, std::memory_order_relaxed);
+            fallbacksInUse_.fetch_add(1, std::memory_order_relaxed);
+            block = new (::operator new(sizeof(BufferBlock) + bytes.size())) BufferBlock();
+            block->sizeClass_ = FALLBACK_CLASS;
+            block->pool_ = this;
+        }
+        block->size_ = static_cast<std::uint32_t>(bytes.size());
+        if (!bytes.empty())
+            std::memcpy(block->bytes(), bytes.data(), bytes.size());
+        return block;
+    }
+
+    /**
+     * @brief Gives a block whose last reference was dropped back to the pool.
+     *
+     * @param block The block.
+     */
+    void release(BufferBlock* block) {
+        if (block->sizeClass_ == FALLBACK_CLASS) {
+            fallbacksInUse_.fetch_sub(1, std::memory_order_relaxed);
+            block->~BufferBlock();
+            ::operator delete(block);
+            return;
+        }
+        Class& sizeClass = classes_[block->sizeClass_];
+        sizeClass.inUse.fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        sizeClass.freeBlocks.push_back(block);
+    }
+
+    /**
+     * @brief Gets the occupancy and fallback counters.
+     *
+     * @return Stats A snapshot of the counters.
+     */
+    Stats getStats() const {
+        Stats stats;
+        for (const Class& sizeClass : classes_) {
+            stats.blocksInUse += sizeClass.inUse.load(std::memory_order_relaxed);
+            stats.blocksOwned += sizeClass.owned.load(std::memory_order_relaxed);
+        }
+        stats.fallbacksInUse = fallbacksInUse_.load(std::memory_order_relaxed);
+        stats.fallbackAllocations = fallbackAllocations_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+   private:
+    /**
+     * @struct Class
+     * @brief Blocks of one size class.
+     */
+    struct Class {
+        std::mutex mutex;                      ///< Protects the lists below.
+        std::vector<BufferBlock*> freeBlocks;  ///< Blocks ready for reuse.
+        std::vector<std::uint8_t*> slabs;      ///< Slabs the blocks live in, freed with the pool.
+        std::atomic<std::size_t> inUse{0};     ///< Blocks currently referenced.
+        std::atomic<std::size_t> owned{0};     ///< Blocks allocated in slabs.
+    };
+
+    /**
+     * @brief Takes a free block of a size class, growing the class by a slab if needed.
+     *
+     * @param index The size class.
+     * @return BufferBlock* The block, or nullptr if the class is at its limit with no free block.
+     */
+    BufferBlock* acquireFrom(std::uint32_t index) {
+        Class& sizeClass = classes_[index];
+        const SizeClass& layout = DEFAULT_CLASSES[index];
+        std::lock_guard<std::mutex> lock(sizeClass.mutex);
+        if (sizeClass.freeBlocks.empty()) {
+            std::size_t owned = sizeClass.owned.load(std::memory_order_relaxed);
+            if (owned >= layout.maxBlocks)
+                return nullptr;
+            std::size_t count = std::min(layout.blocksPerSlab, layout.maxBlocks - owned);
+            std::size_t stride = blockStride(layout.blockSize);
+            auto* slab = static_cast<std::uint8_t*>(::operator new(count * stride));
+            sizeClass.slabs.push_back(slab);
+            sizeClass.freeBlocks.reserve(sizeClass.freeBlocks.size() + count);
+            for (std::size_t i = count; i-- > 0;) {
+                BufferBlock* block = new (slab + i * stride) BufferBlock();
+                block->sizeClass_ = index;
+                block->pool_ = this;
+                sizeClass.freeBlocks.push_back(block);
+            }
+            sizeClass.owned.store(owned + count, std::memory_order_relaxed);
+        }
+        BufferBlock* block = sizeClass.freeBlocks.back();
+        sizeClass.freeBlocks.pop_back();
+        sizeClass.inUse.fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
+    /**
+     * @brief Gets the distance between two blocks of a slab.
+     *
+     * @param blockSize The largest message a block holds.
+     * @return std::size_t The header plus the message bytes, rounded up to the block alignment.
+     */
+    static constexpr std::size_t blockStride(std::size_t blockSize) {
+        std::size_t raw = sizeof(BufferBlock) + blockSize;
+        return (raw + alignof(BufferBlock) - 1) / alignof(BufferBlock) * alignof(BufferBlock);
+    }
+
+    std::array<Class, DEFAULT_CLASSES.size()> classes_;  ///< Blocks of each size class.
+    std::atomic<std::size_t> fallbacksInUse_{0};         ///< Fallback blocks currently referenced.
+    std::atomic<std::uint64_t> fallbackAllocations_{0};  ///< Messages served outside the pool.
+};
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * @class ByteWriter
+ * @brief Writes little-endian typed fields into a caller-provided byte buffer.
+ *
+ * The writer never allocates: it only fills the span it was given. Writing past the end
+ * of the buffer sets an overflow flag instead of touching memory, so callers can encode
+ * a whole message and check ok() once at the end.
+ */
+class ByteWriter {
+   public:
+    /**
+     * @brief Construct a new Byte Writer over the given buffer.
+     *
+     * @param buffer The destination buffer.
+     */
+    explicit ByteWriter(std::span<std::uint8_t> buffer) : buffer_(buffer) {}
+
+    /**
+     * @brief Writes an unsigned 8-bit value.
+     *
+     * @param value The value to write.
+     */
+    void writeU8(std::uint8_t value) {
+        if (!reserve(1))
+            return;
+        buffer_[offset_++] = value;
+    }
+
+    /**
+     * @brief Writes an unsigned 16-bit value in little-endian order.
+     *
+     * @param value The value to write.
+     */
+    void writeU16(std::uint16_t value) {
+        if (!reserve(2))
+            return;
+        buffer_[offset_++] = static_cast<std::uint8_t>(value);
+        buffer_[offset_++] = static_cast<std::uint8_t>(value >> 8);
+    }
+
+    /**
+     * @brief Writes an unsigned 32-bit value in little-endian order.
+     *
+     * @param value The value to write.
+     */
+    void writeU32(std::uint32_t value) {
+        if (!reserve(4))
+            return;
+        for (int shift = 0; shift < 32; shift += 8) {
+            buffer_[offset_++] = static_cast<std::uint8_t>(value >> shift);
+        }
+    }
+
+    /**
+     * @brief Writes an unsigned 64-bit value in little-endian order.
+     *
+     * @param value The value to write.
+     */
+    void writeU64(std::uint64_t value) {
+        if (!reserve(8))
+            return;
+        for (int shift = 0; shift < 64; shift += 8) {
+            buffer_[offset_++] = static_cast<std::uint8_t>(value >> shift);
+        }
+    }
+
+    /**
+     * @brief Writes a signed 32-bit value in little-endian order.
+     *
+     * @param value The value to write.
+     */
+    void writeI32(std::int32_t value) { writeU32(static_cast<std::uint32_t>(value)); }
+
+    /**
+     * @brief Writes an IEEE-754 single precision float in little-endian order.
+     *
+     * @param value The value to write.
+     */
+    void writeF32(float value) { writeU32(std::bit_cast<std::uint32_t>(value)); }
+
+    /**
+     * @brief Writes raw bytes.
+     *
+     * @param bytes The bytes to write.
+     */
+    void writeBytes(std::span<const std::uint8_t> bytes) {
+        if (!reserve(bytes.size()))
+            return;
+        std::copy(bytes.begin(), bytes.end(), buffer_.begin() + static_cast<std::ptrdiff_t>(offset_));
+        offset_ += bytes.size();
+    }
+
+    /**
+     * @brief Overwrites an unsigned 16-bit value at an already written offset.
+     *
+     * Used to patch length and count fields once the rest of a message is known.
+     *
+     * @param offset The offset of the field to patch.
+     * @param value The value to write.
+     */
+    void patchU16(std::size_t offset, std::uint16_t value) {
+        if (offset + 2 > offset_)
+            return;
+        buffer_[offset] = static_cast<std::uint8_t>(value);
+        buffer_[offset + 1] = static_cast<std::uint8_t>(value >> 8);
+    }
+
+    /**
+     * @brief Gets the number of bytes written so far.
+     *
+     * @return std::size_t The current write offset.
+     */
+    std::size_t size() const { return offset_; }
+
+    /**
+     * @brief Gets the number of bytes still available in the buffer.
+     *
+     * @return std::size_t The remaining capacity.
+     */
+    std::size_t remaining() const { return buffer_.size() - offset_; }
+
+    /**
+     * @brief Checks whether every write so far fitted in the buffer.
+     *
+     * @return true if no write overflowed, false otherwise.
+     */
+    bool ok() const { return !overflow_; }
+
+   private:
+    std::span<std::uint8_t> buffer_;  ///< Destination buffer.
+    std::size_t offset_ = 0;          ///< Current write offset.
+    bool overflow_ = false;           ///< Set once a write did not fit.
+
+    /**
+     * @brief Checks that the next write of the given size fits in the buffer.
+     *
+     * @param count Number of bytes about to be written.
+     * @return true if the write fits, false otherwise (and the overflow flag is set).
+     */
+    bool reserve(std::size_t count) {
+        if (overflow_ || count > remaining()) {
+            overflow_ = true;
+            return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @class ByteReader
+ * @brief Reads little-endian typed fields from a byte buffer without copying it.
+ *
+ * Reading past the end of the buffer returns zero and sets an underflow flag, so a
+ * truncated message is detected by checking ok() after decoding.
+ */
+class ByteReader {
+   public:
+    /**
+     * @brief Construct a new Byte Reader over the given buffer.
+     *
+     * @param buffer The source buffer.
+     */
+    explicit ByteReader(std::span<const std::uint8_t> buffer) : buffer_(buffer) {}
+
+    /**
+     * @brief Reads an unsigned 8-bit value.
+     *
+     * @return std::uint8_t The value read, or 0 on underflow.
+     */
+    std::uint8_t readU8() {
+        if (!require(1))
+            return 0;
+        return buffer_[offset_++];
+    }
+
+    /**
+     * @brief Reads an unsigned 16-bit little-endian value.
+     *
+     * @return std::uint16_t The value read, or 0 on underflow.
+     */
+    std::uint16_t readU16() {
+        if (!require(2))
+            return 0;
+        std::uint16_t value = static_cast<std::uint16_t>(buffer_[offset_] | (buffer_[offset_ + 1] << 8));
+        offset_ += 2;
+        return value;
+    }
+
+    /**
+     * @brief Reads an unsigned 32-bit little-endian value.
+     *
+     * @return std::uint32_t The value read, or 0 on underflow.
+     */
+    std::uint32_t readU32() {
+        if (!require(4))
+            return 0;
+        std::uint32_t value = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            value |= static_cast<std::uint32_t>(buffer_[offset_++]) << shift;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Reads an unsigned 64-bit little-endian value.
+     *
+     * @return std::uint64_t The value read, or 0 on underflow.
+     */
+    std::uint64_t readU64() {
+        if (!require(8))
+            return 0;
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 8) {
+            value |= static_cast<std::uint64_t>(buffer_[offset_++]) << shift;
+        }
+        return value;
+    }
+
+    /**
+     * @brief Reads a signed 32-bit little-endian value.
+     *
+     * @return std::int32_t The value read, or 0 on underflow.
+     */
+    std::int32_t readI32() { return static_cast<std::int32_t>(readU32()); }
+
+    /**
+     * @brief Reads an IEEE-754 single precision little-endian float.
+     *
+     * @return float The value read, or 0 on underflow.
+     */
+    float readF32() { return std::bit_cast<float>(readU32()); }
+
+    /**
+     * @brief Reads raw bytes without copying them.
+     *
+     * @param count The number of bytes to read.
+     * @return std::span<const std::uint8_t> A view over the bytes, or an empty view on underflow.
+     */
+    std::span<const std::uint8_t> readBytes(std::size_t count) {
+        if (!require(count))
+            return {};
+        std::span<const std::uint8_t> bytes = buffer_.subspan(offset_, count);
+        offset_ += count;
+        return bytes;
+    }
+
+    /**
+     * @brief Gets the number of bytes consumed so far.
+     *
+     * @return std::size_t The current read offset.
+     */
+    std::size_t offset() const { return offset_; }
+
+    /**
+     * @brief Gets the number of bytes left to read.
+     *
+     * @return std::size_t The remaining byte count.
+     */
+    std::size_t remaining() const { return buffer_.size() - offset_; }
+
+    /**
+     * @brief Checks whether every read so far was within the buffer.
+     *
+     * @return true if no read underflowed, false otherwise.
+     */
+    bool ok() const { return !underflow_; }
+
+   private:
+    std::span<const std::uint8_t> buffer_;  ///< Source buffer.
+    std::size_t offset_ = 0;                ///< Current read offset.
+    bool underflow_ = false;                ///< Set once a read went past the end.
+
+    /**
+     * @brief Checks that the next read of the given size is within the buffer.
+     *
+     * @param count Number of bytes about to be read.
+     * @return true if the read fits, false otherwise (and the underflow flag is set).
+     */
+    bool require(std::size_t count) {
+        if (underflow_ || count > remaining()) {
+            underflow_ = true;
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "ByteStream.hpp"
+
+/**
+ * @namespace Datagram
+ * @brief Framing of messages sent over the unreliable UDP channel.
+ *
+ * Every datagram is a 4-byte little-endian sequence number followed by exactly one
+ * encoded Message. The sequence lets the receiver discard datagrams that arrive late
+ * or out of order, since a newer snapshot always supersedes an older one.
+ */
+namespace Datagram {
+
+const std::size_t HEADER_SIZE = 4;                            ///< Size of the sequence number prefix in bytes.
+const std::size_t MAX_SIZE = 65507;                           ///< Largest UDP payload over IPv4.
+const std::size_t MAX_MESSAGE_SIZE = MAX_SIZE - HEADER_SIZE;  ///< Largest message a datagram can carry.
+
+/**
+ * @brief Encodes the sequence number prefix of a datagram.
+ *
+ * @param sequence The sequence number.
+ * @param out The destination buffer, at least HEADER_SIZE bytes long.
+ * @return true if the prefix fitted in the buffer, false otherwise.
+ */
+inline bool encodeHeader(std::uint32_t sequence, std::span<std::uint8_t> out) {
+    ByteWriter writer(out);
+    writer.writeU32(sequence);
+    return writer.ok();
+}
+
+/**
+ * @brief Splits a received datagram into its sequence number and message bytes.
+ *
+ * @param datagram The received datagram.
+ * @param sequence Filled with the sequence number.
+ * @param message Filled with a view over the message bytes.
+ * @return true if the datagram is long enough to hold a prefix, false otherwise.
+ */
+inline bool decode(std::span<const std::uint8_t> datagram, std::uint32_t& sequence, std::span<const std::uint8_t>& message) {
+    ByteReader reader(datagram);
+    sequence = reader.readU32();
+    if (!reader.ok())
+        return false;
+    message = datagram.subspan(HEADER_SIZE);
+    return true;
+}
+
+/**
+ * @brief Compares two sequence numbers, taking wrap-around into account.
+ *
+ * @param a The candidate sequence number.
+ * @param b The reference sequence number.
+ * @return true if a was sent after b, false otherwise.
+ */
+inline bool isNewer(std::uint32_t a, std::uint32_t b) {
+    return static_cast<std::int32_t>(a - b) > 0;
+}
+
+}  // namespace Datagram
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+#include "Message.hpp"
+
+/**
+ * @class FrameAssembler
+ * @brief Reassembles length-prefixed messages from a TCP byte stream.
+ *
+ * TCP does not preserve message boundaries: one read can hold several messages, or only
+ * part of one. Every message starts with a Protocol::MessageHeader whose payload size acts
+ * as the frame length, so the assembler accumulates bytes in a per-session buffer and hands
+ * out each message once it is complete. Leftover bytes of a partial message are kept for
+ * the next read.
+ *
+ * The buffer is used as a contiguous ring: reads append at the write offset and messages
+ * are decoded in place, as views, from the read offset. Nothing is copied per message or
+ * per read; the unconsumed tail is moved back to the front only when the next message
+ * could no longer fit before the end of the buffer or the free region gets too small for
+ * an efficient read, which happens at most once per lap of the buffer. When every byte is
+ * consumed, both offsets simply rewind.
+ *
+ * Typical use with an asynchronous read:
+ * @code
+ * auto space = assembler.prepare();
+ * socket.async_read_some(asio::buffer(space.data(), space.size()), [&](std::error_code ec, std::size_t n) {
+ *     assembler.commit(n);
+ *     assembler.consume([](const Message& message) { ... });
+ * });
+ * @endcode
+ */
+class FrameAssembler {
+   public:
+    static constexpr std::size_t MIN_READ_SIZE = 4096;  ///< Smallest free region offered to a read before compacting.
+
+    /**
+     * @brief Construct a new Frame Assembler.
+     *
+     * @param capacity Size of the reassembly buffer; raised to hold at least one maximum-sized message plus MIN_READ_SIZE.
+     */
+    explicit FrameAssembler(std::size_t capacity = 2 * Protocol::MAX_MESSAGE_SIZE)
+        : buffer_(std::max(capacity, Protocol::MAX_MESSAGE_SIZE + MIN_READ_SIZE)) {}
+
+    /**
+     * @brief Gets the free region of the buffer the next read should fill.
+     *
+     * Moves the pending partial message to the front of the buffer only if a maximum-sized
+     * message starting at it would not fit, or if fewer than MIN_READ_SIZE bytes are free.
+     *
+     * @return std::span<std::uint8_t> The writable region, never empty.
+     */
+    std::span<std::uint8_t> prepare() {
+        if (buffer_.size() - begin_ < Protocol::MAX_MESSAGE_SIZE || buffer_.size() - end_ < MIN_READ_SIZE)
+            compact();
+        return std::span<std::uint8_t>(buffer_).subspan(end_);
+    }
+
+    /**
+     * @brief Marks bytes written into the region returned by prepare() as received.
+     *
+     * @param length Number of bytes received.
+     */
+    void commit(std::size_t length) { end_ += length; }
+
+    /**
+     * @brief Dispatches every complete message currently buffered.
+     *
+     * The Message passed to the handler points into the assembler's buffer and is only
+     * valid during the call.
+     *
+     * @tparam Handler Callable taking a const Message&.
+     * @param handler The function called for each complete message, in stream order.
+     * @return true if the stream is well-formed, false if a message this build cannot decode was found.
+     */
+    template <typename Handler>
+    bool consume(Handler&& handler) {
+        while (end_ - begin_ >= Protocol::HEADER_SIZE) {
+            std::span<const std::uint8_t> pending(buffer_.data() + begin_, end_ - begin_);
+            Message message;
+            if (!Message::deserialize(pending, message)) {
+                if (!Protocol::isDecodable(message.header.version, message.header.type))
+                    return false;
+                break;  // Header is valid but the payload has not fully arrived yet
+            }
+            begin_ += message.size();
+            handler(message);
+        }
+        if (begin_ == end_) {
+            begin_ = 0;
+            end_ = 0;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of buffered bytes that do not form a complete message yet.
+     *
+     * @return std::size_t The pending byte count.
+     */
+    std::size_t pending() const { return end_ - begin_; }
+
+    /**
+     * @brief Gets the total number of bytes moved to the front of the buffer.
+     *
+     * Stays far below the received byte count, since messages are decoded in place.
+     *
+     * @return std::size_t The compacted byte count.
+     */
+    std::size_t compactedBytes() const { return compactedBytes_; }
+
+    /**
+     * @brief Discards all buffered bytes.
+     */
+    void reset() {
+        begin_ = 0;
+        end_ = 0;
+    }
+
+   private:
+    /**
+     * @brief Moves the unconsumed bytes to the front of the buffer.
+     */
+    void compact() {
+        if (begin_ == 0)
+            return;
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        compactedBytes_ += end_ - begin_;
+        end_ -= begin_;
+        begin_ = 0;
+    }
+
+    std::vector<std::uint8_t> buffer_;  ///< Reassembly buffer, allocated once per session.
+    std::size_t begin_ = 0;             ///< Offset of the first unconsumed byte.
+    std::size_t end_ = 0;               ///< Offset one past the last received byte.
+    std::size_t compactedBytes_ = 0;    ///< Bytes moved by compact() so far.
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Datagram.hpp"
+#include "Message.hpp"
+#include "RingQueue.hpp"
+
+/**
+ * @class InputQueue
+ * @brief Picks the input a player's ship applies each tick, from the inputs its client sent.
+ *
+ * Clients send one input per tick, but jitter makes some arrive a tick late. When none
+ * arrived in time, the keys of the previous input are held once more, standing in for the
+ * next sequence number: the repeat is acknowledged under that number, and the late input
+ * is dropped when it arrives, so the ship never moves more often than the client sampled
+ * and a predicting client sees every step the server took. Only MAX_REPEATS inputs in a
+ * row are stood in for; past that the client is likely stalled rather than late, and the
+ * ship stands still until it sends again.
+ *
+ * Inputs that pile up beyond MAX_BACKLOG are skipped, oldest first, so a burst after a
+ * stall costs at most MAX_BACKLOG ticks of input latency.
+ *
+ * push() and next() may run on different threads: the session pushes decoded inputs on an
+ * SPSC ring the match pops once per tick.
+ */
+class InputQueue {
+   public:
+    static constexpr std::size_t CAPACITY = 16;    ///< Inputs the session can queue ahead of the match.
+    static constexpr std::size_t MAX_BACKLOG = 2;  ///< Inputs kept waiting before the oldest are skipped.
+    static constexpr unsigned MAX_REPEATS = 2;     ///< Consecutive missing inputs stood in for by a repeat.
+
+    /**
+     * @brief Queues an input received from the client; called by the session.
+     *
+     * @param input The decoded input.
+     * @return true if it was queued, false if the match stalled and the queue is full.
+     */
+    bool push(const Protocol::InputPayload& input) { return received_.tryPush(input); }
+
+    /**
+     * @brief Gets the input to apply for the current tick; called by the match.
+     *
+     * @param input Filled with the oldest new input, a repeat of the previous one standing in
+     *              for the next, or an input holding no key once MAX_REPEATS ran out.
+     * @return true if an input was retrieved, false if the client never sent one.
+     */
+    bool next(Protocol::InputPayload& input) {
+        Protocol::InputPayload received;
+        bool fresh = false;
+        while (received_.tryPop(received)) {
+            if (hasInput_ && !Datagram::isNewer(received.sequence, last_.sequence))
+                continue;  // Already applied, or stood in for by a repeat
+            last_ = received;
+            hasInput_ = true;
+            fresh = true;
+            if (received_.size() <= MAX_BACKLOG)
+                break;
+        }
+        if (!hasInput_)
+            return false;
+        if (fresh) {
+            repeats_ = 0;
+        } else if (repeats_ < MAX_REPEATS) {
+            ++repeats_;
+            ++last_.sequence;
+        } else {
+            input = Protocol::InputPayload();
+            input.sequence = last_.sequence;
+            return true;
+        }
+        input = last_;
+        return true;
+    }
+
+   private:
+    SpscRing<Protocol::InputPayload, CAPACITY> received_;  ///< Decoded inputs, pushed by the session, popped by the match.
+    Protocol::InputPayload last_;                          ///< Input applied on the latest tick that moved the ship.
+    bool hasInput_ = false;                                ///< Whether last_ holds a received input.
+    unsigned repeats_ = 0;                                 ///< Repeats applied since the latest received input.
+};
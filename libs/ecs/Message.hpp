@@ -1,8 +1,12 @@
 #pragma once
 
-#include <sstream>
-#include <string>
-#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "BitStream.hpp"
+#include "ByteStream.hpp"
+#include "Quantization.hpp"
 
 /**
  * @enum RFC
@@ -12,50 +16,809 @@
  * for communication between the client and server in the game, such as state updates,
  * input handling, and game control messages.
  */
-enum class RFC {
-    STATE_UPDATE = 200,  ///< Message for state updates.
-    INPUT = 210,         ///< Message for input events.
-    NEW_ENTITY = 220,    ///< Message indicating a new entity has been created.
-    ENTITY_DEAD = 230,   ///< Message indicating an entity has been destroyed.
-    GAME_OVER = 400      ///< Message indicating the game is over.
+enum class RFC : std::uint16_t {
+    HELLO = 100,            ///< Message opening a session with the client's versions and capabilities.
+    WELCOME = 105,          ///< Message answering HELLO with the negotiated version and capabilities.
+    RESUME = 110,           ///< Message reopening a session after a lost connection, instead of HELLO.
+    SESSION = 115,          ///< Message giving a client the token to resume its session with.
+    STATE_UPDATE = 200,     ///< Message for state updates.
+    STATE_DELTA = 205,      ///< Message for state updates relative to an acknowledged snapshot.
+    WORLD_STATE = 207,      ///< Message describing every entity a resumed client or a new spectator sees, with its type and position.
+    INPUT = 210,            ///< Message for input events.
+    NEW_ENTITY = 220,       ///< Message indicating a new entity has been created.
+    PLAYER_ASSIGNED = 225,  ///< Message telling a client which entity it controls.
+    ENTITY_DEAD = 230,      ///< Message indicating an entity has been destroyed.
+    ENTITY_DESPAWN = 235,   ///< Message indicating an entity left the client's area of interest.
+    UDP_BIND = 240,         ///< Message binding a client's UDP endpoint to its TCP session.
+    RELIABLE = 245,         ///< Message carrying reliable-ordered messages and acknowledgements over UDP.
+    SNAPSHOT_ACK = 250,     ///< Message acknowledging the newest snapshot a client applied.
+    GAME_OVER = 400         ///< Message indicating the game is over.
 };
 
+/**
+ * @enum EntityType
+ * @brief Kinds of entities the server can announce to clients.
+ */
+enum class EntityType : std::uint8_t {
+    PLAYER = 0,  ///< A player-controlled ship.
+    ENEMY = 1    ///< An enemy ship.
+};
+
+/**
+ * @enum InputAction
+ * @brief Movement keys a client can hold; each is one bit of an InputPayload.
+ */
+enum class InputAction : std::uint8_t {
+    UP = 0,    ///< Move up.
+    DOWN = 1,  ///< Move down.
+    LEFT = 2,  ///< Move left.
+    RIGHT = 3  ///< Move right.
+};
+
+/**
+ * @enum Capability
+ * @brief Optional protocol features a session can negotiate; each is one bit of a capability mask.
+ */
+enum class Capability : std::uint8_t {
+    UDP_SNAPSHOTS = 0,    ///< Snapshots streamed over the UDP snapshot channel instead of TCP.
+    DELTA_SNAPSHOTS = 1,  ///< Snapshots delta-encoded against an acknowledged one; requires UDP_SNAPSHOTS.
+    RELIABLE_EVENTS = 2,  ///< Events sent over the reliable UDP channel instead of TCP; requires UDP_SNAPSHOTS.
+    SPECTATOR = 3         ///< Read-only session watching a match; only requested explicitly, never by default.
+};
+
+/**
+ * @namespace Protocol
+ * @brief Binary wire format shared by the client and the server.
+ *
+ * Every message starts with a fixed 6-byte header (version, flags, type, payload size)
+ * followed by a typed payload. All multi-byte fields are little-endian. Encoding and
+ * decoding work on caller-provided buffers and never allocate.
+ */
+namespace Protocol {
+
+const std::uint8_t VERSION = 7;                                       ///< Current wire protocol version.
+const std::uint8_t MIN_VERSION = 7;                                   ///< Oldest version this build can still speak; VERSION while no older layout is kept.
+const std::size_t HEADER_SIZE = 6;                                    ///< Size of the encoded message header in bytes.
+const std::size_t PAYLOAD_SIZE_OFFSET = 4;                            ///< Offset of the payload size field in the header.
+const std::size_t MAX_PAYLOAD_SIZE = 0xFFFF;                          ///< Largest payload a header can describe.
+const std::size_t MAX_MESSAGE_SIZE = HEADER_SIZE + MAX_PAYLOAD_SIZE;  ///< Largest encoded message.
+const unsigned TICK_INTERVAL_MS = 30;                                 ///< Server simulation tick, also the client input sampling interval.
+
+/**
+ * @brief Gets the name of an entity type as used by the graphic system.
+ *
+ * @param type The entity type.
+ * @return const char* The entity type name (e.g., "Player", "Enemy").
+ */
+inline const char* entityTypeName(EntityType type) {
+    switch (type) {
+        case EntityType::PLAYER:
+            return "Player";
+        case EntityType::ENEMY:
+            return "Enemy";
+    }
+    return "Unknown";
+}
+
+/**
+ * @brief Gets the bit of a capability in a capability mask.
+ *
+ * @param capability The capability.
+ * @return std::uint32_t The corresponding bit.
+ */
+constexpr std::uint32_t capabilityBit(Capability capability) {
+    return 1u << static_cast<std::uint8_t>(capability);
+}
+
+/// Every optional feature this build supports; SPECTATOR, which changes the session's role, is not one of them.
+const std::uint32_t ALL_CAPABILITIES =
+    capabilityBit(Capability::UDP_SNAPSHOTS) | capabilityBit(Capability::DELTA_SNAPSHOTS) | capabilityBit(Capability::RELIABLE_EVENTS);
+
+/**
+ * @brief Gets the name of a capability, as used in logs and on command lines.
+ *
+ * @param capability The capability.
+ * @return const char* The capability name (e.g., "udp", "delta").
+ */
+inline const char* capabilityName(Capability capability) {
+    switch (capability) {
+        case Capability::UDP_SNAPSHOTS:
+            return "udp";
+        case Capability::DELTA_SNAPSHOTS:
+            return "delta";
+        case Capability::RELIABLE_EVENTS:
+            return "reliable";
+        case Capability::SPECTATOR:
+            return "spectator";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Drops the capabilities whose requirements are missing from a mask.
+ *
+ * A spectator receives the broadcast shared by every spectator of its match, made of full
+ * snapshots and TCP events, so it keeps UDP_SNAPSHOTS alone.
+ *
+ * @param capabilities The capability mask.
+ * @return std::uint32_t The mask without DELTA_SNAPSHOTS and RELIABLE_EVENTS unless UDP_SNAPSHOTS is set, or for a spectator.
+ */
+constexpr std::uint32_t normalizeCapabilities(std::uint32_t capabilities) {
+    std::uint32_t spectator = capabilities & capabilityBit(Capability::SPECTATOR);
+    if (spectator)
+        capabilities &= capabilityBit(Capability::UDP_SNAPSHOTS);
+    if (!(capabilities & capabilityBit(Capability::UDP_SNAPSHOTS)))
+        return spectator;
+    return (capabilities & ALL_CAPABILITIES) | spectator;
+}
+
+/**
+ * @brief Picks the newest protocol version a peer and this build both speak.
+ *
+ * This build keeps no older message layout, so MIN_VERSION equals VERSION and the result
+ * is either VERSION or 0. Once a version is kept for compatibility by lowering MIN_VERSION,
+ * the features it lacks must be gated on the version negotiated here.
+ *
+ * @param minVersion Oldest version the peer speaks.
+ * @param maxVersion Newest version the peer speaks.
+ * @return std::uint8_t The negotiated version, or 0 if the ranges do not overlap.
+ */
+inline std::uint8_t negotiateVersion(std::uint8_t minVersion, std::uint8_t maxVersion) {
+    std::uint8_t version = std::min(maxVersion, VERSION);
+    return version >= std::max(minVersion, MIN_VERSION) ? version : 0;
+}
+
+/**
+ * @brief Checks whether a message can be decoded by this build.
+ *
+ * The header and the HELLO and WELCOME payloads keep their layout in every version, so
+ * peers of any two versions can always negotiate; every other message must use VERSION.
+ *
+ * @param version The protocol version of the message header.
+ * @param type The type of the message.
+ * @return true if the message can be decoded, false otherwise.
+ */
+inline bool isDecodable(std::uint8_t version, RFC type) {
+    return version == VERSION || type == RFC::HELLO || type == RFC::WELCOME;
+}
+
+/**
+ * @struct MessageHeader
+ * @brief Fixed-layout header preceding every message on the wire.
+ */
+struct MessageHeader {
+    std::uint8_t version = VERSION;  ///< Protocol version the message was encoded with.
+    std::uint8_t flags = 0;          ///< Reserved for future use, always 0.
+    RFC type = RFC::STATE_UPDATE;    ///< The type of the payload.
+    std::uint16_t payloadSize = 0;   ///< Size of the payload following the header, in bytes.
+
+    /**
+     * @brief Encodes the header.
+     *
+     * @param writer The writer to encode into.
+     */
+    void encode(ByteWriter& writer) const {
+        writer.writeU8(version);
+        writer.writeU8(flags);
+        writer.writeU16(static_cast<std::uint16_t>(type));
+        writer.writeU16(payloadSize);
+    }
+
+    /**
+     * @brief Decodes a header.
+     *
+     * @param reader The reader to decode from.
+     * @param header The header to fill.
+     * @return true if a complete header was read, false otherwise.
+     */
+    static bool decode(ByteReader& reader, MessageHeader& header) {
+        header.version = reader.readU8();
+        header.flags = reader.readU8();
+        header.type = static_cast<RFC>(reader.readU16());
+        header.payloadSize = reader.readU16();
+        return reader.ok();
+    }
+};
+
+/**
+ * @struct EntityState
+ * @brief Position of a single entity inside a snapshot.
+ *
+ * On the wire, states are bit-packed by StateUpdateWriter and StateDelta: the entity ID
+ * as a variable-length difference from the previous state's ID, and the coordinates
+ * quantized with a PositionQuantization.
+ */
+struct EntityState {
+    std::int32_t entityId = 0;  ///< Identifier of the entity.
+    float x = 0.0f;             ///< X coordinate of the entity.
+    float y = 0.0f;             ///< Y coordinate of the entity.
+
+    bool operator==(const EntityState&) const = default;
+};
+
+/**
+ * @struct InputAck
+ * @brief Newest input the server applied to a player, as of a snapshot.
+ *
+ * Snapshots carry one per player, so a predicting client knows which of its pending
+ * inputs the snapshot already includes.
+ */
+struct InputAck {
+    std::int32_t entityId = 0;   ///< Identifier of the player entity.
+    std::uint32_t sequence = 0;  ///< Sequence number of the newest applied input.
+};
+
+/**
+ * @struct HelloPayload
+ * @brief Payload of a HELLO message.
+ *
+ * The first message of every session, sent by the client over TCP. The server answers
+ * with WELCOME and ignores the session until then.
+ */
+struct HelloPayload {
+    static constexpr RFC TYPE = RFC::HELLO;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 8;   ///< Encoded size in bytes.
+
+    std::uint8_t minVersion = MIN_VERSION;          ///< Oldest protocol version the client speaks.
+    std::uint8_t maxVersion = VERSION;              ///< Newest protocol version the client speaks.
+    std::uint32_t capabilities = ALL_CAPABILITIES;  ///< Capabilities the client supports.
+    std::uint16_t snapshotBudgetBytes = 0;          ///< Largest snapshot the client wants per tick, 0 for the server's default.
+
+    void encode(ByteWriter& writer) const {
+        writer.writeU8(minVersion);
+        writer.writeU8(maxVersion);
+        writer.writeU32(capabilities);
+        writer.writeU16(snapshotBudgetBytes);
+    }
+
+    static void decode(ByteReader& reader, HelloPayload& payload) {
+        payload.minVersion = reader.readU8();
+        payload.maxVersion = reader.readU8();
+        payload.capabilities = reader.readU32();
+        payload.snapshotBudgetBytes = reader.readU16();
+    }
+};
+
+/**
+ * @struct WelcomePayload
+ * @brief Payload of a WELCOME message.
+ *
+ * The settings both sides use for the rest of the session. A version of 0 means the
+ * client speaks no version the server does; the server closes the session after it.
+ */
+struct WelcomePayload {
+    static constexpr RFC TYPE = RFC::WELCOME;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 9;     ///< Encoded size in bytes.
+
+    std::uint8_t version = 0;               ///< Protocol version of the session, or 0 if none is common.
+    std::uint32_t capabilities = 0;         ///< Capabilities enabled for the session.
+    std::uint16_t tickIntervalMs = 0;       ///< The server's tick, at which the client should send inputs.
+    std::uint16_t snapshotBudgetBytes = 0;  ///< Largest snapshot the server sends the client per tick.
+
+    /**
+     * @brief Checks whether a capability is enabled for the session.
+     *
+     * @param capability The capability.
+     * @return true if it is enabled, false otherwise.
+     */
+    bool has(Capability capability) const { return (capabilities & capabilityBit(capability)) != 0; }
+
+    void encode(ByteWriter& writer) const {
+        writer.writeU8(version);
+        writer.writeU32(capabilities);
+        writer.writeU16(tickIntervalMs);
+        writer.writeU16(snapshotBudgetBytes);
+    }
+
+    static void decode(ByteReader& reader, WelcomePayload& payload) {
+        payload.version = reader.readU8();
+        payload.capabilities = reader.readU32();
+        payload.tickIntervalMs = reader.readU16();
+        payload.snapshotBudgetBytes = reader.readU16();
+    }
+};
+
+/**
+ * @struct SessionPayload
+ * @brief Payload of a SESSION message.
+ *
+ * Sent by the match when a client joins it, and again when it resumes. A client whose
+ * connection drops can reconnect and send RESUME with the token instead of HELLO, within
+ * the resume window. A token of 0 answers a RESUME the server could not honor.
+ */
+struct SessionPayload {
+    static constexpr RFC TYPE = RFC::SESSION;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 10;    ///< Encoded size in bytes.
+
+    std::uint64_t token = 0;           ///< Secret identifying the session, or 0 if it cannot be resumed.
+    std::uint16_t resumeWindowMs = 0;  ///< How long the server keeps the player after its connection drops.
+
+    void encode(ByteWriter& writer) const {
+        writer.writeU64(token);
+        writer.writeU16(resumeWindowMs);
+    }
+
+    static void decode(ByteReader& reader, SessionPayload& payload) {
+        payload.token = reader.readU64();
+        payload.resumeWindowMs = reader.readU16();
+    }
+};
+
+/**
+ * @struct ResumePayload
+ * @brief Payload of a RESUME message.
+ *
+ * The first message of a reconnecting client, sent over TCP instead of HELLO. The session
+ * keeps the settings negotiated by its first HELLO, which the server sends again in WELCOME.
+ */
+struct ResumePayload {
+    static constexpr RFC TYPE = RFC::RESUME;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 8;    ///< Encoded size in bytes.
+
+    std::uint64_t token = 0;  ///< Token received in SESSION.
+
+    void encode(ByteWriter& writer) const { writer.writeU64(token); }
+
+    static void decode(ByteReader& reader, ResumePayload& payload) { payload.token = reader.readU64(); }
+};
+
+/**
+ * @struct InputPayload
+ * @brief Payload of an INPUT message.
+ *
+ * Clients sample the keys held every TICK_INTERVAL_MS and send the result as a bitmask
+ * with an increasing sequence number, whether or not it changed. The server applies one
+ * input per player per tick.
+ */
+struct InputPayload {
+    static constexpr RFC TYPE = RFC::INPUT;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 5;   ///< Encoded size in bytes.
+
+    std::uint32_t sequence = 0;  ///< Sequence number of the sample.
+    std::uint8_t buttons = 0;    ///< Held movement keys, one bit per InputAction.
+
+    /**
+     * @brief Gets the bit of a movement key in the buttons mask.
+     *
+     * @param action The movement key.
+     * @return std::uint8_t The corresponding bit.
+     */
+    static constexpr std::uint8_t bit(InputAction action) { return static_cast<std::uint8_t>(1u << static_cast<std::uint8_t>(action)); }
+
+    /**
+     * @brief Marks a movement key as held.
+     *
+     * @param action The movement key.
+     */
+    void press(InputAction action) { buttons |= bit(action); }
+
+    /**
+     * @brief Checks whether a movement key is held.
+     *
+     * @param action The movement key.
+     * @return true if the key is held, false otherwise.
+     */
+    bool isHeld(InputAction action) const { return (buttons & bit(action)) != 0; }
+
+    void encode(ByteWriter& writer) const {
+        writer.writeU32(sequence);
+        writer.writeU8(buttons);
+    }
+
+    static void decode(ByteReader& reader, InputPayload& payload) {
+        payload.sequence = reader.readU32();
+        payload.buttons = reader.readU8();
+    }
+};
+
+/**
+ * @struct NewEntityPayload
+ * @brief Payload of a NEW_ENTITY message.
+ */
+struct NewEntityPayload {
+    static constexpr RFC TYPE = RFC::NEW_ENTITY;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 5;        ///< Encoded size in bytes.
+
+    std::int32_t entityId = 0;                  ///< Identifier of the new entity.
+    EntityType entityType = EntityType::ENEMY;  ///< Kind of the new entity.
+
+    void encode(ByteWriter& writer) const {
+        writer.writeI32(entityId);
+        writer.writeU8(static_cast<std::uint8_t>(entityType));
+    }
+
+    static void decode(ByteReader& reader, NewEntityPayload& payload) {
+        payload.entityId = reader.readI32();
+        payload.entityType = static_cast<EntityType>(reader.readU8());
+    }
+};
+
+/**
+ * @struct PlayerAssignedPayload
+ * @brief Payload of a PLAYER_ASSIGNED message.
+ */
+struct PlayerAssignedPayload {
+    static constexpr RFC TYPE = RFC::PLAYER_ASSIGNED;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 4;             ///< Encoded size in bytes.
+
+    std::int32_t entityId = 0;  ///< Identifier of the entity the client controls.
+
+    void encode(ByteWriter& writer) const { writer.writeI32(entityId); }
+
+    static void decode(ByteReader& reader, PlayerAssignedPayload& payload) { payload.entityId = reader.readI32(); }
+};
+
+/**
+ * @struct EntityDeadPayload
+ * @brief Payload of an ENTITY_DEAD message.
+ */
+struct EntityDeadPayload {
+    static constexpr RFC TYPE = RFC::ENTITY_DEAD;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 4;         ///< Encoded size in bytes.
+
+    std::int32_t entityId = 0;  ///< Identifier of the destroyed entity.
+
+    void encode(ByteWriter& writer) const { writer.writeI32(entityId); }
+
+    static void decode(ByteReader& reader, EntityDeadPayload& payload) { payload.entityId = reader.readI32(); }
+};
+
+/**
+ * @struct EntityDespawnPayload
+ * @brief Payload of an ENTITY_DESPAWN message.
+ *
+ * The entity still exists but is out of the client's view; a NEW_ENTITY message spawns
+ * it again if it comes back.
+ */
+struct EntityDespawnPayload {
+    static constexpr RFC TYPE = RFC::ENTITY_DESPAWN;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 4;            ///< Encoded size in bytes.
+
+    std::int32_t entityId = 0;  ///< Identifier of the entity that left the view.
+
+    void encode(ByteWriter& writer) const { writer.writeI32(entityId); }
+
+    static void decode(ByteReader& reader, EntityDespawnPayload& payload) { payload.entityId = reader.readI32(); }
+};
+
+/**
+ * @struct GameOverPayload
+ * @brief Payload of a GAME_OVER message.
+ */
+struct GameOverPayload {
+    static constexpr RFC TYPE = RFC::GAME_OVER;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 4;       ///< Encoded size in bytes.
+
+    std::int32_t playerId = 0;  ///< Identifier of the player whose game ended.
+
+    void encode(ByteWriter& writer) const { writer.writeI32(playerId); }
+
+    static void decode(ByteReader& reader, GameOverPayload& payload) { payload.playerId = reader.readI32(); }
+};
+
+/**
+ * @struct UdpBindPayload
+ * @brief Payload of a UDP_BIND message.
+ *
+ * The server sends a random token over TCP; the client echoes it in a datagram so
+ * the server learns which UDP endpoint belongs to which session.
+ */
+struct UdpBindPayload {
+    static constexpr RFC TYPE = RFC::UDP_BIND;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 4;      ///< Encoded size in bytes.
+
+    std::uint32_t token = 0;  ///< Token identifying the session.
+
+    void encode(ByteWriter& writer) const { writer.writeU32(token); }
+
+    static void decode(ByteReader& reader, UdpBindPayload& payload) { payload.token = reader.readU32(); }
+};
+
+/**
+ * @struct SnapshotAckPayload
+ * @brief Payload of a SNAPSHOT_ACK message.
+ *
+ * Sent by the client over UDP after applying a snapshot, so the server can encode the
+ * following ones as deltas against it.
+ */
+struct SnapshotAckPayload {
+    static constexpr RFC TYPE = RFC::SNAPSHOT_ACK;  ///< Message type carrying this payload.
+    static constexpr std::size_t SIZE = 4;          ///< Encoded size in bytes.
+
+    std::uint32_t sequence = 0;  ///< Sequence number of the acknowledged snapshot.
+
+    void encode(ByteWriter& writer) const { writer.writeU32(sequence); }
+
+    static void decode(ByteReader& reader, SnapshotAckPayload& payload) { payload.sequence = reader.readU32(); }
+};
+
+}  // namespace Protocol
+
 /**
  * @struct Message
- * @brief Represents a network message with a type and content.
+ * @brief A decoded message: its header and a view over its payload bytes.
  *
- * This structure is used to serialize and deserialize messages that are sent
- * and received over the network. It contains the message type and content.
+ * A Message does not own its payload; it stays valid only as long as the buffer it
+ * was deserialized from. Typed payloads are obtained with decode().
  */
 struct Message {
-    RFC type;             ///< The type of the message, defined by the RFC enum.
-    std::string content;  ///< The content of the message in string form.
+    Protocol::MessageHeader header;         ///< The decoded message header.
+    std::span<const std::uint8_t> payload;  ///< View over the payload bytes.
+
+    /**
+     * @brief Gets the message type.
+     *
+     * @return RFC The type of the message.
+     */
+    RFC type() const { return header.type; }
+
+    /**
+     * @brief Gets the encoded size of the message, header included.
+     *
+     * @return std::size_t The size in bytes.
+     */
+    std::size_t size() const { return Protocol::HEADER_SIZE + payload.size(); }
+
+    /**
+     * @brief Serializes a fixed-size payload, header included, into a buffer.
+     *
+     * @tparam Payload One of the fixed-size payload structs of the Protocol namespace.
+     * @param payload The payload to serialize.
+     * @param out The destination buffer.
+     * @return std::size_t The number of bytes written, or 0 if the buffer is too small.
+     */
+    template <typename Payload>
+    static std::size_t serialize(const Payload& payload, std::span<std::uint8_t> out) {
+        ByteWriter writer(out);
+        Protocol::MessageHeader header;
+        header.type = Payload::TYPE;
+        header.payloadSize = static_cast<std::uint16_t>(Payload::SIZE);
+        header.encode(writer);
+        payload.encode(writer);
+        return writer.ok() ? writer.size() : 0;
+    }
 
     /**
-     * @brief Serializes the message into a string format for sending over the network.
+     * @brief Deserializes the message at the start of a buffer.
      *
-     * @return A string representing the serialized message.
+     * @param data The buffer holding at least one complete message.
+     * @param message The message to fill; its payload will point into data.
+     * @return true if a complete message this build can decode was found, false otherwise (see Protocol::isDecodable).
      */
-    std::string serialize() const {
-        std::ostringstream oss;
-        oss << static_cast<int>(type) << " " << content;
-        return oss.str();
+    static bool deserialize(std::span<const std::uint8_t> data, Message& message) {
+        ByteReader reader(data);
+        if (!Protocol::MessageHeader::decode(reader, message.header) || !Protocol::isDecodable(message.header.version, message.header.type))
+            return false;
+        if (reader.remaining() < message.header.payloadSize)
+            return false;
+        message.payload = data.subspan(Protocol::HEADER_SIZE, message.header.payloadSize);
+        return true;
     }
 
     /**
-     * @brief Deserializes a string to create a Message object.
+     * @brief Decodes the payload as a fixed-size typed payload.
      *
-     * @param data The string containing the serialized message data.
-     * @return A Message object representing the deserialized data.
+     * @tparam Payload One of the fixed-size payload structs of the Protocol namespace.
+     * @param out The payload to fill.
+     * @return true if the message type and size match the payload type, false otherwise.
      */
-    static Message deserialize(const std::string& data) {
-        std::istringstream iss(data);
-        Message message;
-        int messageType;
-        iss >> messageType;
-        message.type = static_cast<RFC>(messageType);
-        iss.ignore();
-        std::getline(iss, message.content);
-        return message;
+    template <typename Payload>
+    bool decode(Payload& out) const {
+        if (header.type != Payload::TYPE || payload.size() != Payload::SIZE)
+            return false;
+        ByteReader reader(payload);
+        Payload::decode(reader, out);
+        return reader.ok();
     }
 };
+
+namespace Protocol {
+
+/**
+ * @brief Writes the input acknowledgement table that ends every snapshot payload.
+ *
+ * The table is a 16-bit count followed, for each player, by its ID as a variable-length
+ * difference from the previous ID and the 32-bit sequence of its newest applied input.
+ *
+ * @param bits The writer to encode into.
+ * @param acks The acknowledgements, at most 0xFFFF.
+ */
+inline void writeInputAcks(BitWriter& bits, std::span<const InputAck> acks) {
+    bits.writeBits(static_cast<std::uint32_t>(acks.size()), 16);
+    std::int32_t previousId = 0;
+    for (const InputAck& ack : acks) {
+        bits.writeVarUInt(static_cast<std::uint32_t>(ack.entityId) - static_cast<std::uint32_t>(previousId));
+        bits.writeBits(ack.sequence, 32);
+        previousId = ack.entityId;
+    }
+}
+
+/**
+ * @brief Reads an input acknowledgement table written by writeInputAcks().
+ *
+ * @tparam Function Callable taking a const InputAck&.
+ * @param reader The reader positioned on the table.
+ * @param function The function to call for every acknowledgement.
+ * @return true if the table is well-formed, false otherwise.
+ */
+template <typename Function>
+bool readInputAcks(BitReader& reader, Function&& function) {
+    std::uint32_t count = reader.readBits(16);
+    InputAck ack;
+    for (std::uint32_t i = 0; i < count && reader.ok(); ++i) {
+        ack.entityId = static_cast<std::int32_t>(static_cast<std::uint32_t>(ack.entityId) + reader.readVarUInt());
+        ack.sequence = reader.readBits(32);
+        if (reader.ok())
+            function(ack);
+    }
+    return reader.ok();
+}
+
+/**
+ * @class StateUpdateWriter
+ * @brief Encodes a STATE_UPDATE message entity by entity into a caller-provided buffer.
+ *
+ * The payload is bit-packed: a 16-bit entity count, then for each entity its ID as a
+ * variable-length difference from the previous ID and its quantized coordinates, then
+ * the input acknowledgement table. States should be added in ascending ID order so the
+ * differences stay small. The header, count and table are written by finish() once all
+ * entities have been added.
+ */
+class StateUpdateWriter {
+   public:
+    /**
+     * @brief Construct a new State Update Writer and reserve room for the header and count.
+     *
+     * @param buffer The destination buffer.
+     * @param quantization The position quantization to encode with.
+     */
+    explicit StateUpdateWriter(std::span<std::uint8_t> buffer, const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION)
+        : buffer_(buffer),
+          bits_(buffer.size() >= HEADER_SIZE ? buffer.subspan(HEADER_SIZE) : std::span<std::uint8_t>()),
+          quantization_(quantization) {
+        bits_.writeBits(0, 16);
+    }
+
+    /**
+     * @brief Appends an entity state to the message.
+     *
+     * @param state The entity state to append.
+     * @return true if the state fitted in the buffer, false otherwise (the message is left unchanged).
+     */
+    bool add(const EntityState& state) {
+        if (count_ == 0xFFFF)
+            return false;
+        BitWriter checkpoint = bits_;
+        bits_.writeVarUInt(static_cast<std::uint32_t>(state.entityId) - static_cast<std::uint32_t>(previousId_));
+        bits_.writeBits(quantization_.x.encode(state.x), quantization_.x.bits);
+        bits_.writeBits(quantization_.y.encode(state.y), quantization_.y.bits);
+        if (!bits_.ok() || bits_.size() > MAX_PAYLOAD_SIZE) {
+            bits_ = checkpoint;
+            return false;
+        }
+        previousId_ = state.entityId;
+        ++count_;
+        return true;
+    }
+
+    /**
+     * @brief Completes the message by writing its header and entity count.
+     *
+     * @return std::size_t The total number of bytes of the message, or 0 if the buffer was too small.
+     */
+    std::size_t finish() {
+        writeInputAcks(bits_, inputAcks_);
+        if (!bits_.ok() || bits_.size() > MAX_PAYLOAD_SIZE)
+            return 0;
+        bits_.patchBits(0, count_, 16);
+        MessageHeader header;
+        header.type = RFC::STATE_UPDATE;
+        header.payloadSize = static_cast<std::uint16_t>(bits_.size());
+        ByteWriter writer(buffer_);
+        header.encode(writer);
+        return HEADER_SIZE + bits_.size();
+    }
+
+    /**
+     * @brief Sets the input acknowledgements written by finish().
+     *
+     * @param acks The acknowledgements; must stay valid until finish() is called.
+     */
+    void setInputAcks(std::span<const InputAck> acks) { inputAcks_ = acks.size() <= 0xFFFF ? acks : acks.first(0xFFFF); }
+
+   private:
+    std::span<std::uint8_t> buffer_;       ///< Destination buffer.
+    BitWriter bits_;                       ///< Writer over the payload part of the buffer.
+    PositionQuantization quantization_;    ///< Quantization of the coordinates.
+    std::int32_t previousId_ = 0;          ///< ID of the last state written.
+    std::uint16_t count_ = 0;              ///< Number of entity states written.
+    std::span<const InputAck> inputAcks_;  ///< Input acknowledgements to write.
+};
+
+/**
+ * @class StateUpdateView
+ * @brief Read-only view over the entity states of a received STATE_UPDATE message.
+ */
+class StateUpdateView {
+   public:
+    /**
+     * @brief Validates a STATE_UPDATE message and builds a view over its entity states.
+     *
+     * @param message The received message.
+     * @param view The view to fill.
+     * @param quantization The position quantization the message was encoded with.
+     * @return true if the message is a well-formed STATE_UPDATE, false otherwise.
+     */
+    static bool decode(const Message& message, StateUpdateView& view,
+                       const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION) {
+        if (message.type() != RFC::STATE_UPDATE)
+            return false;
+        view.payload_ = message.payload;
+        view.quantization_ = quantization;
+        BitReader reader(view.payload_);
+        view.count_ = static_cast<std::uint16_t>(reader.readBits(16));
+        EntityState state;
+        for (std::uint16_t i = 0; i < view.count_ && reader.ok(); ++i) {
+            view.readState(reader, state);
+        }
+        view.inputAcksOffset_ = reader.bitOffset();
+        return readInputAcks(reader, [](const InputAck&) {}) && reader.atEnd();
+    }
+
+    /**
+     * @brief Gets the number of entity states in the message.
+     *
+     * @return std::uint16_t The entity count.
+     */
+    std::uint16_t count() const { return count_; }
+
+    /**
+     * @brief Calls a function for every entity state of the message, in order.
+     *
+     * @tparam Function Callable taking a const EntityState&.
+     * @param function The function to call.
+     */
+    template <typename Function>
+    void forEach(Function&& function) const {
+        BitReader reader(payload_);
+        reader.readBits(16);
+        EntityState state;
+        for (std::uint16_t i = 0; i < count_; ++i) {
+            readState(reader, state);
+            function(state);
+        }
+    }
+
+    /**
+     * @brief Calls a function for every input acknowledgement of the message.
+     *
+     * @tparam Function Callable taking a const InputAck&.
+     * @param function The function to call.
+     */
+    template <typename Function>
+    void forEachInputAck(Function&& function) const {
+        BitReader reader(payload_);
+        reader.skipBits(inputAcksOffset_);
+        readInputAcks(reader, function);
+    }
+
+   private:
+    /**
+     * @brief Decodes the next entity state.
+     *
+     * @param reader The reader positioned on the state.
+     * @param state The previous state, overwritten with the decoded one.
+     */
+    void readState(BitReader& reader, EntityState& state) const {
+        state.entityId = static_cast<std::int32_t>(static_cast<std::uint32_t>(state.entityId) + reader.readVarUInt());
+        state.x = quantization_.x.decode(reader.readBits(quantization_.x.bits));
+        state.y = quantization_.y.decode(reader.readBits(quantization_.y.bits));
+    }
+
+    std::uint16_t count_ = 0;                ///< Number of entity states.
+    std::span<const std::uint8_t> payload_;  ///< Bit-packed payload.
+    PositionQuantization quantization_;      ///< Quantization of the coordinates.
+    std::size_t inputAcksOffset_ = 0;        ///< Bit offset of the input acknowledgement table.
+};
+
+}  // namespace Protocol
@@ -0,0 +1,579 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <asio.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct NetworkConditions
+ * @brief Impairments applied by the network simulator to each direction of a link.
+ */
+struct NetworkConditions {
+    double latencyMs = 0.0;       ///< One-way delay added to every packet.
+    double jitterMs = 0.0;        ///< Largest random deviation from the latency, either way.
+    double lossPercent = 0.0;     ///< Chance of losing a packet; a lost TCP segment is delayed by a retransmission instead.
+    double reorderPercent = 0.0;  ///< Chance of holding a datagram back behind the following ones.
+    double bandwidthKbps = 0.0;   ///< Capacity of each direction, in kilobits per second; 0 for unlimited.
+    std::uint64_t seed = 1;       ///< Seed of the random draws, so a run can be reproduced.
+
+    /**
+     * @brief Parses a comma-separated list of settings, such as "latency=80,jitter=20,loss=2,seed=7".
+     *
+     * Recognized keys are latency, jitter, loss, reorder, bandwidth and seed; omitted ones keep their default.
+     *
+     * @param spec The settings.
+     * @param out Filled with the parsed conditions.
+     * @return true if every setting is known and valid, false otherwise.
+     */
+    static bool parse(const std::string& spec, NetworkConditions& out) {
+        NetworkConditions conditions;
+        std::istringstream settings(spec);
+        std::string setting;
+        while (std::getline(settings, setting, ',')) {
+            std::size_t separator = setting.find('=');
+            if (separator == std::string::npos)
+                return false;
+            std::string key = setting.substr(0, separator);
+            double value = 0.0;
+            try {
+                value = std::stod(setting.substr(separator + 1));
+            } catch (const std::exception&) {
+                return false;
+            }
+            if (value < 0.0)
+                return false;
+            if (key == "latency")
+                conditions.latencyMs = value;
+            else if (key == "jitter")
+                conditions.jitterMs = value;
+            else if (key == "loss" && value <= 100.0)
+                conditions.lossPercent = value;
+            else if (key == "reorder" && value <= 100.0)
+                conditions.reorderPercent = value;
+            else if (key == "bandwidth")
+                conditions.bandwidthKbps = value;
+            else if (key == "seed")
+                conditions.seed = static_cast<std::uint64_t>(value);
+            else
+                return false;
+        }
+        out = conditions;
+        return true;
+    }
+};
+
+/**
+ * @class DelayLine
+ * @brief One direction of a simulated link: delays, drops and reorders the packets given to it.
+ *
+ * A packet first waits for the link to be free when the bandwidth is capped, then travels
+ * for the latency plus a random jitter. Datagrams are lost outright, may be held back past
+ * the following ones, and are dropped when the bandwidth queue is over a second long, as a
+ * router would. A reliable line (a TCP stream) never drops or reorders: a lost segment is
+ * delivered after a retransmission delay instead, holding back the bytes behind it.
+ *
+ * Not synchronized: every call and the deliveries run on the simulator's thread.
+ */
+class DelayLine {
+   public:
+    using Clock = std::chrono::steady_clock;                           ///< Clock packets are scheduled on.
+    using Deliver = std::function<void(std::vector<std::uint8_t>&&)>;  ///< Called with each packet once it arrives.
+
+    static constexpr double MIN_RETRANSMIT_MS = 200.0;  ///< Smallest delay of a lost TCP segment, as a retransmission timeout.
+    static constexpr double REORDER_HOLD_MS = 20.0;     ///< Smallest extra delay of a reordered datagram.
+    static constexpr double MAX_QUEUE_MS = 1000.0;      ///< Bandwidth queue length above which datagrams are dropped.
+
+    /**
+     * @struct Stats
+     * @brief Counters shared by every line of a simulator.
+     */
+    struct Stats {
+        std::atomic<std::uint64_t> delivered{0};  ///< Packets delivered.
+        std::atomic<std::uint64_t> dropped{0};    ///< Datagrams lost or dropped by the bandwidth queue.
+        std::atomic<std::uint64_t> delayed{0};    ///< TCP segments delayed by a simulated retransmission.
+        std::atomic<std::uint64_t> reordered{0};  ///< Datagrams held back behind the following ones.
+    };
+
+    /**
+     * @brief Constructs an empty line.
+     *
+     * @param io_context The IO context of the simulator thread.
+     * @param conditions The impairments to apply.
+     * @param seed The seed of this line's random draws.
+     * @param reliable true for a TCP stream, false for datagrams.
+     * @param stats The counters to update.
+     * @param deliver Called with each packet once it arrives.
+     */
+    DelayLine(asio::io_context& io_context, const NetworkConditions& conditions, std::uint64_t seed, bool reliable, Stats& stats, Deliver deliver)
+        : conditions_(conditions),
+          random_(seed),
+          reliable_(reliable),
+          stats_(stats),
+          deliver_(std::move(deliver)),
+          timer_(io_context),
+          alive_(std::make_shared<bool>(true)) {}
+
+    /**
+     * @brief Sends a packet down the line.
+     *
+     * @param bytes The packet.
+     */
+    void submit(std::vector<std::uint8_t>&& bytes) {
+        Clock::time_point now = Clock::now();
+        bool lost = chance(conditions_.lossPercent);
+        if (lost && !reliable_) {
+            ++stats_.dropped;
+            return;
+        }
+        Clock::time_point sent = now;
+        if (conditions_.bandwidthKbps > 0.0) {
+            Clock::duration serialization = milliseconds(static_cast<double>(bytes.size()) * 8.0 / conditions_.bandwidthKbps);
+            Clock::time_point start = std::max(linkFreeAt_, now);
+            if (!reliable_ && start - now > milliseconds(MAX_QUEUE_MS)) {
+                ++stats_.dropped;
+                return;
+            }
+            linkFreeAt_ = start + serialization;
+            sent = linkFreeAt_;
+        }
+        double delayMs = conditions_.latencyMs;
+        if (conditions_.jitterMs > 0.0)
+            delayMs += std::uniform_real_distribution<double>(-conditions_.jitterMs, conditions_.jitterMs)(random_);
+        if (lost) {
+            delayMs += std::max(MIN_RETRANSMIT_MS, 2.0 * conditions_.latencyMs);
+            ++stats_.delayed;
+        }
+        Clock::time_point due = sent + milliseconds(std::max(0.0, delayMs));
+        if (!reliable_ && chance(conditions_.reorderPercent)) {
+            due += milliseconds(std::max(REORDER_HOLD_MS, 2.0 * conditions_.jitterMs));
+            ++stats_.reordered;
+        } else {
+            due = std::max(due, lastDue_);  // Jitter alone never reorders, and a stream is delivered in order
+            lastDue_ = due;
+        }
+
+        auto key = std::make_pair(due, nextOrder_++);
+        bool earliest = pending_.empty() || key < pending_.begin()->first;
+        pending_.emplace(key, std::move(bytes));
+        if (earliest)
+            arm();
+    }
+
+    /**
+     * @brief Checks whether packets are still travelling.
+     *
+     * @return true if no packet is pending, false otherwise.
+     */
+    bool empty() const { return pending_.empty(); }
+
+   private:
+    using InFlight = std::map<std::pair<Clock::time_point, std::uint64_t>, std::vector<std::uint8_t>>;  ///< By arrival, then submission order.
+
+    /**
+     * @brief Converts a duration in milliseconds to the clock's duration.
+     *
+     * @param value The duration in milliseconds.
+     * @return Clock::duration The converted duration.
+     */
+    static Clock::duration milliseconds(double value) {
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(value));
+    }
+
+    /**
+     * @brief Draws an event with the given probability.
+     *
+     * @param percent The probability, in percent.
+     * @return true if the event happens.
+     */
+    bool chance(double percent) { return percent > 0.0 && std::uniform_real_distribution<double>(0.0, 100.0)(random_) < percent; }
+
+    /**
+     * @brief Waits for the earliest pending packet, replacing any previous wait.
+     *
+     * The handler holds a weak reference to the line, so a line destroyed while the wait
+     * completes is never accessed.
+     */
+    void arm() {
+        timer_.expires_at(pending_.begin()->first.first);
+        timer_.async_wait([this, alive = std::weak_ptr<bool>(alive_)](const asio::error_code& ec) {
+            if (ec || alive.expired())
+                return;
+            Clock::time_point now = Clock::now();
+            while (!pending_.empty() && pending_.begin()->first.first <= now) {
+                std::vector<std::uint8_t> bytes = std::move(pending_.begin()->second);
+                pending_.erase(pending_.begin());
+                ++stats_.delivered;
+                deliver_(std::move(bytes));
+            }
+            if (!pending_.empty())
+                arm();
+        });
+    }
+
+    NetworkConditions conditions_;  ///< Impairments to apply.
+    std::mt19937_64 random_;        ///< Source of the random draws.
+    bool reliable_;                 ///< Whether the line carries a TCP stream.
+    Stats& stats_;                  ///< Counters of the simulator.
+    Deliver deliver_;               ///< Called with each packet once it arrives.
+    asio::steady_timer timer_;      ///< Fires when the earliest pending packet arrives.
+    std::shared_ptr<bool> alive_;   ///< Expires with the line, for the timer handler to check.
+    Clock::time_point linkFreeAt_;  ///< When the bandwidth-capped link finishes sending the queued packets.
+    Clock::time_point lastDue_;     ///< Arrival time of the previous packet kept in order.
+    std::uint64_t nextOrder_ = 0;   ///< Tie-breaker keeping packets due at the same time in submission order.
+    InFlight pending_;              ///< Packets in flight, by arrival.
+};
+
+/**
+ * @class NetworkSimulator
+ * @brief Loopback proxy that impairs the traffic between a game client and a game server.
+ *
+ * The simulator listens on a local port, TCP and UDP, and forwards everything to the real
+ * endpoint through delay lines, one per direction of every connection, so latency, jitter,
+ * loss, reordering and bandwidth caps can be reproduced on a single machine. Both ports
+ * share the same number because clients derive the snapshot channel's endpoint from their
+ * TCP connection. Each UDP peer gets its own upstream socket, so the server still sees one
+ * endpoint per client; a peer that exchanged no datagram in either direction for
+ * UDP_SESSION_TIMEOUT has its socket closed, so clients coming and going on new ports do
+ * not pile up sockets for the simulator's lifetime.
+ *
+ * Lines are seeded from the conditions' seed in creation order, so the same seed and the
+ * same sequence of connections replay the same impairments. The simulator runs on its own
+ * thread and IO context and is stopped on destruction.
+ */
+class NetworkSimulator {
+   public:
+    static constexpr std::chrono::seconds UDP_SESSION_TIMEOUT{30};  ///< Idle time after which a UDP peer's session is closed.
+
+    /**
+     * @brief Opens the local port and starts forwarding.
+     *
+     * @param listen The local endpoint to listen on; port 0 picks a free one.
+     * @param targetHost The host of the real server.
+     * @param targetPort The port of the real server.
+     * @param conditions The impairments to apply.
+     */
+    NetworkSimulator(const asio::ip::tcp::endpoint& listen, const std::string& targetHost, const std::string& targetPort,
+                     const NetworkConditions& conditions)
+        : conditions_(conditions), acceptor_(io_context_, listen), udpSocket_(io_context_), sweepTimer_(io_context_) {
+        asio::ip::tcp::resolver resolver(io_context_);
+        tcpTarget_ = *resolver.resolve(targetHost, targetPort).begin();
+        udpTarget_ = asio::ip::udp::endpoint(tcpTarget_.address(), tcpTarget_.port());
+        asio::ip::tcp::endpoint bound = acceptor_.local_endpoint();
+        udpSocket_.open(bound.address().is_v4() ? asio::ip::udp::v4() : asio::ip::udp::v6());
+        udpSocket_.bind(asio::ip::udp::endpoint(bound.address(), bound.port()));
+        std::cout << "Network simulator on port " << bound.port() << " -> " << targetHost << ":" << targetPort << " (latency " << conditions.latencyMs
+                  << " ms, jitter " << conditions.jitterMs << " ms, loss " << conditions.lossPercent << "%, reorder " << conditions.reorderPercent
+                  << "%, bandwidth " << conditions.bandwidthKbps << " kbps, seed " << conditions.seed << ")" << std::endl;
+        acceptConnection();
+        receiveDatagram();
+        expireUdpSessions();
+        thread_ = std::thread([this]() { io_context_.run(); });
+    }
+
+    NetworkSimulator(const NetworkSimulator&) = delete;
+    NetworkSimulator& operator=(const NetworkSimulator&) = delete;
+
+    /**
+     * @brief Stops forwarding and joins the simulator thread.
+     */
+    ~NetworkSimulator() {
+        io_context_.stop();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    /**
+     * @brief Gets the local port the simulator listens on.
+     *
+     * @return unsigned short The TCP and UDP port.
+     */
+    unsigned short getPort() const { return acceptor_.local_endpoint().port(); }
+
+    /**
+     * @brief Gets the counters of every line.
+     *
+     * @return const DelayLine::Stats& The counters, updated by the simulator thread.
+     */
+    const DelayLine::Stats& getStats() const { return stats_; }
+
+   private:
+    /**
+     * @class TcpSession
+     * @brief A proxied TCP connection: one delay line per direction.
+     *
+     * When one side closes, the bytes still travelling towards the other side are
+     * delivered before its sending half is shut down. The session keeps itself alive until
+     * both directions are done.
+     */
+    class TcpSession : public std::enable_shared_from_this<TcpSession> {
+       public:
+        TcpSession(NetworkSimulator& simulator, asio::ip::tcp::socket downstream)
+            : downstream_(std::move(downstream)),
+              upstream_(simulator.io_context_),
+              toUpstream_(*this, simulator, downstream_, upstream_),
+              toDownstream_(*this, simulator, upstream_, downstream_) {}
+
+        /**
+         * @brief Connects to the server, then starts forwarding both ways.
+         *
+         * @param target The server's endpoint.
+         */
+        void start(const asio::ip::tcp::endpoint& target) {
+            self_ = shared_from_this();
+            upstream_.async_connect(target, [this, self = shared_from_this()](const asio::error_code& ec) {
+                if (ec) {
+                    std::cerr << "Network simulator failed to connect: " << ec.message() << std::endl;
+                    close();
+                    return;
+                }
+                read(toUpstream_);
+                read(toDownstream_);
+            });
+        }
+
+       private:
+        /**
+         * @struct Pipe
+         * @brief One direction of the connection.
+         */
+        struct Pipe {
+            Pipe(TcpSession& session, NetworkSimulator& simulator, asio::ip::tcp::socket& source, asio::ip::tcp::socket& sink)
+                : from(source),
+                  to(sink),
+                  line(simulator.io_context_, simulator.conditions_, simulator.nextSeed(), true, simulator.stats_,
+                       [this, &session](std::vector<std::uint8_t>&& bytes) {
+                           arrived.push_back(std::move(bytes));
+                           session.drain(*this);
+                       }) {}
+
+            asio::ip::tcp::socket& from;                    ///< Socket the bytes are read from.
+            asio::ip::tcp::socket& to;                      ///< Socket the bytes are written to.
+            std::array<std::uint8_t, 4096> buffer;          ///< Read buffer.
+            DelayLine line;                                 ///< Bytes in flight.
+            std::deque<std::vector<std::uint8_t>> arrived;  ///< Bytes out of the line, waiting to be written.
+            bool writing = false;                           ///< Whether a write is in progress.
+            bool ended = false;                             ///< Whether the source closed.
+            bool done = false;                              ///< Whether the sink's sending half was shut down.
+        };
+
+        /**
+         * @brief Reads from a pipe's source and feeds the bytes to its line.
+         *
+         * @param pipe The pipe.
+         */
+        void read(Pipe& pipe) {
+            auto received = [this, self = shared_from_this(), &pipe](const asio::error_code& ec, std::size_t length) {
+                if (ec) {
+                    pipe.ended = true;
+                    drain(pipe);
+                    return;
+                }
+                pipe.line.submit(std::vector<std::uint8_t>(pipe.buffer.begin(), pipe.buffer.begin() + length));
+                drain(pipe);
+                read(pipe);
+            };
+            pipe.from.async_read_some(asio::buffer(pipe.buffer), received);
+        }
+
+        /**
+         * @brief Writes the bytes that came out of a pipe's line, and ends the pipe once everything is through.
+         *
+         * Called after every read, every delivery and every write of the pipe.
+         *
+         * @param pipe The pipe.
+         */
+        void drain(Pipe& pipe) {
+            if (closed_ || pipe.writing || pipe.done)
+                return;
+            if (!pipe.arrived.empty()) {
+                pipe.writing = true;
+                auto written = [this, self = shared_from_this(), &pipe](const asio::error_code& ec, std::size_t) {
+                    pipe.writing = false;
+                    if (ec) {
+                        close();
+                        return;
+                    }
+                    pipe.arrived.pop_front();
+                    drain(pipe);
+                };
+                asio::async_write(pipe.to, asio::buffer(pipe.arrived.front()), written);
+                return;
+            }
+            if (pipe.ended && pipe.line.empty()) {
+                asio::error_code ignored;
+                pipe.to.shutdown(asio::ip::tcp::socket::shutdown_send, ignored);
+                pipe.done = true;
+                if (toUpstream_.done && toDownstream_.done)
+                    close();
+            }
+        }
+
+        /**
+         * @brief Closes both sockets and releases the session once its pending handlers are done.
+         */
+        void close() {
+            closed_ = true;
+            asio::error_code ignored;
+            downstream_.close(ignored);
+            upstream_.close(ignored);
+            self_.reset();
+        }
+
+        asio::ip::tcp::socket downstream_;  ///< Connection from the client.
+        asio::ip::tcp::socket upstream_;    ///< Connection to the server.
+        Pipe toUpstream_;                   ///< Client to server.
+        Pipe toDownstream_;                 ///< Server to client.
+        std::shared_ptr<TcpSession> self_;  ///< Keeps the session alive until both directions are done.
+        bool closed_ = false;               ///< Whether the sockets were closed.
+    };
+
+    /**
+     * @class UdpSession
+     * @brief A proxied UDP peer: its own upstream socket and one delay line per direction.
+     */
+    class UdpSession {
+       public:
+        UdpSession(NetworkSimulator& simulator, const asio::ip::udp::endpoint& peer)
+            : simulator_(simulator),
+              peer_(peer),
+              upstream_(simulator.io_context_),
+              lastActive_(DelayLine::Clock::now()),
+              toUpstream_(simulator.io_context_, simulator.conditions_, simulator.nextSeed(), false, simulator.stats_,
+                          [this](std::vector<std::uint8_t>&& bytes) {
+                              asio::error_code ignored;
+                              upstream_.send(asio::buffer(bytes), 0, ignored);
+                          }),
+              toDownstream_(simulator.io_context_, simulator.conditions_, simulator.nextSeed(), false, simulator.stats_,
+                            [this](std::vector<std::uint8_t>&& bytes) {
+                                asio::error_code ignored;
+                                simulator_.udpSocket_.send_to(asio::buffer(bytes), peer_, 0, ignored);
+                            }) {
+            upstream_.connect(simulator.udpTarget_);
+            receive();
+        }
+
+        /**
+         * @brief Forwards a datagram from the peer to the server.
+         *
+         * @param bytes The datagram.
+         */
+        void forward(std::vector<std::uint8_t>&& bytes) {
+            lastActive_ = DelayLine::Clock::now();
+            toUpstream_.submit(std::move(bytes));
+        }
+
+        /**
+         * @brief Checks whether the session exchanged no datagram for UDP_SESSION_TIMEOUT.
+         *
+         * @param now The current time.
+         * @return true if the session can be closed.
+         */
+        bool isIdle(DelayLine::Clock::time_point now) const { return now - lastActive_ >= UDP_SESSION_TIMEOUT; }
+
+       private:
+        /**
+         * @brief Receives the server's datagrams for the peer.
+         */
+        void receive() {
+            upstream_.async_receive(asio::buffer(buffer_), [this](const asio::error_code& ec, std::size_t length) {
+                if (ec == asio::error::operation_aborted)
+                    return;
+                if (!ec) {
+                    lastActive_ = DelayLine::Clock::now();
+                    toDownstream_.submit(std::vector<std::uint8_t>(buffer_.begin(), buffer_.begin() + length));
+                }
+                receive();
+            });
+        }
+
+        NetworkSimulator& simulator_;              ///< Owner of the listening socket replies are sent from.
+        asio::ip::udp::endpoint peer_;             ///< The client's endpoint.
+        asio::ip::udp::socket upstream_;           ///< Socket connected to the server.
+        DelayLine::Clock::time_point lastActive_;  ///< When a datagram last went through, either way.
+        DelayLine toUpstream_;                     ///< Client to server.
+        DelayLine toDownstream_;                   ///< Server to client.
+        std::array<std::uint8_t, 65536> buffer_;   ///< Receive buffer.
+    };
+
+    /**
+     * @brief Gets the seed of the next delay line.
+     *
+     * @return std::uint64_t A seed derived from the conditions' seed and the number of lines created.
+     */
+    std::uint64_t nextSeed() { return conditions_.seed * 0x9E3779B97F4A7C15ull + lineCount_++; }
+
+    /**
+     * @brief Accepts the next client connection and proxies it to the server.
+     */
+    void acceptConnection() {
+        acceptor_.async_accept([this](const asio::error_code& ec, asio::ip::tcp::socket socket) {
+            if (ec == asio::error::operation_aborted)
+                return;
+            if (!ec)
+                std::make_shared<TcpSession>(*this, std::move(socket))->start(tcpTarget_);
+            acceptConnection();
+        });
+    }
+
+    /**
+     * @brief Receives the next datagram from a client and forwards it through the client's session.
+     */
+    void receiveDatagram() {
+        udpSocket_.async_receive_from(asio::buffer(udpBuffer_), udpPeer_, [this](const asio::error_code& ec, std::size_t length) {
+            if (ec == asio::error::operation_aborted)
+                return;
+            if (!ec) {
+                std::unique_ptr<UdpSession>& session = udpSessions_[udpPeer_];
+                if (!session)
+                    session = std::make_unique<UdpSession>(*this, udpPeer_);
+                session->forward(std::vector<std::uint8_t>(udpBuffer_.begin(), udpBuffer_.begin() + length));
+            }
+            receiveDatagram();
+        });
+    }
+
+    /**
+     * @brief Closes the UDP sessions that went idle, then waits for the next sweep.
+     *
+     * A closed session's pending receive completes as aborted and its delay lines drop their
+     * packets, so neither touches the destroyed session.
+     */
+    void expireUdpSessions() {
+        sweepTimer_.expires_after(UDP_SESSION_TIMEOUT);
+        sweepTimer_.async_wait([this](const asio::error_code& ec) {
+            if (ec == asio::error::operation_aborted)
+                return;
+            DelayLine::Clock::time_point now = DelayLine::Clock::now();
+            std::erase_if(udpSessions_, [now](const auto& entry) { return entry.second->isIdle(now); });
+            expireUdpSessions();
+        });
+    }
+
+    NetworkConditions conditions_;                                                ///< Impairments to apply.
+    asio::io_context io_context_;                                                 ///< IO context of the simulator thread.
+    asio::ip::tcp::acceptor acceptor_;                                            ///< Listens for client connections.
+    asio::ip::udp::socket udpSocket_;                                             ///< Receives client datagrams and sends them the replies.
+    asio::ip::tcp::endpoint tcpTarget_;                                           ///< The server's TCP endpoint.
+    asio::ip::udp::endpoint udpTarget_;                                           ///< The server's UDP endpoint.
+    asio::ip::udp::endpoint udpPeer_;                                             ///< Sender of the datagram being received.
+    std::array<std::uint8_t, 65536> udpBuffer_;                                   ///< Receive buffer of the listening socket.
+    std::map<asio::ip::udp::endpoint, std::unique_ptr<UdpSession>> udpSessions_;  ///< Proxied UDP peers, until they go idle.
+    asio::steady_timer sweepTimer_;                                               ///< Fires every UDP_SESSION_TIMEOUT to close idle sessions.
+    DelayLine::Stats stats_;                                                      ///< Counters of every line.
+    std::uint64_t lineCount_ = 0;                                                 ///< Delay lines created so far.
+    std::thread thread_;                                                          ///< Runs io_context_.
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Message.hpp"
+
+/**
+ * @namespace PlayerMovement
+ * @brief Movement rules of player ships, shared by the server simulation and client prediction.
+ *
+ * Both ends must move a player identically for a given input, otherwise every prediction
+ * is corrected by the next snapshot.
+ */
+namespace PlayerMovement {
+
+const float STEP = 10.0f;            ///< Distance moved per tick along each axis whose key is held.
+const float FIELD_WIDTH = 1920.0f;   ///< Width of the playfield.
+const float FIELD_HEIGHT = 1000.0f;  ///< Height of the playfield.
+const float PLAYER_WIDTH = 40.0f;    ///< Width of a player ship.
+const float PLAYER_HEIGHT = 30.0f;   ///< Height of a player ship.
+
+/**
+ * @brief Moves a player by one tick of input.
+ *
+ * Opposite keys cancel out; horizontal and vertical movement combine. A move that would
+ * leave the playfield is not applied.
+ *
+ * @param input The input of the tick.
+ * @param x The X coordinate of the player, updated in place.
+ * @param y The Y coordinate of the player, updated in place.
+ */
+inline void apply(const Protocol::InputPayload& input, float& x, float& y) {
+    bool up = input.isHeld(InputAction::UP);
+    bool down = input.isHeld(InputAction::DOWN);
+    bool left = input.isHeld(InputAction::LEFT);
+    bool right = input.isHeld(InputAction::RIGHT);
+
+    if (up && !down && (y - STEP > 0)) {
+        y -= STEP;
+    } else if (down && !up && (y + PLAYER_HEIGHT + STEP < FIELD_HEIGHT)) {
+        y += STEP;
+    }
+    if (left && !right && (x - STEP > 0)) {
+        x -= STEP;
+    } else if (right && !left && (x + PLAYER_WIDTH + STEP < FIELD_WIDTH)) {
+        x += STEP;
+    }
+}
+
+}  // namespace PlayerMovement
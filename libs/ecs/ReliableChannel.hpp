@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "ByteStream.hpp"
+#include "Message.hpp"
+
+/**
+ * @class RttEstimator
+ * @brief Smoothed round-trip time and retransmission timeout of a link.
+ *
+ * Follows RFC 6298: the smoothed RTT and its mean deviation are updated from every sample,
+ * and the timeout is the smoothed RTT plus four deviations, clamped to a range suited to a
+ * game running at TICK_INTERVAL_MS.
+ */
+class RttEstimator {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Clock the samples are measured with.
+
+    static constexpr std::chrono::milliseconds INITIAL_TIMEOUT{250};  ///< Timeout until the first sample.
+    static constexpr std::chrono::milliseconds MIN_TIMEOUT{40};       ///< Shortest timeout, above one tick of jitter.
+    static constexpr std::chrono::milliseconds MAX_TIMEOUT{2000};     ///< Longest timeout, exponential backoff included.
+
+    /**
+     * @brief Updates the estimate with a measured round trip.
+     *
+     * @param rtt The time between sending a packet and receiving its acknowledgement.
+     */
+    void sample(Clock::duration rtt) {
+        if (!measured_) {
+            smoothed_ = rtt;
+            deviation_ = rtt / 2;
+            measured_ = true;
+        } else {
+            Clock::duration error = rtt > smoothed_ ? rtt - smoothed_ : smoothed_ - rtt;
+            deviation_ = (deviation_ * 3 + error) / 4;
+            smoothed_ = (smoothed_ * 7 + rtt) / 8;
+        }
+    }
+
+    /**
+     * @brief Gets the retransmission timeout of a message.
+     *
+     * @param attempts Number of times the message was already sent; each resend doubles the timeout.
+     * @return Clock::duration The time to wait for an acknowledgement before sending it again.
+     */
+    Clock::duration getTimeout(unsigned attempts = 1) const {
+        Clock::duration timeout = measured_ ? smoothed_ + deviation_ * 4 : Clock::duration(INITIAL_TIMEOUT);
+        timeout = std::clamp<Clock::duration>(timeout, MIN_TIMEOUT, MAX_TIMEOUT);
+        for (unsigned i = 1; i < attempts && timeout < MAX_TIMEOUT; ++i)
+            timeout *= 2;
+        return std::min<Clock::duration>(timeout, MAX_TIMEOUT);
+    }
+
+    /**
+     * @brief Gets the smoothed round-trip time.
+     *
+     * @return Clock::duration The smoothed RTT, or zero before the first sample.
+     */
+    Clock::duration getSmoothed() const { return smoothed_; }
+
+   private:
+    bool measured_ = false;         ///< Whether a sample was taken.
+    Clock::duration smoothed_{0};   ///< Smoothed round-trip time.
+    Clock::duration deviation_{0};  ///< Smoothed mean deviation of the round-trip time.
+};
+
+/**
+ * @class ReliableChannel
+ * @brief Reliable, ordered delivery of messages over datagrams.
+ *
+ * Every packet carries a 16-bit packet sequence, the newest packet sequence received from
+ * the peer, and a 32-bit field acknowledging the 32 packets before it, so each packet
+ * repeats the acknowledgements of the previous ones and a lost acknowledgement is made
+ * up for by the next packet. Messages get their own 16-bit IDs; a message is acknowledged
+ * once any packet carrying it is, and is sent again in a later packet once its timeout,
+ * derived from the round-trip times measured on acknowledged packets, elapses. Packet
+ * sequences are never reused, so every acknowledgement gives an unambiguous RTT sample,
+ * resends included.
+ *
+ * The receiver delivers messages in ID order, holding back those that arrive ahead of a
+ * missing one. Packets travel as a RELIABLE message in their own datagrams, so they
+ * never wait behind the snapshot stream, and a lost one only delays the messages it
+ * carried.
+ *
+ * The channel does no IO and no locking: the owner feeds it received packets, and sends
+ * the packets it builds, at least once per tick while messages are pending.
+ *
+ * Until a packet arrives from the peer there is nothing to acknowledge, so packets carry
+ * a flag telling whether their acknowledgement fields are meaningful; without it, the
+ * zeroed fields would acknowledge the peer's packet 0 before it ever arrived.
+ *
+ * Packet payload: packet sequence (u16), flags (u8, ACKNOWLEDGES), acknowledged sequence
+ * (u16), acknowledgement bits (u32), message count (u16), then for each message its ID
+ * (u16) and the encoded message, header included.
+ */
+class ReliableChannel {
+   public:
+    using Clock = RttEstimator::Clock;  ///< Clock the timeouts are measured with.
+
+    static constexpr std::size_t WINDOW = 256;                                                 ///< Messages in flight, and held back by the receiver.
+    static constexpr std::size_t SENT_PACKETS = 128;                                           ///< Packets remembered for acknowledgements.
+    static constexpr std::size_t MAX_PACKET_MESSAGES = 32;                                     ///< Messages carried by one packet.
+    static constexpr std::size_t MAX_PACKET_SIZE = 1200;                                       ///< Largest packet, kept below common MTUs.
+    static constexpr std::size_t PACKET_OVERHEAD = Protocol::HEADER_SIZE + 2 + 1 + 2 + 4 + 2;  ///< Bytes of a packet carrying no message.
+    static constexpr std::uint8_t ACKNOWLEDGES = 0x01;                                         ///< Packet flag: the acknowledgement fields are valid.
+    static constexpr std::size_t MAX_MESSAGE_SIZE = MAX_PACKET_SIZE - PACKET_OVERHEAD - 2;     ///< Largest message accepted.
+
+    /**
+     * @brief Queues a message for reliable delivery.
+     *
+     * @param message The encoded message, header included.
+     * @return true if the message was queued, false if it is too large or WINDOW messages are unacknowledged.
+     */
+    bool send(std::span<const std::uint8_t> message) {
+        if (message.size() > MAX_MESSAGE_SIZE || getPendingCount() >= WINDOW)
+            return false;
+        Outgoing& slot = outgoing_[nextMessageId_ % WINDOW];
+        slot.id = nextMessageId_++;
+        slot.bytes.assign(message.begin(), message.end());
+        slot.attempts = 0;
+        slot.acknowledged = false;
+        return true;
+    }
+
+    /**
+     * @brief Builds the next packet to send, if any.
+     *
+     * A packet is built when a message was never sent or timed out, or when the peer sent
+     * messages since the last packet and is owed an acknowledgement. Call it until it
+     * returns 0 to send everything that is due.
+     *
+     * @param now The current time.
+     * @param out The destination buffer, at least MAX_PACKET_SIZE bytes long.
+     * @return std::size_t The size of the RELIABLE message written, or 0 if nothing is due.
+     */
+    std::size_t writePacket(Clock::time_point now, std::span<std::uint8_t> out) {
+        if (out.size() < MAX_PACKET_SIZE)
+            return 0;
+        ByteWriter writer(out.first(MAX_PACKET_SIZE));
+        Protocol::MessageHeader header;
+        header.type = RFC::RELIABLE;
+        header.encode(writer);
+        writer.writeU16(nextPacketSequence_);
+        writer.writeU8(receivedAny_ ? ACKNOWLEDGES : 0);
+        writer.writeU16(receivedSequence_);
+        writer.writeU32(receivedBits_);
+        std::size_t countOffset = writer.size();
+        writer.writeU16(0);
+
+        SentPacket& packet = sent_[nextPacketSequence_ % SENT_PACKETS];
+        packet.count = 0;
+        for (std::uint16_t id = oldestMessageId_; id != nextMessageId_ && packet.count < MAX_PACKET_MESSAGES; ++id) {
+            Outgoing& message = outgoing_[id % WINDOW];
+            if (message.acknowledged || (message.attempts > 0 && now < message.sentAt + rtt_.getTimeout(message.attempts)))
+                continue;
+            if (writer.remaining() < 2 + message.bytes.size())
+                break;
+            writer.writeU16(id);
+            writer.writeBytes(message.bytes);
+            if (message.attempts > 0)
+                ++resent_;
+            ++message.attempts;
+            message.sentAt = now;
+            packet.ids[packet.count++] = id;
+        }
+        if (packet.count == 0 && !acknowledgementDue_)
+            return 0;
+
+        writer.patchU16(countOffset, packet.count);
+        writer.patchU16(Protocol::PAYLOAD_SIZE_OFFSET, static_cast<std::uint16_t>(writer.size() - Protocol::HEADER_SIZE));
+        packet.sequence = nextPacketSequence_++;
+        packet.sentAt = now;
+        packet.valid = true;
+        acknowledgementDue_ = false;
+        return writer.size();
+    }
+
+    /**
+     * @brief Processes a packet received from the peer.
+     *
+     * Acknowledges the messages of every packet it acknowledges, then delivers the messages
+     * it carries that come next in order, followed by any held back behind them.
+     *
+     * @tparam Deliver Callable taking a const Message&, valid only during the call.
+     * @param packet A RELIABLE message.
+     * @param now The current time.
+     * @param deliver Called with each message, in order, exactly once.
+     * @return true if the packet was well-formed, false otherwise.
+     */
+    template <typename Deliver>
+    bool receive(const Message& packet, Clock::time_point now, Deliver&& deliver) {
+        if (packet.type() != RFC::RELIABLE)
+            return false;
+        ByteReader reader(packet.payload);
+        std::uint16_t sequence = reader.readU16();
+        std::uint8_t flags = reader.readU8();
+        std::uint16_t acknowledged = reader.readU16();
+        std::uint32_t bits = reader.readU32();
+        std::uint16_t count = reader.readU16();
+        if (!reader.ok())
+            return false;
+
+        if (flags & ACKNOWLEDGES) {
+            acknowledge(acknowledged, now, true);
+            for (std::uint16_t i = 0; i < 32; ++i) {
+                if (bits & (1u << i))
+                    acknowledge(static_cast<std::uint16_t>(acknowledged - 1 - i), now, false);
+            }
+        }
+        recordReceived(sequence);
+
+        for (std::uint16_t i = 0; i < count; ++i) {
+            std::uint16_t id = reader.readU16();
+            Message message;
+            if (!reader.ok() || !Message::deserialize(packet.payload.subspan(reader.offset()), message))
+                return false;
+            std::span<const std::uint8_t> bytes = reader.readBytes(message.size());
+            acknowledgementDue_ = true;
+            if (id == nextExpectedId_) {
+                deliver(message);
+                ++nextExpectedId_;
+                deliverHeldBack(deliver);
+            } else if (isNewer(id, nextExpectedId_) && static_cast<std::uint16_t>(id - nextExpectedId_) < WINDOW) {
+                Incoming& slot = incoming_[id % WINDOW];
+                if (!slot.held || slot.id != id) {
+                    slot.id = id;
+                    slot.bytes.assign(bytes.begin(), bytes.end());
+                    slot.held = true;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of messages sent and not acknowledged yet.
+     *
+     * @return std::size_t The pending message count.
+     */
+    std::size_t getPendingCount() const { return static_cast<std::uint16_t>(nextMessageId_ - oldestMessageId_); }
+
+    /**
+     * @brief Gets the number of times a message was sent again after a timeout.
+     *
+     * @return std::uint64_t The resend count.
+     */
+    std::uint64_t getResentCount() const { return resent_; }
+
+    /**
+     * @brief Gets the round-trip time estimate of the link.
+     *
+     * @return const RttEstimator& The estimator.
+     */
+    const RttEstimator& getRtt() const { return rtt_; }
+
+   private:
+    /**
+     * @struct Outgoing
+     * @brief A message sent and not acknowledged yet.
+     */
+    struct Outgoing {
+        std::uint16_t id = 0;             ///< ID of the message.
+        std::vector<std::uint8_t> bytes;  ///< The encoded message; the storage is reused by later messages.
+        unsigned attempts = 0;            ///< Number of packets that carried the message.
+        Clock::time_point sentAt;         ///< When the message was last sent.
+        bool acknowledged = false;        ///< Whether a packet carrying the message was acknowledged.
+    };
+
+    /**
+     * @struct SentPacket
+     * @brief The messages a sent packet carried.
+     */
+    struct SentPacket {
+        std::uint16_t sequence = 0;                            ///< Sequence of the packet.
+        bool valid = false;                                    ///< Whether the packet awaits its acknowledgement.
+        Clock::time_point sentAt;                              ///< When the packet was sent.
+        std::uint16_t count = 0;                               ///< Number of messages carried.
+        std::array<std::uint16_t, MAX_PACKET_MESSAGES> ids{};  ///< IDs of the messages carried.
+    };
+
+    /**
+     * @struct Incoming
+     * @brief A message received ahead of a missing one.
+     */
+    struct Incoming {
+        std::uint16_t id = 0;             ///< ID of the message.
+        bool held = false;                ///< Whether the slot holds a message.
+        std::vector<std::uint8_t> bytes;  ///< The encoded message.
+    };
+
+    /**
+     * @brief Checks whether a 16-bit sequence is more recent than another, across wrap-around.
+     *
+     * @param a The first sequence.
+     * @param b The second sequence.
+     * @return true if a comes after b, false otherwise.
+     */
+    static bool isNewer(std::uint16_t a, std::uint16_t b) { return static_cast<std::int16_t>(a - b) > 0; }
+
+    /**
+     * @brief Handles the acknowledgement of one of our packets, once.
+     *
+     * Only the newest packet the peer received gives an RTT sample: the older ones may be
+     * acknowledged by the bits of a packet sent long after they arrived.
+     *
+     * @param sequence The sequence of the acknowledged packet.
+     * @param now The current time.
+     * @param newest Whether the packet is the newest the peer received.
+     */
+    void acknowledge(std::uint16_t sequence, Clock::time_point now, bool newest) {
+        SentPacket& packet = sent_[sequence % SENT_PACKETS];
+        if (!packet.valid || packet.sequence != sequence)
+            return;
+        packet.valid = false;
+        if (newest)
+            rtt_.sample(now - packet.sentAt);
+        for (std::uint16_t i = 0; i < packet.count; ++i) {
+            Outgoing& message = outgoing_[packet.ids[i] % WINDOW];
+            if (message.id == packet.ids[i])
+                message.acknowledged = true;
+        }
+        while (oldestMessageId_ != nextMessageId_ && outgoing_[oldestMessageId_ % WINDOW].acknowledged)
+            ++oldestMessageId_;
+    }
+
+    /**
+     * @brief Records a packet received from the peer in the acknowledgements to send back.
+     *
+     * @param sequence The sequence of the received packet.
+     */
+    void recordReceived(std::uint16_t sequence) {
+        if (!receivedAny_) {
+            receivedAny_ = true;
+            receivedSequence_ = sequence;
+            receivedBits_ = 0;
+        } else if (isNewer(sequence, receivedSequence_)) {
+            std::uint16_t shift = static_cast<std::uint16_t>(sequence - receivedSequence_);
+            if (shift < 32)
+                receivedBits_ = (receivedBits_ << shift) | (1u << (shift - 1));
+            else
+                receivedBits_ = shift == 32 ? 1u << 31 : 0;
+            receivedSequence_ = sequence;
+        } else {
+            std::uint16_t age = static_cast<std::uint16_t>(receivedSequence_ - sequence);
+            if (age >= 1 && age <= 32)
+                receivedBits_ |= 1u << (age - 1);
+        }
+    }
+
+    /**
+     * @brief Delivers the held back messages that are now next in order.
+     *
+     * @param deliver Called with each message.
+     */
+    template <typename Deliver>
+    void deliverHeldBack(Deliver& deliver) {
+        for (;;) {
+            Incoming& slot = incoming_[nextExpectedId_ % WINDOW];
+            if (!slot.held || slot.id != nextExpectedId_)
+                return;
+            slot.held = false;
+            Message message;
+            if (Message::deserialize(slot.bytes, message))
+                deliver(message);
+            ++nextExpectedId_;
+        }
+    }
+
+    RttEstimator rtt_;                           ///< Round-trip time of the link.
+    std::array<Outgoing, WINDOW> outgoing_;      ///< Messages in flight, by ID.
+    std::array<SentPacket, SENT_PACKETS> sent_;  ///< Packets awaiting acknowledgement, by sequence.
+    std::array<Incoming, WINDOW> incoming_;      ///< Messages held back, by ID.
+    std::uint16_t nextMessageId_ = 0;            ///< ID of the next message sent.
+    std::uint16_t oldestMessageId_ = 0;          ///< Oldest message not acknowledged.
+    std::uint16_t nextPacketSequence_ = 0;       ///< Sequence of the next packet sent.
+    std::uint16_t nextExpectedId_ = 0;           ///< ID of the next message to deliver.
+    bool receivedAny_ = false;                   ///< Whether a packet was received from the peer.
+    std::uint16_t receivedSequence_ = 0;         ///< Newest packet sequence received from the peer.
+    std::uint32_t receivedBits_ = 0;             ///< Which of the 32 packets before it were received.
+    bool acknowledgementDue_ = false;            ///< Whether the peer sent messages since the last packet.
+    std::uint64_t resent_ = 0;                   ///< Messages sent again after a timeout.
+};
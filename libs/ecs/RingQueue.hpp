@@ -0,0 +1,175 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * @brief Alignment keeping the producer and consumer indices on separate cache lines.
+ */
+inline constexpr std::size_t RING_CACHE_LINE_SIZE = 64;
+
+/**
+ * @class SpscRing
+ * @brief Bounded lock-free queue with a single producer and a single consumer.
+ *
+ * Each index is written by one side only, so pushing and popping are a load, a store and
+ * no read-modify-write. Producer and consumer may be different threads, or handlers
+ * serialized by a strand: only their calls must not overlap on the same side.
+ *
+ * @tparam T The element type; it must be default-constructible and movable.
+ * @tparam Capacity The number of slots, a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+   public:
+    /**
+     * @brief Appends an element; called by the producer.
+     *
+     * @param value The element; left untouched if the queue is full.
+     * @return true if the element was queued, false if the queue is full.
+     */
+    bool tryPush(T&& value) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity)
+            return false;
+        slots_[tail & (Capacity - 1)] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Appends a copy of an element; called by the producer.
+     *
+     * @param value The element.
+     * @return true if the element was queued, false if the queue is full.
+     */
+    bool tryPush(const T& value) {
+        T copy = value;
+        return tryPush(std::move(copy));
+    }
+
+    /**
+     * @brief Removes the oldest element; called by the consumer.
+     *
+     * @param value Filled with the element.
+     * @return true if an element was removed, false if the queue is empty.
+     */
+    bool tryPop(T& value) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire))
+            return false;
+        value = std::move(slots_[head & (Capacity - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of queued elements.
+     *
+     * Exact when called by the consumer; from another thread, the count may be outdated by
+     * the time it returns.
+     *
+     * @return std::size_t The element count.
+     */
+    std::size_t size() const {
+        std::size_t head = head_.load(std::memory_order_acquire);  // Loaded first, so it cannot pass the tail loaded next
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+   private:
+    std::array<T, Capacity> slots_{};                                 ///< Element storage.
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<std::size_t> head_{0};  ///< Next slot to pop, written by the consumer.
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{0};  ///< Next slot to push, written by the producer.
+};
+
+/**
+ * @class MpscRing
+ * @brief Bounded lock-free queue with any number of producers and a single consumer.
+ *
+ * Every slot carries a sequence number telling whether it is free for the producer at a
+ * given position or holds an element for the consumer, so producers only contend on one
+ * compare-and-swap of the tail and never wait for each other.
+ *
+ * @tparam T The element type; it must be default-constructible and movable.
+ * @tparam Capacity The number of slots, a power of two.
+ */
+template <typename T, std::size_t Capacity>
+class MpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+   public:
+    /**
+     * @brief Constructs an empty queue.
+     */
+    MpscRing() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Appends an element; called by any producer.
+     *
+     * @param value The element; left untouched if the queue is full.
+     * @return true if the element was queued, false if the queue is full.
+     */
+    bool tryPush(T&& value) {
+        std::size_t position = tail_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &slots_[position & (Capacity - 1)];
+            std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            } else if (difference < 0) {
+                return false;  // The slot still holds the element pushed one lap earlier
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element; called by the consumer.
+     *
+     * The slot is reset, so resources held by the element are released right away.
+     *
+     * @param value Filled with the element.
+     * @return true if an element was removed, false if the queue is empty or the oldest push is still in progress.
+     */
+    bool tryPop(T& value) {
+        std::size_t position = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[position & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            return false;
+        value = std::move(slot.value);
+        slot.value = T{};
+        slot.sequence.store(position + Capacity, std::memory_order_release);
+        head_.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+   private:
+    /**
+     * @struct Slot
+     * @brief An element and the position it is ready for.
+     */
+    struct Slot {
+        std::atomic<std::size_t> sequence{0};  ///< position for a free slot, position + 1 for a filled one.
+        T value{};                             ///< The element.
+    };
+
+    std::array<Slot, Capacity> slots_;                                ///< Element storage.
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<std::size_t> head_{0};  ///< Next slot to pop, only used by the consumer.
+    alignas(RING_CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{0};  ///< Next slot to push, shared by the producers.
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include "BufferPool.hpp"
+
+/**
+ * @brief Pool every shared buffer is allocated from.
+ *
+ * @return BufferPool& The process-wide send buffer pool.
+ */
+inline BufferPool& sharedBufferPool() {
+    static BufferPool pool;
+    return pool;
+}
+
+/**
+ * @class SharedBuffer
+ * @brief Immutable, reference-counted encoded message.
+ *
+ * A message sent to several clients is encoded once into a SharedBuffer; every send
+ * queue then holds a handle to the same bytes instead of its own copy. The bytes live in
+ * a pooled block, given back to the pool when the last queue is done with them, so the
+ * steady-state send path neither allocates nor frees memory.
+ *
+ * Handles are used like a shared pointer to a BufferBlock. The count is atomic, so copies
+ * may be released on any thread.
+ */
+class SharedBuffer {
+   public:
+    /**
+     * @brief Constructs an empty handle.
+     */
+    SharedBuffer() = default;
+
+    /**
+     * @brief Constructs an empty handle.
+     */
+    SharedBuffer(std::nullptr_t) {}
+
+    /**
+     * @brief Takes a reference to a block.
+     *
+     * @param block The block, acquired from a BufferPool.
+     */
+    explicit SharedBuffer(BufferBlock* block) : block_(block) {
+        if (block_)
+            block_->references_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    SharedBuffer(const SharedBuffer& other) : SharedBuffer(other.block_) {}
+
+    SharedBuffer(SharedBuffer&& other) noexcept : block_(std::exchange(other.block_, nullptr)) {}
+
+    SharedBuffer& operator=(const SharedBuffer& other) {
+        if (block_ != other.block_)
+            SharedBuffer(other).swap(*this);
+        return *this;
+    }
+
+    SharedBuffer& operator=(SharedBuffer&& other) noexcept {
+        SharedBuffer(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    /**
+     * @brief Drops the reference, giving the block back to its pool if it was the last one.
+     */
+    ~SharedBuffer() { reset(); }
+
+    /**
+     * @brief Drops the reference and empties the handle.
+     */
+    void reset() {
+        BufferBlock* block = std::exchange(block_, nullptr);
+        if (block && block->references_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            block->pool_->release(block);
+    }
+
+    /**
+     * @brief Exchanges the blocks of two handles.
+     *
+     * @param other The other handle.
+     */
+    void swap(SharedBuffer& other) noexcept { std::swap(block_, other.block_); }
+
+    const BufferBlock* get() const { return block_; }
+    const BufferBlock* operator->() const { return block_; }
+    const BufferBlock& operator*() const { return *block_; }
+    explicit operator bool() const { return block_ != nullptr; }
+
+   private:
+    BufferBlock* block_ = nullptr;  ///< Referenced block, or nullptr.
+};
+
+/**
+ * @brief Copies encoded bytes into a new shared buffer.
+ *
+ * @param bytes The encoded message.
+ * @return SharedBuffer The shared, immutable copy, held in a block of the shared buffer pool.
+ */
+inline SharedBuffer makeSharedBuffer(std::span<const std::uint8_t> bytes) {
+    return SharedBuffer(sharedBufferPool().acquire(bytes));
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Message.hpp"
+
+/**
+ * @struct Snapshot
+ * @brief The state of every replicated entity at one server tick.
+ */
+struct Snapshot {
+    std::uint32_t sequence = 0;                 ///< Sequence number of the tick the snapshot was taken at.
+    std::vector<Protocol::EntityState> states;  ///< Entity states, sorted by entity ID.
+    std::vector<Protocol::InputAck> inputAcks;  ///< Newest input applied to each player.
+
+    /**
+     * @brief Sorts the entity states by entity ID, as required by the delta codec.
+     */
+    void sort() {
+        std::sort(states.begin(), states.end(), [](const auto& a, const auto& b) { return a.entityId < b.entityId; });
+    }
+
+    /**
+     * @brief Finds the state of an entity.
+     *
+     * @param entityId The identifier of the entity.
+     * @return const Protocol::EntityState* The state, or nullptr if the entity is not in the snapshot.
+     */
+    const Protocol::EntityState* find(std::int32_t entityId) const {
+        auto it = std::lower_bound(states.begin(), states.end(), entityId, [](const auto& state, std::int32_t id) { return state.entityId < id; });
+        return it != states.end() && it->entityId == entityId ? &*it : nullptr;
+    }
+
+    /**
+     * @brief Finds the newest input applied to a player.
+     *
+     * @param entityId The identifier of the player entity.
+     * @return const Protocol::InputAck* The acknowledgement, or nullptr if the player has none.
+     */
+    const Protocol::InputAck* findInputAck(std::int32_t entityId) const {
+        auto it = std::find_if(inputAcks.begin(), inputAcks.end(), [entityId](const auto& ack) { return ack.entityId == entityId; });
+        return it != inputAcks.end() ? &*it : nullptr;
+    }
+};
+
+/**
+ * @class SnapshotHistory
+ * @brief Fixed-size ring of the most recent snapshots, indexed by sequence number.
+ *
+ * Slots and their state vectors are reused, so once warmed up, recording a snapshot
+ * does not allocate.
+ */
+class SnapshotHistory {
+   public:
+    static constexpr std::size_t CAPACITY = 32;  ///< Number of snapshots kept (about one second of ticks).
+
+    /**
+     * @brief Claims the slot for a new snapshot, evicting the oldest one.
+     *
+     * @param sequence The sequence number of the new snapshot.
+     * @return Snapshot& The cleared snapshot to fill.
+     */
+    Snapshot& push(std::uint32_t sequence) {
+        std::size_t index = sequence % CAPACITY;
+        Snapshot& snapshot = ring_[index];
+        snapshot.sequence = sequence;
+        snapshot.states.clear();
+        snapshot.inputAcks.clear();
+        valid_[index] = true;
+        return snapshot;
+    }
+
+    /**
+     * @brief Finds a snapshot by sequence number.
+     *
+     * @param sequence The sequence number.
+     * @return const Snapshot* The snapshot, or nullptr if it was never recorded or has been evicted.
+     */
+    const Snapshot* find(std::uint32_t sequence) const {
+        std::size_t index = sequence % CAPACITY;
+        return valid_[index] && ring_[index].sequence == sequence ? &ring_[index] : nullptr;
+    }
+
+    /**
+     * @brief Forgets every recorded snapshot.
+     */
+    void clear() { valid_.fill(false); }
+
+   private:
+    std::array<Snapshot, CAPACITY> ring_;  ///< Snapshot slots.
+    std::array<bool, CAPACITY> valid_{};   ///< Whether each slot holds a recorded snapshot.
+};
+
+namespace Protocol {
+
+/**
+ * @brief Rebuilds a full snapshot from a STATE_UPDATE message.
+ *
+ * @param message The received message.
+ * @param out Filled with the entity states and input acknowledgements; its sequence is left unchanged.
+ * @param quantization The position quantization the message was encoded with.
+ * @return true if the message is a well-formed STATE_UPDATE, false otherwise.
+ */
+inline bool decodeStateUpdate(const Message& message, Snapshot& out, const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION) {
+    StateUpdateView view;
+    if (!StateUpdateView::decode(message, view, quantization))
+        return false;
+    out.states.clear();
+    out.inputAcks.clear();
+    view.forEach([&out](const EntityState& state) { out.states.push_back(state); });
+    view.forEachInputAck([&out](const InputAck& ack) { out.inputAcks.push_back(ack); });
+    out.sort();
+    return true;
+}
+
+/**
+ * @class StateDelta
+ * @brief Codec for STATE_DELTA messages.
+ *
+ * A delta describes a snapshot relative to a baseline snapshot the client acknowledged:
+ * the sequence of the baseline, the entities that moved or appeared, and the entities
+ * that disappeared. Entities whose quantized position did not change are omitted, so
+ * idle entities cost nothing on the wire.
+ *
+ * The payload is bit-packed: 32-bit baseline sequence, 16-bit changed count, then for
+ * each changed entity its ID (variable-length difference from the previous one), a
+ * 2-bit presence mask and the quantized coordinates the mask flags; then a 16-bit
+ * removed count and the removed IDs, encoded the same way; then the input acknowledgement
+ * table of the current snapshot, which is always sent in full.
+ */
+class StateDelta {
+   public:
+    static constexpr std::uint32_t HAS_X = 1;  ///< Presence flag: the X coordinate follows.
+    static constexpr std::uint32_t HAS_Y = 2;  ///< Presence flag: the Y coordinate follows.
+
+    /**
+     * @brief Encodes the delta between two snapshots as a STATE_DELTA message.
+     *
+     * @param baseline The snapshot the client acknowledged.
+     * @param current The snapshot to send.
+     * @param out The destination buffer.
+     * @param quantization The position quantization to encode with.
+     * @return std::size_t The number of bytes written, or 0 if the buffer is too small.
+     */
+    static std::size_t encode(const Snapshot& baseline, const Snapshot& current, std::span<std::uint8_t> out,
+                              const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION) {
+        if (out.size() < HEADER_SIZE)
+            return 0;
+        BitWriter bits(out.subspan(HEADER_SIZE));
+        bits.writeBits(baseline.sequence, 32);
+
+        std::size_t changedOffset = bits.bitSize();
+        std::size_t changed = 0;
+        std::int32_t previousId = 0;
+        bits.writeBits(0, 16);
+        for (const EntityState& state : current.states) {
+            std::uint32_t x = quantization.x.encode(state.x);
+            std::uint32_t y = quantization.y.encode(state.y);
+            const EntityState* previous = baseline.find(state.entityId);
+            std::uint32_t mask = HAS_X | HAS_Y;
+            if (previous) {
+                mask = (quantization.x.encode(previous->x) != x ? HAS_X : 0) | (quantization.y.encode(previous->y) != y ? HAS_Y : 0);
+                if (mask == 0)
+                    continue;
+            }
+            writeId(bits, state.entityId, previousId);
+            bits.writeBits(mask, 2);
+            if (mask & HAS_X)
+                bits.writeBits(x, quantization.x.bits);
+            if (mask & HAS_Y)
+                bits.writeBits(y, quantization.y.bits);
+            ++changed;
+        }
+
+        std::size_t removedOffset = bits.bitSize();
+        std::size_t removed = 0;
+        previousId = 0;
+        bits.writeBits(0, 16);
+        for (const EntityState& state : baseline.states) {
+            if (!current.find(state.entityId)) {
+                writeId(bits, state.entityId, previousId);
+                ++removed;
+            }
+        }
+        writeInputAcks(bits, std::span(current.inputAcks).first(std::min<std::size_t>(current.inputAcks.size(), 0xFFFF)));
+
+        if (!bits.ok() || bits.size() > MAX_PAYLOAD_SIZE || changed > 0xFFFF || removed > 0xFFFF)
+            return 0;
+        bits.patchBits(changedOffset, static_cast<std::uint32_t>(changed), 16);
+        bits.patchBits(removedOffset, static_cast<std::uint32_t>(removed), 16);
+        MessageHeader header;
+        header.type = RFC::STATE_DELTA;
+        header.payloadSize = static_cast<std::uint16_t>(bits.size());
+        ByteWriter writer(out);
+        header.encode(writer);
+        return HEADER_SIZE + bits.size();
+    }
+
+    /**
+     * @brief Reads the baseline sequence of a STATE_DELTA message.
+     *
+     * @param message The received message.
+     * @param baselineSequence Filled with the baseline sequence.
+     * @return true if the message is a STATE_DELTA, false otherwise.
+     */
+    static bool baselineOf(const Message& message, std::uint32_t& baselineSequence) {
+        if (message.type() != RFC::STATE_DELTA)
+            return false;
+        BitReader reader(message.payload);
+        baselineSequence = reader.readBits(32);
+        return reader.ok();
+    }
+
+    /**
+     * @brief Rebuilds a full snapshot from a baseline and a STATE_DELTA message.
+     *
+     * @param message The received STATE_DELTA message.
+     * @param baseline The baseline snapshot the delta refers to.
+     * @param out Filled with the resulting entity states; must not alias the baseline.
+     * @param quantization The position quantization the message was encoded with.
+     * @return true if the delta is well-formed, false otherwise.
+     */
+    static bool apply(const Message& message, const Snapshot& baseline, Snapshot& out,
+                      const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION) {
+        BitReader reader(message.payload);
+        if (reader.readBits(32) != baseline.sequence)
+            return false;
+        out.states.assign(baseline.states.begin(), baseline.states.end());
+
+        std::uint32_t changed = reader.readBits(16);
+        std::int32_t previousId = 0;
+        for (std::uint32_t i = 0; i < changed && reader.ok(); ++i) {
+            std::int32_t entityId = readId(reader, previousId);
+            std::uint32_t mask = reader.readBits(2);
+            auto it = lowerBound(out, entityId);
+            if (it == out.states.end() || it->entityId != entityId) {
+                if (mask != (HAS_X | HAS_Y))
+                    return false;  // A new entity must carry its full position
+                it = out.states.insert(it, EntityState{entityId, 0.0f, 0.0f});
+            }
+            if (mask & HAS_X)
+                it->x = quantization.x.decode(reader.readBits(quantization.x.bits));
+            if (mask & HAS_Y)
+                it->y = quantization.y.decode(reader.readBits(quantization.y.bits));
+        }
+
+        std::uint32_t removed = reader.readBits(16);
+        previousId = 0;
+        for (std::uint32_t i = 0; i < removed && reader.ok(); ++i) {
+            std::int32_t entityId = readId(reader, previousId);
+            auto it = lowerBound(out, entityId);
+            if (it != out.states.end() && it->entityId == entityId)
+                out.states.erase(it);
+        }
+
+        out.inputAcks.clear();
+        return readInputAcks(reader, [&out](const InputAck& ack) { out.inputAcks.push_back(ack); }) && reader.atEnd();
+    }
+
+   private:
+    /**
+     * @brief Writes an entity ID as a variable-length difference from the previous one.
+     *
+     * @param bits The writer to encode into.
+     * @param entityId The identifier to write.
+     * @param previousId The previously written identifier, updated to entityId.
+     */
+    static void writeId(BitWriter& bits, std::int32_t entityId, std::int32_t& previousId) {
+        bits.writeVarUInt(static_cast<std::uint32_t>(entityId) - static_cast<std::uint32_t>(previousId));
+        previousId = entityId;
+    }
+
+    /**
+     * @brief Reads an entity ID written by writeId().
+     *
+     * @param reader The reader to decode from.
+     * @param previousId The previously read identifier, updated to the result.
+     * @return std::int32_t The identifier read.
+     */
+    static std::int32_t readId(BitReader& reader, std::int32_t& previousId) {
+        previousId = static_cast<std::int32_t>(static_cast<std::uint32_t>(previousId) + reader.readVarUInt());
+        return previousId;
+    }
+
+    /**
+     * @brief Finds where an entity is, or would be inserted, in a sorted snapshot.
+     *
+     * @param snapshot The snapshot to search.
+     * @param entityId The identifier of the entity.
+     * @return std::vector<EntityState>::iterator Iterator to the first state whose ID is not less than entityId.
+     */
+    static std::vector<EntityState>::iterator lowerBound(Snapshot& snapshot, std::int32_t entityId) {
+        return std::lower_bound(snapshot.states.begin(), snapshot.states.end(), entityId,
+                                [](const EntityState& state, std::int32_t id) { return state.entityId < id; });
+    }
+};
+
+/**
+ * @struct WorldEntity
+ * @brief An entity of a WORLD_STATE message: its kind and position.
+ */
+struct WorldEntity {
+    std::int32_t entityId = 0;                  ///< Identifier of the entity.
+    EntityType entityType = EntityType::ENEMY;  ///< Kind of the entity.
+    float x = 0.0f;                             ///< X coordinate of the entity.
+    float y = 0.0f;                             ///< Y coordinate of the entity.
+};
+
+/**
+ * @class WorldState
+ * @brief Codec for WORLD_STATE messages.
+ *
+ * A resumed client has missed the NEW_ENTITY and ENTITY_DEAD events sent while it was
+ * away, so instead of replaying them the server describes, in one message, every entity
+ * the client sees: entities it already knows are moved, new ones created, and those
+ * missing hidden. A spectator joining a match is sent one too, describing the whole match.
+ *
+ * The payload is bit-packed like a STATE_UPDATE: a 16-bit entity count, then for each
+ * entity its ID as a variable-length difference from the previous ID, its type in
+ * TYPE_BITS bits and its quantized coordinates. Entities must be given in ascending ID order.
+ */
+class WorldState {
+   public:
+    static constexpr unsigned TYPE_BITS = 2;  ///< Bits of the entity type of each entity.
+
+    /**
+     * @brief Encodes entities as a WORLD_STATE message.
+     *
+     * @param entities The entities, sorted by ID, at most 0xFFFF.
+     * @param out The destination buffer.
+     * @param quantization The position quantization to encode with.
+     * @return std::size_t The number of bytes written, or 0 if the buffer is too small.
+     */
+    static std::size_t encode(std::span<const WorldEntity> entities, std::span<std::uint8_t> out,
+                              const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION) {
+        if (out.size() < HEADER_SIZE || entities.size() > 0xFFFF)
+            return 0;
+        BitWriter bits(out.subspan(HEADER_SIZE));
+        bits.writeBits(static_cast<std::uint32_t>(entities.size()), 16);
+        std::int32_t previousId = 0;
+        for (const WorldEntity& entity : entities) {
+            bits.writeVarUInt(static_cast<std::uint32_t>(entity.entityId) - static_cast<std::uint32_t>(previousId));
+            bits.writeBits(static_cast<std::uint32_t>(entity.entityType), TYPE_BITS);
+            bits.writeBits(quantization.x.encode(entity.x), quantization.x.bits);
+            bits.writeBits(quantization.y.encode(entity.y), quantization.y.bits);
+            previousId = entity.entityId;
+        }
+        if (!bits.ok() || bits.size() > MAX_PAYLOAD_SIZE)
+            return 0;
+        MessageHeader header;
+        header.type = RFC::WORLD_STATE;
+        header.payloadSize = static_cast<std::uint16_t>(bits.size());
+        ByteWriter writer(out);
+        header.encode(writer);
+        return HEADER_SIZE + bits.size();
+    }
+
+    /**
+     * @brief Decodes the entities of a WORLD_STATE message.
+     *
+     * @param message The received message.
+     * @param out Filled with the entities, in ascending ID order.
+     * @param quantization The position quantization the message was encoded with.
+     * @return true if the message is a well-formed WORLD_STATE, false otherwise.
+     */
+    static bool decode(const Message& message, std::vector<WorldEntity>& out,
+                       const PositionQuantization& quantization = DEFAULT_POSITION_QUANTIZATION) {
+        if (message.type() != RFC::WORLD_STATE)
+            return false;
+        out.clear();
+        BitReader reader(message.payload);
+        std::uint32_t count = reader.readBits(16);
+        WorldEntity entity;
+        for (std::uint32_t i = 0; i < count && reader.ok(); ++i) {
+            entity.entityId = static_cast<std::int32_t>(static_cast<std::uint32_t>(entity.entityId) + reader.readVarUInt());
+            entity.entityType = static_cast<EntityType>(reader.readBits(TYPE_BITS));
+            entity.x = quantization.x.decode(reader.readBits(quantization.x.bits));
+            entity.y = quantization.y.decode(reader.readBits(quantization.y.bits));
+            out.push_back(entity);
+        }
+        return reader.ok() && reader.atEnd();
+    }
+};
+
+}  // namespace Protocol
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "Datagram.hpp"
+#include "Message.hpp"
+#include "ReliableChannel.hpp"
+#include "Snapshot.hpp"
+
+/**
+ * @class SnapshotStream
+ * @brief Receiving end of the server's UDP snapshot channel, without the socket.
+ *
+ * Each datagram carries a sequence number. A snapshot older than the newest one already
+ * delivered is useless, so late and reordered datagrams are dropped instead of being
+ * applied. Snapshots arrive either in full (STATE_UPDATE) or as a delta against one the
+ * receiver acknowledged (STATE_DELTA); both are rebuilt into a full Snapshot, recorded as
+ * a future baseline and acknowledged.
+ *
+ * Events arrive in RELIABLE packets instead, which bypass the sequence check: the
+ * ReliableChannel delivers them in order, and every packet is acknowledged right away so
+ * the server measures the round trip and resends only what was lost.
+ *
+ * The stream does no IO: the game client and the load-test bots own their sockets and
+ * hand every datagram to receive(), which gives back the datagrams to send in reply.
+ */
+class SnapshotStream {
+   public:
+    using Clock = ReliableChannel::Clock;  ///< Clock the reliable channel's timeouts are measured with.
+
+    /// Encoded control datagram: sequence prefix followed by a fixed-size message.
+    template <typename Payload>
+    using ControlDatagram = std::array<std::uint8_t, Datagram::HEADER_SIZE + Protocol::HEADER_SIZE + Payload::SIZE>;
+
+    static constexpr std::size_t PACKET_DATAGRAM_SIZE = Datagram::HEADER_SIZE + ReliableChannel::MAX_PACKET_SIZE;  ///< Size of a reliable packet datagram.
+
+    /**
+     * @brief Encodes a control datagram, such as the bind token echo.
+     *
+     * @tparam Payload A fixed-size payload type.
+     * @param payload The payload to send.
+     * @param out The datagram to fill.
+     */
+    template <typename Payload>
+    static void encodeControl(const Payload& payload, ControlDatagram<Payload>& out) {
+        Datagram::encodeHeader(0, out);
+        Message::serialize(payload, std::span(out).subspan(Datagram::HEADER_SIZE));
+    }
+
+    /**
+     * @brief Forgets every snapshot and event of the previous binding.
+     *
+     * Called whenever the socket is bound to a new session: the server starts over with full
+     * snapshots and a fresh reliable channel.
+     */
+    void reset() {
+        receivedSnapshot_ = false;
+        history_.clear();
+        reliable_ = ReliableChannel();
+    }
+
+    /**
+     * @brief Checks whether a snapshot arrived since the last reset().
+     *
+     * @return true once the server sends over the bound socket, false while it must still be bound.
+     */
+    bool isReceiving() const { return receivedSnapshot_; }
+
+    /**
+     * @brief Handles a received datagram.
+     *
+     * A RELIABLE packet has its events delivered to onEvent and is acknowledged. Any other
+     * datagram is a snapshot: if it is the newest so far and its baseline is known, it is
+     * rebuilt, recorded, acknowledged and passed to onSnapshot.
+     *
+     * @param datagram The received datagram.
+     * @param now The current time.
+     * @param packetBuffer Scratch buffer of at least PACKET_DATAGRAM_SIZE bytes acknowledgements are built into.
+     * @param onSnapshot Called with the rebuilt snapshot.
+     * @param onEvent Called with every event, in the order the server sent them.
+     * @param send Called with every datagram to send back to the server.
+     * @return true if the datagram was used, false if it was stale, malformed or undecodable.
+     */
+    template <typename OnSnapshot, typename OnEvent, typename Send>
+    bool receive(std::span<const std::uint8_t> datagram, Clock::time_point now, std::span<std::uint8_t> packetBuffer,
+                 OnSnapshot&& onSnapshot, OnEvent&& onEvent, Send&& send) {
+        std::uint32_t sequence = 0;
+        std::span<const std::uint8_t> bytes;
+        Message message;
+        if (!Datagram::decode(datagram, sequence, bytes) || !Message::deserialize(bytes, message))
+            return false;
+        if (message.type() == RFC::RELIABLE)
+            return receiveReliable(message, now, packetBuffer, onEvent, send);
+        if (receivedSnapshot_ && !Datagram::isNewer(sequence, lastSequence_))
+            return false;
+        if (!decodeSnapshot(message))
+            return false;
+        receivedSnapshot_ = true;
+        lastSequence_ = sequence;
+
+        Snapshot& recorded = history_.push(sequence);
+        recorded.states.assign(decoded_.states.begin(), decoded_.states.end());
+        recorded.inputAcks.assign(decoded_.inputAcks.begin(), decoded_.inputAcks.end());
+
+        // Not retransmitted: a lost acknowledgement only delays the server's switch to a newer baseline
+        Protocol::SnapshotAckPayload ack;
+        ack.sequence = sequence;
+        encodeControl(ack, ackDatagram_);
+        send(std::span<const std::uint8_t>(ackDatagram_));
+        onSnapshot(static_cast<const Snapshot&>(recorded));
+        return true;
+    }
+
+   private:
+    /**
+     * @brief Rebuilds the full snapshot carried by a message into decoded_.
+     *
+     * @param message A STATE_UPDATE or STATE_DELTA message.
+     * @return true if the snapshot could be rebuilt, false if the message is malformed or its baseline is unknown.
+     */
+    bool decodeSnapshot(const Message& message) {
+        if (Protocol::decodeStateUpdate(message, decoded_))
+            return true;
+
+        std::uint32_t baselineSequence = 0;
+        if (!Protocol::StateDelta::baselineOf(message, baselineSequence))
+            return false;
+        const Snapshot* baseline = history_.find(baselineSequence);
+        return baseline && Protocol::StateDelta::apply(message, *baseline, decoded_);
+    }
+
+    /**
+     * @brief Delivers the events of a reliable packet and acknowledges it.
+     *
+     * The acknowledgement is sent at once rather than with the next snapshot acknowledgement,
+     * so the round trip the server measures does not include the time until the next snapshot.
+     *
+     * @param packet The received RELIABLE message.
+     * @param now The current time.
+     * @param packetBuffer Scratch buffer of at least PACKET_DATAGRAM_SIZE bytes.
+     * @param onEvent Called with every event delivered.
+     * @param send Called with every acknowledgement datagram.
+     * @return true if the packet was well-formed, false otherwise.
+     */
+    template <typename OnEvent, typename Send>
+    bool receiveReliable(const Message& packet, Clock::time_point now, std::span<std::uint8_t> packetBuffer, OnEvent& onEvent, Send& send) {
+        if (!reliable_.receive(packet, now, [&onEvent](const Message& event) { onEvent(event); }))
+            return false;
+        Datagram::encodeHeader(0, packetBuffer);
+        std::span<std::uint8_t> out = packetBuffer.subspan(Datagram::HEADER_SIZE);
+        while (std::size_t size = reliable_.writePacket(now, out))
+            send(std::span<const std::uint8_t>(packetBuffer.data(), Datagram::HEADER_SIZE + size));
+        return true;
+    }
+
+    SnapshotHistory history_;                                    ///< Recently received snapshots, used as delta baselines.
+    Snapshot decoded_;                                           ///< Scratch snapshot the current datagram is rebuilt into.
+    ReliableChannel reliable_;                                   ///< Orders the events and acknowledges their packets.
+    ControlDatagram<Protocol::SnapshotAckPayload> ackDatagram_;  ///< Datagram acknowledging a snapshot.
+    bool receivedSnapshot_ = false;                              ///< Whether any snapshot arrived since reset().
+    std::uint32_t lastSequence_ = 0;                             ///< Sequence number of the newest delivered snapshot.
+};
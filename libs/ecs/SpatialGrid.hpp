@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class SpatialGrid
+ * @brief Uniform grid over entity positions, answering rectangle queries.
+ *
+ * The grid is rebuilt every tick from the positions of the replicated entities. Entries
+ * are sorted by cell in row-major order, so the cells of a row are contiguous and a query
+ * costs one binary search per row it overlaps, plus the entries of the cells it covers.
+ * Cells are not bounded, so the world can grow without resizing anything, and the entry
+ * vector is reused, so rebuilding does not allocate once warmed up.
+ */
+class SpatialGrid {
+   public:
+    /**
+     * @brief Constructs an empty grid.
+     *
+     * @param cellSize Side of a square cell, in world units; about the size of a query keeps both costs low.
+     */
+    explicit SpatialGrid(float cellSize) : cellSize_(cellSize) {}
+
+    /**
+     * @brief Removes every entity, keeping the storage.
+     */
+    void clear() {
+        entries_.clear();
+        built_ = true;
+    }
+
+    /**
+     * @brief Adds an entity; build() must be called before the next query.
+     *
+     * @param entityId The identifier of the entity.
+     * @param x X coordinate of the entity.
+     * @param y Y coordinate of the entity.
+     */
+    void insert(std::int32_t entityId, float x, float y) {
+        entries_.push_back({cellKey(cellOf(x), cellOf(y)), entityId, x, y});
+        built_ = false;
+    }
+
+    /**
+     * @brief Sorts the entities by cell, making the grid ready for queries.
+     */
+    void build() {
+        std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) { return a.cell < b.cell; });
+        built_ = true;
+    }
+
+    /**
+     * @brief Calls a function for every entity inside a rectangle, bounds included.
+     *
+     * @tparam Function Callable taking (std::int32_t entityId, float x, float y).
+     * @param minX Left edge of the rectangle.
+     * @param minY Top edge of the rectangle.
+     * @param maxX Right edge of the rectangle.
+     * @param maxY Bottom edge of the rectangle.
+     * @param function The function called for each entity found.
+     */
+    template <typename Function>
+    void query(float minX, float minY, float maxX, float maxY, Function&& function) const {
+        if (!built_ || minX > maxX || minY > maxY)
+            return;
+        std::int32_t firstColumn = cellOf(minX);
+        std::int32_t lastColumn = cellOf(maxX);
+        for (std::int64_t row = cellOf(minY), lastRow = cellOf(maxY); row <= lastRow; ++row) {
+            std::uint64_t first = cellKey(firstColumn, static_cast<std::int32_t>(row));
+            std::uint64_t last = cellKey(lastColumn, static_cast<std::int32_t>(row));
+            auto it = std::lower_bound(entries_.begin(), entries_.end(), first,
+                                       [](const Entry& entry, std::uint64_t key) { return entry.cell < key; });
+            for (; it != entries_.end() && it->cell <= last; ++it) {
+                if (it->x >= minX && it->x <= maxX && it->y >= minY && it->y <= maxY)
+                    function(it->entityId, it->x, it->y);
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of entities in the grid.
+     *
+     * @return std::size_t The entity count.
+     */
+    std::size_t size() const { return entries_.size(); }
+
+   private:
+    /**
+     * @struct Entry
+     * @brief An entity and the cell it lies in.
+     */
+    struct Entry {
+        std::uint64_t cell;     ///< Row-major key of the cell.
+        std::int32_t entityId;  ///< Identifier of the entity.
+        float x;                ///< X coordinate of the entity.
+        float y;                ///< Y coordinate of the entity.
+    };
+
+    /**
+     * @brief Gets the cell coordinate containing a world coordinate.
+     *
+     * @param coordinate The world coordinate.
+     * @return std::int32_t The cell coordinate, saturated to the range of a cell index.
+     */
+    std::int32_t cellOf(float coordinate) const {
+        double cell = std::floor(static_cast<double>(coordinate) / cellSize_);
+        if (std::isnan(cell))
+            return 0;
+        return static_cast<std::int32_t>(std::clamp(cell, static_cast<double>(INT32_MIN), static_cast<double>(INT32_MAX)));
+    }
+
+    /**
+     * @brief Gets the key of a cell, ordered by row then column.
+     *
+     * @param column The cell column.
+     * @param row The cell row.
+     * @return std::uint64_t The key; offsetting both halves keeps negative cells in order.
+     */
+    static std::uint64_t cellKey(std::int32_t column, std::int32_t row) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(row) ^ 0x80000000u) << 32) | (static_cast<std::uint32_t>(column) ^ 0x80000000u);
+    }
+
+    float cellSize_;              ///< Side of a cell, in world units.
+    std::vector<Entry> entries_;  ///< Entities, sorted by cell once built.
+    bool built_ = true;           ///< Whether entries_ is sorted.
+};
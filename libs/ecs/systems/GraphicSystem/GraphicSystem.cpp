@@ -135,6 +135,19 @@ void GraphicSystem::removeEntity(int entityId) {
     animationArray.removeComponent(index);
 }
 
+/**
+ * @brief Moves an entity off-screen, where the factory places new entities.
+ *
+ * @param entityId The ID of the entity to hide.
+ */
+void GraphicSystem::hideEntity(int entityId) {
+    SparseArray<PosComponent>& posArray = cm.getSparseArray<PosComponent>();
+    int eId = em.getIndex(entityId);
+
+    if (eId > -1 && posArray[eId])
+        posArray[eId]->coord = Utils::Vec2(-100, -100);
+}
+
 /**
  * @brief Factory method to create and initialize game entities.
  *
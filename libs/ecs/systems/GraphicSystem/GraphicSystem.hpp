@@ -63,6 +63,16 @@ class GraphicSystem {
      */
     void removeEntity(int entityId);
 
+    /**
+     * @brief Moves an entity off-screen until its position is set again.
+     *
+     * Used for entities that still exist but left the view, so they can reappear without
+     * being created again.
+     *
+     * @param entityId The ID of the entity to hide.
+     */
+    void hideEntity(int entityId);
+
     /**
      * @brief Refreshes the game graphics, updating sprites, positions, and animations.
      */
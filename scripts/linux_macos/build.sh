@@ -4,7 +4,7 @@ cmake -B build -S .
 cmake --build build
 
 if [ $? -eq 0 ]; then
-    mv build/server/r-type_server . && mv build/client/r-type_client .
+    mv build/server/r-type_server . && mv build/client/r-type_client . && mv build/bot/r-type_bot .
     echo "Build completed successfully."
 else
     echo "Build failed."
@@ -21,4 +21,9 @@ if [ -f "r-type_server" ]; then
     echo "Removed r-type_server executable."
 fi
 
+if [ -f "r-type_bot" ]; then
+    rm r-type_bot
+    echo "Removed r-type_bot executable."
+fi
+
 echo "Clean completed."
@@ -1,6 +1,6 @@
 #!/bin/sh
 
-DIRECTORIES="server client libs common"
+DIRECTORIES="server client bot libs common tests"
 
 PATTERNS="*.cpp *.hpp"
 
@@ -10,6 +10,7 @@ cmake --build build
 IF %ERRORLEVEL% EQU 0 (
     move build\server\Debug\r-type_server.exe .
     move build\client\Debug\r-type_client.exe .
+    move build\bot\Debug\r-type_bot.exe .
     echo Build completed successfully.
 ) ELSE (
     echo Build failed.
@@ -21,6 +21,11 @@ IF EXIST r-type_server.exe (
     ECHO Removed r-type_server executable.
 )
 
+IF EXIST r-type_bot.exe (
+    DEL /F /Q r-type_bot.exe
+    ECHO Removed r-type_bot executable.
+)
+
 ECHO Clean completed.
 
 ENDLOCAL
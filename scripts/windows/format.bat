@@ -1,7 +1,7 @@
 @ECHO OFF
 SETLOCAL
 
-SET DIRECTORIES=server client libs common tests
+SET DIRECTORIES=server client bot libs common tests
 SET PATTERNS=*.cpp *.hpp
 
 ECHO Running clang-format...
@@ -1,4 +1,6 @@
 #include "MainServer.hpp"
+#include <algorithm>
+#include <iostream>
 #include "CommonDefs.hpp"
 #include "ErrorHandler.hpp"
 
@@ -6,21 +8,60 @@
  * @brief Starts the main server.
  *
  * This method initializes and starts the server using ASIO for handling network
- * communications. It runs the server on a separate thread and handles any exceptions
- * that occur during the server's execution.
+ * communications. The IO context is run by a pool of threads, so reads and writes of
+ * different clients proceed in parallel; each client session serializes its own handlers
+ * on a strand. Matches are ticked by the server's own worker pool. It handles any
+ * exceptions that occur during the server's execution.
  *
+ * When network conditions are given, a network simulator listens on the public port and
+ * forwards every client, impaired, to the server listening on SIMULATED_SERVER_PORT, at
+ * the address the server's acceptor is actually bound to.
+ *
+ * @param maxPlayers The number of players required for a match to start.
+ * @param ioThreads The number of IO threads; 0 starts one per hardware thread.
+ * @param matchWorkers The number of threads ticking matches; 0 starts one per hardware thread.
+ * @param conditions The impairments to apply to every client's traffic, if any.
+ * @param spectatorDelay How far behind their match spectators are.
  * @return int Returns SUCCESS (0) if the server runs and stops without errors,
  *             and a non-zero error code if an exception occurs.
  */
-int MainServer::start(int maxPlayers) noexcept {
+int MainServer::start(int maxPlayers, unsigned ioThreads, unsigned matchWorkers, const std::optional<NetworkConditions>& conditions,
+                      std::chrono::milliseconds spectatorDelay) noexcept {
     try {
-        asio::io_context io_context;
-        Server server(io_context, GameUtilities::SERVER_PORT, maxPlayers);
-        std::thread serverThread([&io_context]() { io_context.run(); });
+        unsigned threadCount = resolveIoThreads(ioThreads);
+        asio::io_context io_context(static_cast<int>(threadCount));
+        int port = conditions ? GameUtilities::SIMULATED_SERVER_PORT : GameUtilities::SERVER_PORT;
+        Server server(io_context, port, maxPlayers, matchWorkers, spectatorDelay);
+        std::unique_ptr<NetworkSimulator> simulator;
+        if (conditions) {
+            asio::ip::tcp::endpoint listen(asio::ip::tcp::v4(), GameUtilities::SERVER_PORT);
+            asio::ip::tcp::endpoint target = server.getLocalEndpoint();
+            simulator = std::make_unique<NetworkSimulator>(listen, target.address().to_string(), std::to_string(target.port()), *conditions);
+        }
+        std::vector<std::thread> ioPool;
+        ioPool.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; i++) {
+            ioPool.emplace_back([&io_context]() { io_context.run(); });
+        }
+        std::cout << "Network IO running on " << threadCount << " thread(s)." << std::endl;
         server.run();
-        serverThread.join();
+        for (std::thread& ioThread : ioPool) {
+            ioThread.join();
+        }
     } catch (std::exception& e) {
         ErrorHandler::handle(e);
     }
     return SUCCESS;
 }
+
+/**
+ * @brief Resolves the number of IO threads to start.
+ *
+ * @param requested The requested number of IO threads; 0 for one per hardware thread.
+ * @return unsigned The number of IO threads, at least 1.
+ */
+unsigned MainServer::resolveIoThreads(unsigned requested) {
+    if (requested > 0)
+        return requested;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
@@ -1,7 +1,12 @@
 #pragma once
 #include <asio.hpp>
+#include <chrono>
+#include <memory>
+#include <optional>
 #include <thread>
+#include <vector>
 #include "../game/Server.hpp"
+#include "NetworkSimulator.hpp"
 
 /**
  * @class MainServer
@@ -15,12 +20,30 @@ class MainServer {
     /**
      * @brief Starts the server.
      *
-     * Initializes the necessary components for the server and starts it. This function handles
-     * the server's network communications and runs the server in a separate thread.
+     * Initializes the necessary components for the server and starts it. Network
+     * communications run on a pool of IO threads sharing one IO context, while the
+     * matches are ticked by a separate pool of workers. With network conditions, the server
+     * listens on SIMULATED_SERVER_PORT behind a network simulator that takes SERVER_PORT.
      *
+     * @param maxPlayers The number of players required for a match to start.
+     * @param ioThreads The number of IO threads; 0 starts one per hardware thread.
+     * @param matchWorkers The number of threads ticking matches; 0 starts one per hardware thread.
+     * @param conditions The impairments to apply to every client's traffic, if any.
+     * @param spectatorDelay How far behind their match spectators are.
      * @return int Returns an integer indicating the success or failure of the server startup.
      *             SUCCESS (0) is returned if the server starts and runs correctly,
      *             while a non-zero value indicates an error.
      */
-    int start(int maxPlayers) noexcept;
+    int start(int maxPlayers, unsigned ioThreads = GameUtilities::IO_THREADS, unsigned matchWorkers = GameUtilities::MATCH_WORKERS,
+              const std::optional<NetworkConditions>& conditions = std::nullopt,
+              std::chrono::milliseconds spectatorDelay = std::chrono::milliseconds(GameUtilities::SPECTATOR_DELAY_MS)) noexcept;
+
+   private:
+    /**
+     * @brief Resolves the number of IO threads to start.
+     *
+     * @param requested The requested number of IO threads; 0 for one per hardware thread.
+     * @return unsigned The number of IO threads, at least 1.
+     */
+    static unsigned resolveIoThreads(unsigned requested);
 };
@@ -0,0 +1,123 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "SpatialGrid.hpp"
+
+/**
+ * @struct ViewRect
+ * @brief Region of the world a client is told about, centered on its player.
+ */
+struct ViewRect {
+    float halfWidth;   ///< Horizontal distance from the center to the edge of the view.
+    float halfHeight;  ///< Vertical distance from the center to the edge of the view.
+    float margin;      ///< Extra distance an entity must travel past the edge before leaving the view.
+};
+
+/**
+ * @class AreaOfInterest
+ * @brief The set of entities replicated to one client.
+ *
+ * Every tick, the set is recomputed from the spatial grid around the client's player: an
+ * entity enters once it is inside the view rectangle, and leaves once it is outside the
+ * rectangle grown by the margin, so an entity moving along the edge does not flicker in
+ * and out. The caller is told which entities entered and left, to spawn and despawn them
+ * on the client, so the data sent to a client depends on what it sees rather than on the
+ * size of the world.
+ */
+class AreaOfInterest {
+   public:
+    /**
+     * @brief Constructs an empty area of interest.
+     *
+     * @param view The view rectangle of the client.
+     */
+    explicit AreaOfInterest(const ViewRect& view) : view_(view) {}
+
+    /**
+     * @brief Recomputes the set around a center and reports the changes.
+     *
+     * @tparam Enter Callable taking the std::int32_t ID of an entity that entered the set.
+     * @tparam Leave Callable taking the std::int32_t ID of an entity that left the set.
+     * @param grid The spatial grid of the tick, built.
+     * @param centerX X coordinate of the center of the view.
+     * @param centerY Y coordinate of the center of the view.
+     * @param onEnter Called for each entity that entered the set, in ID order.
+     * @param onLeave Called for each entity that left the set, in ID order.
+     */
+    template <typename Enter, typename Leave>
+    void update(const SpatialGrid& grid, float centerX, float centerY, Enter&& onEnter, Leave&& onLeave) {
+        float halfWidth = view_.halfWidth + view_.margin;
+        float halfHeight = view_.halfHeight + view_.margin;
+        next_.clear();
+        auto collect = [&](std::int32_t entityId, float x, float y) {
+            if ((std::abs(x - centerX) <= view_.halfWidth && std::abs(y - centerY) <= view_.halfHeight) || contains(entityId))
+                next_.push_back(entityId);
+        };
+        grid.query(centerX - halfWidth, centerY - halfHeight, centerX + halfWidth, centerY + halfHeight, collect);
+        std::sort(next_.begin(), next_.end());
+
+        auto current = entities_.begin();
+        auto next = next_.begin();
+        while (current != entities_.end() || next != next_.end()) {
+            if (next == next_.end() || (current != entities_.end() && *current < *next)) {
+                onLeave(*current++);
+            } else if (current == entities_.end() || *next < *current) {
+                onEnter(*next++);
+            } else {
+                ++current;
+                ++next;
+            }
+        }
+        entities_.swap(next_);
+    }
+
+    /**
+     * @brief Checks whether an entity is in the set.
+     *
+     * @param entityId The identifier of the entity.
+     * @return true if the client was told about the entity, false otherwise.
+     */
+    bool contains(std::int32_t entityId) const { return std::binary_search(entities_.begin(), entities_.end(), entityId); }
+
+    /**
+     * @brief Removes an entity that no longer exists from the set, without reporting it.
+     *
+     * @param entityId The identifier of the entity.
+     * @return true if the entity was in the set, false otherwise.
+     */
+    bool erase(std::int32_t entityId) {
+        auto it = std::lower_bound(entities_.begin(), entities_.end(), entityId);
+        if (it == entities_.end() || *it != entityId)
+            return false;
+        entities_.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Gets the entities in the set.
+     *
+     * @return const std::vector<std::int32_t>& The entity IDs, sorted.
+     */
+    const std::vector<std::int32_t>& getEntities() const { return entities_; }
+
+    /**
+     * @brief Gets the view rectangle of the client.
+     *
+     * @return const ViewRect& The view rectangle.
+     */
+    const ViewRect& getView() const { return view_; }
+
+    /**
+     * @brief Changes the view rectangle of the client; takes effect on the next update.
+     *
+     * @param view The view rectangle.
+     */
+    void setView(const ViewRect& view) { view_ = view; }
+
+   private:
+    ViewRect view_;                       ///< View rectangle of the client.
+    std::vector<std::int32_t> entities_;  ///< Entities in the set, sorted.
+    std::vector<std::int32_t> next_;      ///< Scratch set of the update in progress.
+};
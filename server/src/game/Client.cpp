@@ -9,8 +9,36 @@
  * @param clientId The unique identifier for this client.
  */
 Client::Client(asio::io_context& io_context, int clientId)
-    : id(clientId), socket(io_context), outgoingMessages(), received_message(), timer(io_context) {
-    receiveBuffer.resize(1024);
+    : id(clientId), strand(asio::make_strand(io_context)), socket(strand), outgoingMessages(), timer(strand) {}
+
+/**
+ * @brief Wakes the strand up to drain the outgoing command queue, unless it is already due to.
+ */
+void Client::scheduleDrain() {
+    if (!drainScheduled.exchange(true, std::memory_order_acq_rel))
+        asio::post(strand, [self = shared_from_this()]() { self->drainCommands(); });
+}
+
+/**
+ * @brief Moves the queued outgoing commands into the strand's send queue, then writes it.
+ *
+ * A snapshot command replaces the pending snapshot, which is then counted as dropped.
+ */
+void Client::drainCommands() {
+    drainScheduled.store(false, std::memory_order_release);  // Cleared first, so a later push schedules another drain
+    OutgoingCommand command;
+    while (outgoingCommands.tryPop(command)) {
+        if (command.type == OutgoingCommand::SNAPSHOT) {
+            if (pendingSnapshot) {
+                queuedBytes -= pendingSnapshot->size();
+                ++droppedSnapshots;
+            }
+            pendingSnapshot = std::move(command.message);
+        } else {
+            outgoingMessages.push_back(std::move(command.message));
+        }
+    }
+    writeMessages();
 }
 
 /**
@@ -19,49 +47,239 @@ Client::Client(asio::io_context& io_context, int clientId)
 Client::~Client() {}
 
 /**
- * @brief Sends a message to the server.
+ * @brief Sends an encoded message to the client.
  *
- * Serializes and queues a message for sending. It triggers the write operation
- * if there are no ongoing write operations.
+ * Queues a copy of the encoded message for sending.
  * 
- * @param msg The message to send.
- */
-void Client::send(const Message& msg) {
-    std::string serializedMessage = msg.serialize();
-    bool isWriting = !outgoingMessages.empty();
-    outgoingMessages.push_back(serializedMessage);
-    if (!isWriting) {
-        writeMessages();
+ * @param data The encoded message to send.
+ */
+void Client::send(std::span<const std::uint8_t> data) {
+    send(makeSharedBuffer(data));
+}
+
+/**
+ * @brief Sends a shared encoded message to the client.
+ *
+ * Pushes the pointer on the outgoing command queue. Unless the client flushes per tick,
+ * it wakes the strand up to write it. A reliable message cannot be dropped, so a full
+ * command queue disconnects the client like a full send queue does.
+ * 
+ * @param message The shared encoded message.
+ */
+void Client::send(SharedBuffer message) {
+    std::size_t size = message->size();
+    std::size_t queued = queuedBytes.fetch_add(size) + size;
+    if (queued > disconnectBytes.load(std::memory_order_relaxed) || !outgoingCommands.tryPush({OutgoingCommand::MESSAGE, std::move(message)})) {
+        queuedBytes -= size;
+        std::cerr << "Client " << id << " send queue overflowed, disconnecting." << std::endl;
+        disconnect();
+        return;
+    }
+    if (!flushPerTick.load(std::memory_order_relaxed)) {
+        scheduleDrain();
     }
 }
 
+/**
+ * @brief Sends a state snapshot to the client, replacing any unsent older one.
+ *
+ * While the send queue is above the throttle mark, or the command queue is full, the
+ * snapshot is dropped instead so the pending reliable messages drain first. The strand
+ * replaces the older unsent snapshot when it drains the command.
+ *
+ * @param snapshot The shared encoded snapshot.
+ */
+void Client::sendSnapshot(SharedBuffer snapshot) {
+    if (queuedBytes.load() >= throttleBytes.load(std::memory_order_relaxed)) {
+        ++droppedSnapshots;
+        return;
+    }
+    std::size_t size = snapshot->size();
+    queuedBytes += size;
+    if (!outgoingCommands.tryPush({OutgoingCommand::SNAPSHOT, std::move(snapshot)})) {
+        queuedBytes -= size;
+        ++droppedSnapshots;
+        return;
+    }
+    if (!flushPerTick.load(std::memory_order_relaxed)) {
+        scheduleDrain();
+    }
+}
+
+/**
+ * @brief Writes every queued message in a single gathered write.
+ */
+void Client::flush() {
+    flushRequested = true;
+    scheduleDrain();
+}
+
+/**
+ * @brief Sets the send queue sizes at which snapshots are dropped and the client is disconnected.
+ *
+ * @param throttle Queued bytes from which new snapshots are dropped.
+ * @param disconnect Queued bytes from which the client is disconnected.
+ */
+void Client::setSendQueueLimits(std::size_t throttle, std::size_t disconnect) {
+    throttleBytes = throttle;
+    disconnectBytes = disconnect;
+}
+
+/**
+ * @brief Gets the number of bytes queued or being written.
+ *
+ * @return std::size_t The send queue size in bytes.
+ */
+std::size_t Client::getQueuedBytes() {
+    return queuedBytes;
+}
+
+/**
+ * @brief Gets the number of snapshots that were replaced or dropped before being written.
+ *
+ * @return std::uint64_t The dropped snapshot count.
+ */
+std::uint64_t Client::getDroppedSnapshots() {
+    return droppedSnapshots;
+}
+
+/**
+ * @brief Selects whether queued messages wait for flush() before being written.
+ *
+ * @param perTick true to write only on flush(), false to write as soon as a message is sent.
+ */
+void Client::setFlushPerTick(bool perTick) {
+    flushPerTick = perTick;
+}
+
 /**
  * @brief Starts an asynchronous read operation to receive messages from the server.
+ *
+ * The read and its completion run on the session's strand; the frame assembler is only
+ * accessed there.
  */
 void Client::startRead() {
-    std::lock_guard<std::mutex> lock(socket_mutex);
+    if (!strand.running_in_this_thread()) {
+        asio::post(strand, [self = shared_from_this()]() { self->startRead(); });
+        return;
+    }
     if (!socket.is_open())
         return;  // Prevent reading from a closed socket
 
-    socket.async_read_some(asio::buffer(receiveBuffer), [this](std::error_code ec, std::size_t length) {
+    std::span<std::uint8_t> space = receiveFrames.prepare();
+    socket.async_read_some(asio::buffer(space.data(), space.size()), [this, self = shared_from_this()](std::error_code ec, std::size_t length) {
         if (!ec) {
-            std::string receivedData(receiveBuffer.begin(), receiveBuffer.begin() + length);
-            Message receivedMessage = Message::deserialize(receivedData);
-            received_messages.push_back(receivedMessage);
+            receiveFrames.commit(length);
+            bool allowed = true;
+            bool wellFormed = receiveFrames.consume([this, &allowed](const Message& receivedMessage) {
+                if (allowed)
+                    allowed = handleMessage(receivedMessage);
+            });
+            if (!wellFormed || !allowed) {
+                std::cerr << "Client " << id << " sent a malformed or unexpected message, disconnecting." << std::endl;
+                disconnect();
+                return;
+            }
             startRead();
         } else if (ec != asio::error::operation_aborted) {
-            // Handle the error accordingly
-            std::cerr << "Read failed: " << ec.message() << std::endl;
+            std::cerr << "Client " << id << " read failed: " << ec.message() << std::endl;
+            disconnect();
         }
     });
 }
 
+/**
+ * @brief Starts reading from the client, which must open the session with HELLO or RESUME.
+ *
+ * The timer and the read are started on the strand, where the handshake state lives.
+ *
+ * @param timeout How long the client has to send HELLO or RESUME.
+ * @param helloHandler Called on the strand with the client's HELLO.
+ * @param resumeHandler Called on the strand with the client's RESUME.
+ */
+void Client::startHandshake(std::chrono::milliseconds timeout, HelloHandler helloHandler, ResumeHandler resumeHandler) {
+    this->helloHandler = std::move(helloHandler);
+    this->resumeHandler = std::move(resumeHandler);
+    asio::post(strand, [self = shared_from_this(), timeout]() {
+        self->timer.expires_after(timeout);
+        self->timer.async_wait([self](std::error_code ec) {
+            if (!ec && !self->greeted) {
+                std::cerr << "Client " << self->id << " sent no HELLO in time, disconnecting." << std::endl;
+                self->disconnect();
+            }
+        });
+        self->startRead();
+    });
+}
+
+/**
+ * @brief Handles a message received from the client.
+ *
+ * The first message must be HELLO or RESUME; it is handed to the matching handler once,
+ * and both handlers are then released so they cannot keep anything alive. Later messages
+ * carry inputs.
+ *
+ * @param message The message.
+ * @return true if the message is allowed at this point of the session, false otherwise.
+ */
+bool Client::handleMessage(const Message& message) {
+    if (!greeted) {
+        Protocol::HelloPayload hello;
+        Protocol::ResumePayload resume;
+        bool isHello = message.decode(hello);
+        if (!isHello && !message.decode(resume))
+            return false;
+        greeted = true;
+        timer.cancel();
+        HelloHandler onHello = std::move(helloHandler);
+        ResumeHandler onResume = std::move(resumeHandler);
+        helloHandler = nullptr;
+        resumeHandler = nullptr;
+        if (isHello && onHello)
+            onHello(shared_from_this(), hello);
+        else if (!isHello && onResume)
+            onResume(shared_from_this(), resume);
+        return true;
+    }
+    Protocol::InputPayload input;
+    if (message.decode(input))
+        receivedInputs.push(input);  // Full only if the match stalled: the newest input is dropped
+    return true;
+}
+
+/**
+ * @brief Records the settings negotiated for the session.
+ *
+ * @param negotiated The WELCOME sent to the client.
+ */
+void Client::setSession(const Protocol::WelcomePayload& negotiated) {
+    session = negotiated;
+}
+
+/**
+ * @brief Gets the settings negotiated for the session.
+ *
+ * Set on the strand before the client is placed in a match; the match reads it after
+ * taking the join lock, so no further synchronization is needed.
+ *
+ * @return const Protocol::WelcomePayload& The WELCOME sent to the client.
+ */
+const Protocol::WelcomePayload& Client::getSession() const {
+    return session;
+}
+
 /**
  * @brief Disconnects the client from the server.
  * 
- * Closes the socket and cancels all pending asynchronous operations.
+ * Closes the socket and cancels all pending asynchronous operations. Called off the strand,
+ * the disconnection is scheduled on the strand, after the operations already posted there.
  */
 void Client::disconnect() {
+    if (!strand.running_in_this_thread()) {
+        asio::post(strand, [self = shared_from_this()]() { self->disconnect(); });
+        return;
+    }
+    closed = true;
     asio::error_code ec;
     socket.cancel(ec);  // Cancel all asynchronous operations
     if (ec) {
@@ -81,55 +299,86 @@ void Client::disconnect() {
     }
 }
 
+/**
+ * @brief Checks whether the connection is gone.
+ *
+ * @return true if the connection is closed, false otherwise.
+ */
+bool Client::isClosed() const {
+    return closed;
+}
+
+/**
+ * @brief Writes every queued message, then disconnects the client.
+ *
+ * The disconnection happens on the strand once the queue is empty, after the write in
+ * progress and the one carrying the queued messages complete.
+ */
+void Client::disconnectAfterFlush() {
+    closing = true;
+    scheduleDrain();
+}
+
 /**
  * @brief Writes all messages in the outgoing queue to the server.
  * 
- * Uses asynchronous write operations to send the messages.
+ * Every queued message is moved into a single asynchronous write over a buffer
+ * sequence, so the whole queue leaves in one writev instead of one write and one
+ * completion handler per message. The pending snapshot goes last, after the events
+ * (such as new entities) it may depend on. Messages queued meanwhile are written once
+ * it completes, or on the next flush() when the client flushes per tick.
+ *
+ * Only runs on the session's strand, which owns the send queue, so the socket is never
+ * used by two IO threads at once and no lock is taken.
  */
 void Client::writeMessages() {
-    std::lock_guard<std::mutex> lock(socket_mutex);
-    if (outgoingMessages.empty() || !socket.is_open())
+    if (writing)
         return;
+    flushRequested = false;
+    if ((outgoingMessages.empty() && !pendingSnapshot) || !socket.is_open()) {
+        if (closing && socket.is_open())
+            disconnect();
+        return;
+    }
 
-    auto& serializedMsg = outgoingMessages.front();
-    asio::async_write(socket, asio::buffer(serializedMsg), [this](std::error_code ec, std::size_t /* length */) {
+    writing = true;
+    writingMessages.swap(outgoingMessages);  // Both keep their capacity, so the steady state does not allocate
+    if (pendingSnapshot) {
+        writingMessages.push_back(std::move(pendingSnapshot));
+        pendingSnapshot.reset();
+    }
+    gatherBuffers.clear();
+    for (const SharedBuffer& serializedMsg : writingMessages) {
+        gatherBuffers.push_back(asio::buffer(serializedMsg->data(), serializedMsg->size()));
+    }
+    asio::async_write(socket, gatherBuffers, [this, self = shared_from_this()](std::error_code ec, std::size_t /* length */) {
         if (!ec) {
-            outgoingMessages.pop_front();
-            if (!outgoingMessages.empty()) {
+            for (const SharedBuffer& serializedMsg : writingMessages) {
+                queuedBytes -= serializedMsg->size();
+            }
+            writingMessages.clear();
+            writing = false;
+            if (!flushPerTick || flushRequested || closing) {
                 writeMessages();
             }
         } else {
             std::cerr << "Write failed: " << ec.message() << std::endl;
-            socket.close();
+            disconnect();
         }
     });
 }
 
 /**
- * @brief Checks if there are received messages pending processing.
- * 
- * @return true if there are messages, false otherwise.
- */
-bool Client::hasReceivedMessages() const {
-    if (received_messages.size() == 0) {
-        return false;
-    }
-
-    return !received_messages.empty();
-}
-
-/**
- * @brief Retrieves the next message from the received messages queue.
+ * @brief Retrieves the input to apply for the current tick.
  * 
- * @return Message The next message if available, or an empty message if not.
+ * Inputs beyond InputQueue::MAX_BACKLOG are skipped, oldest first, to bound the input
+ * latency after a stall.
+ *
+ * @param input Filled with the oldest queued input, or a repeat of the previous one standing in for a late one.
+ * @return true if an input was retrieved, false if the client never sent one.
  */
-Message Client::getNextMessage() {
-    if (!received_messages.empty()) {
-        Message msg = received_messages.front();
-        received_messages.pop_front();
-        return msg;
-    }
-    return Message();
+bool Client::getNextInput(Protocol::InputPayload& input) {
+    return receivedInputs.next(input);
 }
 
 /**
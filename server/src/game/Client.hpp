@@ -1,9 +1,17 @@
 #pragma once
 #include <asio.hpp>
-#include <deque>
-#include <mutex>
-#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+#include "../../libs/ecs/FrameAssembler.hpp"
+#include "../../libs/ecs/InputQueue.hpp"
 #include "../../libs/ecs/Message.hpp"
+#include "../../libs/ecs/RingQueue.hpp"
+#include "../../libs/ecs/SharedBuffer.hpp"
 
 /**
  * @class Client
@@ -12,9 +20,24 @@
  * This class encapsulates the functionality necessary for a client to communicate
  * with a server, including sending messages, receiving messages, and handling network
  * connections and disconnections.
+ *
+ * The IO context may be run by several threads. Every handler of a session runs on the
+ * session's strand, so a session's reads and writes never run concurrently while different
+ * sessions proceed in parallel. Public methods may be called from any thread: those that
+ * touch the socket hop onto the strand. Pending handlers hold a reference to the session,
+ * so it may be released by its owner at any time.
+ *
+ * The session and the game loop exchange typed commands over lock-free rings, one per
+ * direction, so no mutex is taken on the tick path: the strand pushes decoded inputs on
+ * an SPSC ring the match pops once per tick, and any thread pushes outgoing messages and
+ * snapshots on an MPSC ring the strand drains into its send queue. Everything past the
+ * rings is owned by the strand.
  */
-class Client {
+class Client : public std::enable_shared_from_this<Client> {
    public:
+    using HelloHandler = std::function<void(const std::shared_ptr<Client>&, const Protocol::HelloPayload&)>;    ///< Answers a client's HELLO.
+    using ResumeHandler = std::function<void(const std::shared_ptr<Client>&, const Protocol::ResumePayload&)>;  ///< Answers a client's RESUME.
+
     /**
      * @brief Constructs a new Client object.
      *
@@ -33,21 +56,111 @@ class Client {
     ~Client();
 
     /**
-     * @brief Sends a message to the server.
+     * @brief Sends an encoded message to the client.
+     *
+     * Copies the encoded bytes into a new shared buffer. Messages sent to several clients
+     * should be wrapped once and sent with the SharedBuffer overload instead.
+     * 
+     * @param data The encoded message, as produced by Message::serialize or Protocol::StateUpdateWriter.
+     */
+    void send(std::span<const std::uint8_t> data);
+
+    /**
+     * @brief Sends a shared encoded message to the client.
+     *
+     * Only the pointer is queued; the bytes stay alive until they have been written. In
+     * per-tick mode, the message waits for the next flush().
+     * 
+     * @param message The shared encoded message.
+     */
+    void send(SharedBuffer message);
+
+    /**
+     * @brief Sends a state snapshot to the client, replacing any unsent older one.
      *
-     * Serializes the message and queues it for sending to the server.
+     * Snapshots supersede each other, so at most one waits in the queue. Unlike other
+     * messages, snapshots are dropped while the queue is above the throttle mark.
      * 
-     * @param msg The message to be sent.
+     * @param snapshot The shared encoded snapshot.
+     */
+    void sendSnapshot(SharedBuffer snapshot);
+
+    /**
+     * @brief Sets the send queue high-water marks.
+     *
+     * Above the throttle mark, new snapshots are dropped until the queue drains. Above the
+     * disconnect mark, which only reliable messages can reach, the client is disconnected.
+     *
+     * @param throttle Queued bytes from which new snapshots are dropped.
+     * @param disconnect Queued bytes from which the client is disconnected.
      */
-    void send(const Message& msg);
+    void setSendQueueLimits(std::size_t throttle, std::size_t disconnect);
 
     /**
-     * @brief Starts asynchronous reading from the server.
+     * @brief Gets the number of bytes queued or being written.
      *
-     * Initiates the process to continuously read messages from the server.
+     * @return std::size_t The send queue size in bytes.
+     */
+    std::size_t getQueuedBytes();
+
+    /**
+     * @brief Gets the number of snapshots that were replaced or dropped before being written.
+     *
+     * @return std::uint64_t The dropped snapshot count.
+     */
+    std::uint64_t getDroppedSnapshots();
+
+    /**
+     * @brief Writes every queued message in a single gathered write.
+     *
+     * If a write is already in progress, the queued messages follow as soon as it completes.
+     */
+    void flush();
+
+    /**
+     * @brief Selects when queued messages are written.
+     *
+     * @param perTick true to write only on flush(), so all messages of a tick leave together;
+     *                false to start writing as soon as a message is sent.
+     */
+    void setFlushPerTick(bool perTick);
+
+    /**
+     * @brief Starts asynchronous reading from the client.
+     *
+     * Initiates the process to continuously read messages from the client. Each read may
+     * carry several messages or only part of one; complete messages are extracted by the
+     * session's frame assembler.
      */
     void startRead();
 
+    /**
+     * @brief Starts reading from the client, which must open the session with HELLO or RESUME.
+     *
+     * Any other first message, or none within the timeout, disconnects the client.
+     *
+     * @param timeout How long the client has to send HELLO or RESUME.
+     * @param helloHandler Called on the strand with the client's HELLO; answers it with WELCOME.
+     * @param resumeHandler Called on the strand with the client's RESUME; hands it to its session.
+     */
+    void startHandshake(std::chrono::milliseconds timeout, HelloHandler helloHandler, ResumeHandler resumeHandler);
+
+    /**
+     * @brief Records the settings negotiated for the session.
+     *
+     * Called by the HELLO handler, before the client is placed in a match.
+     *
+     * @param negotiated The WELCOME sent to the client.
+     */
+    void setSession(const Protocol::WelcomePayload& negotiated);
+
+    /**
+     * @brief Gets the settings negotiated for the session.
+     *
+     * @return const Protocol::WelcomePayload& The WELCOME sent to the client.
+     */
+    const Protocol::WelcomePayload& getSession() const;
+
     /**
      * @brief Disconnects the client from the server.
      *
@@ -56,20 +169,34 @@ class Client {
     void disconnect();
 
     /**
-     * @brief Checks if there are any messages received from the server that have not been processed.
-     * 
-     * @return true if there are unprocessed messages, false otherwise.
+     * @brief Checks whether the connection is gone.
+     *
+     * Set once the client disconnected, the peer closed the connection or a read or write
+     * failed; matches poll it every tick to suspend the player until it resumes.
+     *
+     * @return true if the connection is closed, false otherwise.
+     */
+    bool isClosed() const;
+
+    /**
+     * @brief Writes every queued message, then disconnects the client.
+     *
+     * Used to end a session with a final message (such as GAME_OVER) without racing the
+     * disconnection against the write carrying it.
      */
-    bool hasReceivedMessages() const;
+    void disconnectAfterFlush();
 
     /**
-     * @brief Retrieves the next received message.
+     * @brief Retrieves the input to apply for the current tick.
      *
-     * If there are any messages in the queue, returns the next one and removes it from the queue.
+     * Takes the oldest received input off the queue. If none arrived in time, the last
+     * one is repeated in place of the missing one, since the keys it describes are most
+     * likely still held (see InputQueue).
      * 
-     * @return Message The next message, or an empty message if the queue is empty.
+     * @param input Filled with the input to apply.
+     * @return true if an input was retrieved, false if the client never sent one.
      */
-    Message getNextMessage();
+    bool getNextInput(Protocol::InputPayload& input);
 
     /**
      * @brief Gets the client's unique identifier.
@@ -86,19 +213,79 @@ class Client {
     asio::ip::tcp::socket& getSocket();
 
    private:
-    int id;                                    ///< Unique identifier for the client.
-    asio::ip::tcp::socket socket;              ///< Socket for network communication.
-    std::deque<std::string> outgoingMessages;  ///< Queue of messages to be sent to the server.
-    Message received_message;                  ///< A single message received from the server (for immediate processing).
-    std::deque<Message> received_messages;     ///< Queue of received messages.
-    std::vector<char> receiveBuffer;           ///< Buffer for receiving data.
-    asio::steady_timer timer;                  ///< Timer for handling periodic tasks.
-    std::mutex socket_mutex;                   ///< Mutex for socket operations to ensure thread safety.
+    static constexpr std::size_t OUTGOING_QUEUE_CAPACITY = 256;  ///< Commands the game loop can queue ahead of the strand.
+
+    /**
+     * @struct OutgoingCommand
+     * @brief A message handed from the game loop to the session's strand.
+     */
+    struct OutgoingCommand {
+        /**
+         * @enum Type
+         * @brief How the strand queues the message.
+         */
+        enum Type {
+            MESSAGE,  ///< Reliable message, appended to the send queue.
+            SNAPSHOT  ///< Snapshot, replacing the pending one.
+        };
+
+        Type type = MESSAGE;   ///< How the strand queues the message.
+        SharedBuffer message;  ///< The shared encoded message.
+    };
+
+    int id;                                                                 ///< Unique identifier for the client.
+    asio::strand<asio::io_context::executor_type> strand;                   ///< Serializes the session's handlers across IO threads.
+    asio::ip::tcp::socket socket;                                           ///< Socket for network communication, bound to the strand.
+    MpscRing<OutgoingCommand, OUTGOING_QUEUE_CAPACITY> outgoingCommands;    ///< Messages handed to the strand by any thread.
+    std::atomic<bool> drainScheduled{false};                                ///< Whether a drain of outgoingCommands is posted on the strand.
+    std::vector<SharedBuffer> outgoingMessages;                             ///< Queue of encoded messages to be sent to the client.
+    SharedBuffer pendingSnapshot;                                           ///< Newest unsent snapshot, written after outgoingMessages.
+    std::atomic<std::size_t> queuedBytes{0};                                ///< Bytes queued or being written.
+    std::atomic<std::size_t> throttleBytes{SIZE_MAX};                       ///< Queue size from which snapshots are dropped.
+    std::atomic<std::size_t> disconnectBytes{SIZE_MAX};                     ///< Queue size from which the client is disconnected.
+    std::atomic<std::uint64_t> droppedSnapshots{0};                         ///< Snapshots replaced or dropped before being written.
+    std::vector<SharedBuffer> writingMessages;                              ///< Messages of the write in progress, kept alive until it completes.
+    std::vector<asio::const_buffer> gatherBuffers;                          ///< Buffer sequence of the write in progress.
+    bool writing = false;                                                   ///< Whether a write is in progress.
+    std::atomic<bool> flushPerTick{false};                                  ///< Whether messages wait for flush() before being written.
+    std::atomic<bool> flushRequested{false};                                ///< Whether flush() was called since the last write started.
+    std::atomic<bool> closing{false};                                       ///< Whether to disconnect once the queue is drained.
+    std::atomic<bool> closed{false};                                        ///< Whether the connection is gone.
+    InputQueue receivedInputs;                                              ///< Decoded inputs, pushed by the strand, picked by the match.
+    FrameAssembler receiveFrames;                                           ///< Reassembles messages split or coalesced by TCP.
+    asio::steady_timer timer;                                               ///< Timer for handling periodic tasks.
+    HelloHandler helloHandler;                                              ///< Answers HELLO, then released.
+    ResumeHandler resumeHandler;                                            ///< Answers RESUME, then released.
+    bool greeted = false;                                                   ///< Whether the client sent HELLO or RESUME.
+    Protocol::WelcomePayload session;                                       ///< Settings negotiated by the handshake.
+
+    /**
+     * @brief Wakes the strand up to drain the outgoing command queue, unless it is already due to.
+     */
+    void scheduleDrain();
+
+    /**
+     * @brief Moves the queued outgoing commands into the send queue, then writes it.
+     *
+     * Runs on the strand.
+     */
+    void drainCommands();
 
     /**
      * @brief Writes all queued messages to the server.
      *
-     * This method sends messages from the outgoing queue to the server using asynchronous operations.
+     * This method moves every queued message into one scatter-gather asynchronous write.
+     * Runs on the strand.
      */
     void writeMessages();
+
+    /**
+     * @brief Handles a message received from the client.
+     *
+     * Runs on the strand.
+     *
+     * @param message The message.
+     * @return true if the message is allowed at this point of the session, false otherwise.
+     */
+    bool handleMessage(const Message& message);
 };
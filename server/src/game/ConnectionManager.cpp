@@ -1,4 +1,6 @@
 #include "ConnectionManager.hpp"
+#include <algorithm>
+#include <string>
 
 /**
  * @brief Constructs a new Connection Manager object.
@@ -9,10 +11,11 @@
  * @param io_context ASIO IO context for asynchronous operations.
  * @param port The port number on which the server will listen for incoming connections.
  */
-ConnectionManager::ConnectionManager(asio::io_context& io_context, short port, int maxPlayers)
+ConnectionManager::ConnectionManager(asio::io_context& io_context, short port)
     : io_context_(io_context),
       acceptor_(io_context, asio::ip::tcp::endpoint(asio::ip::address::from_string(IPResolver::getActualIP(io_context_)), port)),
-      maxPlayers_(maxPlayers) {
+      snapshotChannel_(io_context, asio::ip::udp::endpoint(acceptor_.local_endpoint().address(), port)) {
+    snapshotChannel_.startReceive();
     std::string actual_ip = IPResolver::getActualIP(io_context_);
     std::cout << "Server starting on IP: " << actual_ip << " Port: " << port << std::endl;
     std::cout << "To join the game, use: ./r-type_client " << actual_ip << std::endl;
@@ -21,50 +24,153 @@ ConnectionManager::ConnectionManager(asio::io_context& io_context, short port, i
 /**
  * @brief Starts accepting client connections asynchronously.
  *
- * Waits for incoming client connections and sets up each new client. If the maximum
- * number of players is reached, it stops accepting new connections and triggers the game
- * start callback.
+ * Waits for incoming client connections and starts the handshake of each new client,
+ * which hands it to the first callback, placing it in a match, once WELCOME is sent, or
+ * to the second one, reattaching it to its session, if it sent RESUME. Only one accept is
+ * pending at a time; handshakes run on each client's strand, so the callbacks may run on
+ * several IO threads at once.
  *
- * @param gameStartCallback Callback function to be called when the maximum number of players is reached.
+ * @param clientConnectedCallback Callback function called with every client that completed its handshake.
+ * @param clientResumedCallback Callback function called with every client that sent RESUME and its token.
  */
-void ConnectionManager::acceptConnections(std::function<void()> gameStartCallback) {
-    std::cout << "Waiting for client connections..." << std::endl;
-    if (clients_.size() < this->maxPlayers_) {
-        int newClientId = clients_.size() + 1;
-        auto client = std::make_shared<Client>(io_context_, newClientId);
-        acceptor_.async_accept(client->getSocket(), [this, client, gameStartCallback](std::error_code ec) {
-            if (!ec) {
-                std::cout << "New client connected with ID: " << client->getId() << std::endl;
-                clients_.push_back(client);
-                client->startRead();
-                if (clients_.size() < this->maxPlayers_) {
-                    acceptConnections(gameStartCallback);
-                } else {
-                    gameStartCallback();
-                }
-            } else {
-                std::cerr << "Error accepting client: " << ec.message() << std::endl;
-            }
-        });
-    } else {
-        std::cout << "Maximum number of players reached. No longer accepting new connections." << std::endl;
+void ConnectionManager::acceptConnections(ConnectedCallback clientConnectedCallback, ResumedCallback clientResumedCallback) {
+    auto client = std::make_shared<Client>(io_context_, nextClientId_++);
+    client->setFlushPerTick(GameUtilities::FLUSH_PER_TICK);
+    client->setSendQueueLimits(GameUtilities::SEND_QUEUE_THROTTLE_BYTES, GameUtilities::SEND_QUEUE_DISCONNECT_BYTES);
+    acceptor_.async_accept(client->getSocket(), [this, client, clientConnectedCallback, clientResumedCallback](std::error_code ec) {
+        if (!ec) {
+            std::cout << "New client connected with ID: " << client->getId() << std::endl;
+            client->startHandshake(
+                std::chrono::milliseconds(GameUtilities::HANDSHAKE_TIMEOUT_MS),
+                [this, clientConnectedCallback](const std::shared_ptr<Client>& greeted, const Protocol::HelloPayload& hello) {
+                    handleHello(greeted, hello, clientConnectedCallback);
+                },
+                [this, clientResumedCallback](const std::shared_ptr<Client>& resuming, const Protocol::ResumePayload& resume) {
+                    handleResume(resuming, resume, clientResumedCallback);
+                });
+        } else if (ec == asio::error::operation_aborted) {
+            return;
+        } else {
+            std::cerr << "Error accepting client: " << ec.message() << std::endl;
+        }
+        acceptConnections(clientConnectedCallback, clientResumedCallback);
+    });
+}
+
+/**
+ * @brief Gets a reference to the ASIO IO context.
+ *
+ * @return asio::io_context& Reference to the ASIO IO context used for network operations.
+ */
+asio::io_context& ConnectionManager::getIoContext() {
+    return io_context_;
+}
+
+/**
+ * @brief Gets a reference to the UDP channel used to stream snapshots.
+ *
+ * @return SnapshotChannel& Reference to the snapshot channel.
+ */
+SnapshotChannel& ConnectionManager::getSnapshotChannel() {
+    return snapshotChannel_;
+}
+
+/**
+ * @brief Gets the endpoint the server accepts connections on.
+ *
+ * @return asio::ip::tcp::endpoint The address and port the acceptor is bound to.
+ */
+asio::ip::tcp::endpoint ConnectionManager::getLocalEndpoint() const {
+    return acceptor_.local_endpoint();
+}
+
+/**
+ * @brief Lists the capabilities of a mask, for logs.
+ *
+ * @param capabilities The capability mask.
+ * @return std::string The capability names separated by commas, or "none".
+ */
+static std::string describeCapabilities(std::uint32_t capabilities) {
+    std::string names;
+    for (Capability capability : {Capability::UDP_SNAPSHOTS, Capability::DELTA_SNAPSHOTS, Capability::RELIABLE_EVENTS, Capability::SPECTATOR}) {
+        if (capabilities & Protocol::capabilityBit(capability))
+            names += (names.empty() ? "" : ",") + std::string(Protocol::capabilityName(capability));
     }
+    return names.empty() ? "none" : names;
 }
 
 /**
- * @brief Gets a reference to the list of connected clients.
+ * @brief Answers a client's HELLO with the settings of its session.
  *
- * @return std::vector<std::shared_ptr<Client>>& Reference to the vector of connected clients.
+ * Runs on the client's strand. The session version is the newest one in both the client's
+ * and the server's range (see Protocol::negotiateVersion). WELCOME is flushed at once,
+ * since a client waiting for its match does not see a tick flush its messages.
+ *
+ * @param client The client that sent HELLO.
+ * @param hello The client's HELLO.
+ * @param clientConnectedCallback Called with the client once the session is set up.
  */
-std::vector<std::shared_ptr<Client>>& ConnectionManager::getClients() {
-    return clients_;
+void ConnectionManager::handleHello(const std::shared_ptr<Client>& client, const Protocol::HelloPayload& hello,
+                                    const ConnectedCallback& clientConnectedCallback) {
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::WelcomePayload::SIZE> buffer;
+    Protocol::WelcomePayload welcome;
+    std::uint8_t version = Protocol::negotiateVersion(hello.minVersion, hello.maxVersion);
+    if (version == 0) {
+        std::cerr << "Client " << client->getId() << " speaks protocol versions " << int(hello.minVersion) << " to " << int(hello.maxVersion)
+                  << ", none of " << int(Protocol::MIN_VERSION) << " to " << int(Protocol::VERSION) << ", disconnecting." << std::endl;
+        client->send(std::span(buffer.data(), Message::serialize(welcome, buffer)));
+        client->disconnectAfterFlush();
+        return;
+    }
+
+    welcome.version = version;
+    welcome.capabilities = Protocol::normalizeCapabilities(hello.capabilities & GameUtilities::CAPABILITIES);
+    welcome.tickIntervalMs = static_cast<std::uint16_t>(Protocol::TICK_INTERVAL_MS);
+    std::size_t budget = hello.snapshotBudgetBytes == 0 ? GameUtilities::SNAPSHOT_BUDGET_BYTES : hello.snapshotBudgetBytes;
+    welcome.snapshotBudgetBytes =
+        static_cast<std::uint16_t>(std::clamp(budget, GameUtilities::MIN_SNAPSHOT_BUDGET_BYTES, GameUtilities::SNAPSHOT_BUDGET_BYTES));
+    client->setSession(welcome);
+    client->send(std::span(buffer.data(), Message::serialize(welcome, buffer)));
+    if (welcome.has(Capability::UDP_SNAPSHOTS))
+        offerUdpBinding(client);
+    client->flush();
+    std::cout << "Client " << client->getId() << " negotiated protocol version " << int(welcome.version) << " with capabilities "
+              << describeCapabilities(welcome.capabilities) << " and a " << welcome.snapshotBudgetBytes << " byte snapshot budget." << std::endl;
+    clientConnectedCallback(client);
 }
 
 /**
- * @brief Gets a reference to the ASIO IO context.
+ * @brief Hands a client's RESUME to the session it names.
  *
- * @return asio::io_context& Reference to the ASIO IO context used for network operations.
+ * Runs on the client's strand. The match the session belongs to sends WELCOME with the
+ * settings the session negotiated, so nothing is sent here unless the token is unknown.
+ *
+ * @param client The client that sent RESUME.
+ * @param resume The client's RESUME.
+ * @param clientResumedCallback Called with the client and its token.
  */
-asio::io_context& ConnectionManager::getIoContext() {
-    return io_context_;
+void ConnectionManager::handleResume(const std::shared_ptr<Client>& client, const Protocol::ResumePayload& resume,
+                                     const ResumedCallback& clientResumedCallback) {
+    if (resume.token != 0 && clientResumedCallback(client, resume.token))
+        return;
+    std::cerr << "Client " << client->getId() << " tried to resume an unknown or expired session, disconnecting." << std::endl;
+    Protocol::SessionPayload refused;
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::SessionPayload::SIZE> buffer;
+    client->send(std::span(buffer.data(), Message::serialize(refused, buffer)));
+    client->disconnectAfterFlush();
+}
+
+/**
+ * @brief Registers a new client on the snapshot channel and sends it its UDP bind token.
+ *
+ * The client echoes the token in a datagram; until then it keeps receiving snapshots over TCP.
+ *
+ * @param client The newly connected client.
+ */
+void ConnectionManager::offerUdpBinding(const std::shared_ptr<Client>& client) {
+    Protocol::UdpBindPayload bind;
+    bind.token = snapshotChannel_.registerClient(client->getId());
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::UdpBindPayload::SIZE> buffer;
+    std::size_t size = Message::serialize(bind, buffer);
+    client->send(std::span(buffer.data(), size));
 }
@@ -1,9 +1,12 @@
 #pragma once
+#include <array>
 #include <asio.hpp>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <vector>
 #include "../game/Client.hpp"
+#include "../game/SnapshotChannel.hpp"
 #include "../utilities/GameUtilities.hpp"
 #include "../utilities/IPResolver.hpp"
 
@@ -20,40 +23,88 @@ class ConnectionManager {
      * @brief Constructs a new Connection Manager object.
      *
      * Initializes the network acceptor to start listening for incoming client connections
-     * on the specified port. It also outputs the server's IP and port information.
+     * on the specified port, and the UDP snapshot channel on the same port number.
+     * It also outputs the server's IP and port information.
      *
      * @param io_context ASIO IO context for asynchronous operations.
      * @param port The port number on which the server will listen for incoming connections.
      */
-    ConnectionManager(asio::io_context& io_context, short port, int maxPlayers);
+    ConnectionManager(asio::io_context& io_context, short port);
+
+    using ConnectedCallback = std::function<void(std::shared_ptr<Client>)>;                    ///< Places a new session.
+    using ResumedCallback = std::function<bool(const std::shared_ptr<Client>&, std::uint64_t)>;  ///< Reattaches a session by token.
 
     /**
      * @brief Starts accepting client connections asynchronously.
      *
-     * Waits for incoming client connections and sets up each new client. When the maximum
-     * number of players is reached, it triggers a callback to start the game.
+     * Waits for incoming client connections and sets up each new client, then hands it
+     * to the first callback once its handshake succeeds, or to the second one if it
+     * resumes a session instead. Accepting continues until the acceptor is closed.
      *
-     * @param gameStartCallback Callback function to be called when the maximum number of players is reached.
+     * @param clientConnectedCallback Callback function called with every client that completed its handshake.
+     * @param clientResumedCallback Callback function called with every client that sent RESUME and its token;
+     *                              returns false if no session can be resumed with the token.
      */
-    void acceptConnections(std::function<void()> gameStartCallback);
+    void acceptConnections(ConnectedCallback clientConnectedCallback, ResumedCallback clientResumedCallback);
 
     /**
-     * @brief Gets a reference to the list of connected clients.
+     * @brief Gets a reference to the ASIO IO context.
      *
-     * @return std::vector<std::shared_ptr<Client>>& Reference to the vector of connected clients.
+     * @return asio::io_context& Reference to the ASIO IO context used for network operations.
      */
-    std::vector<std::shared_ptr<Client>>& getClients();
+    asio::io_context& getIoContext();
 
     /**
-     * @brief Gets a reference to the ASIO IO context.
+     * @brief Gets a reference to the UDP channel used to stream snapshots.
      *
-     * @return asio::io_context& Reference to the ASIO IO context used for network operations.
+     * @return SnapshotChannel& Reference to the snapshot channel.
      */
-    asio::io_context& getIoContext();
+    SnapshotChannel& getSnapshotChannel();
+
+    /**
+     * @brief Gets the endpoint the server accepts connections on.
+     *
+     * @return asio::ip::tcp::endpoint The address and port the acceptor is bound to.
+     */
+    asio::ip::tcp::endpoint getLocalEndpoint() const;
 
    private:
-    asio::io_context& io_context_;                  ///< Reference to the ASIO IO context.
-    asio::ip::tcp::acceptor acceptor_;              ///< Acceptor used for listening for incoming connections.
-    std::vector<std::shared_ptr<Client>> clients_;  ///< Vector holding the connected clients.
-    int maxPlayers_;
+    /**
+     * @brief Answers a client's HELLO with the settings of its session.
+     *
+     * Picks the newest version both sides speak and the capabilities both support, clamps
+     * the requested snapshot budget, then sends WELCOME. A client sharing no version with
+     * the server gets a WELCOME with version 0 and is disconnected. The server currently
+     * speaks a single version, Protocol::VERSION, so no feature depends on the version.
+     *
+     * @param client The client that sent HELLO.
+     * @param hello The client's HELLO.
+     * @param clientConnectedCallback Called with the client once the session is set up.
+     */
+    void handleHello(const std::shared_ptr<Client>& client, const Protocol::HelloPayload& hello, const ConnectedCallback& clientConnectedCallback);
+
+    /**
+     * @brief Hands a client's RESUME to the session it names.
+     *
+     * The match holding the session answers with WELCOME and SESSION, then the entities
+     * the client sees. If no session matches the token, the client gets a SESSION with a
+     * token of 0 and is disconnected.
+     *
+     * @param client The client that sent RESUME.
+     * @param resume The client's RESUME.
+     * @param clientResumedCallback Called with the client and its token.
+     */
+    void handleResume(const std::shared_ptr<Client>& client, const Protocol::ResumePayload& resume, const ResumedCallback& clientResumedCallback);
+
+    /**
+     * @brief Registers a new client on the snapshot channel and sends it its UDP bind token.
+     *
+     * @param client The newly connected client.
+     */
+    void offerUdpBinding(const std::shared_ptr<Client>& client);
+
+    asio::io_context& io_context_;      ///< Reference to the ASIO IO context.
+    asio::ip::tcp::acceptor acceptor_;  ///< Acceptor used for listening for incoming connections.
+    int nextClientId_ = 1;              ///< Identifier given to the next client; unique across matches.
+    SnapshotChannel snapshotChannel_;   ///< Unreliable channel carrying state snapshots.
 };
@@ -0,0 +1,841 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "../utilities/GameUtilities.hpp"
+#include "../utilities/RandomUtilities.hpp"
+#include "AreaOfInterest.hpp"
+#include "Client.hpp"
+#include "CollisionSystem.hpp"
+#include "EnemyMovementSystem.hpp"
+#include "Message.hpp"
+#include "OutboundFrame.hpp"
+#include "PlayerMovement.hpp"
+#include "PriorityAccumulator.hpp"
+#include "Registry.hpp"
+#include "SharedBuffer.hpp"
+#include "Snapshot.hpp"
+#include "SnapshotChannel.hpp"
+#include "SpatialGrid.hpp"
+#include "SpectatorFeed.hpp"
+
+/**
+ * @class Match
+ * @brief One independent game, with its own players, registry and systems.
+ *
+ * A match waits until it has maxPlayers players, starts after a short delay, and ends
+ * once its last player is gone. A player whose connection drops is suspended rather than
+ * removed: its entity stays in the world for RESUME_WINDOW_MS, during which the client
+ * can reconnect with its session token and pick up where it left. Any number of spectators
+ * can watch the match at any time through its SpectatorFeed.
+ *
+ * Matches share nothing but the snapshot channel, so many of them can run in one process:
+ * the MatchManager ticks them on a pool of workers, each match always on the same worker.
+ * Every method except join(), resume() and spectate() must be called from that worker.
+ */
+class Match {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Clock used to schedule the match.
+
+    /**
+     * @brief Constructs a new Match object.
+     *
+     * Initializes the game systems; no entity exists until the match starts.
+     *
+     * @param matchId Unique identifier of the match, used in logs.
+     * @param maxPlayers The number of players required for the match to start.
+     * @param snapshotChannel The UDP channel snapshots are streamed on.
+     * @param spectatorDelay How far behind the match its spectators are.
+     */
+    Match(int matchId, int maxPlayers, SnapshotChannel& snapshotChannel, std::chrono::milliseconds spectatorDelay)
+        : id_(matchId),
+          maxPlayers_(maxPlayers),
+          snapshotChannel_(snapshotChannel),
+          view_{GameUtilities::VIEW_HALF_WIDTH, GameUtilities::VIEW_HALF_HEIGHT, GameUtilities::VIEW_MARGIN},
+          priorityWeights_{GameUtilities::PLAYER_PRIORITY_WEIGHT, GameUtilities::ENEMY_PRIORITY_WEIGHT, GameUtilities::PRIORITY_SPEED_SCALE,
+                           GameUtilities::PRIORITY_DISTANCE_SCALE},
+          spectatorFeed_(snapshotChannel, spectatorDelay) {
+        enemyMovementSystem =
+            std::make_shared<EnemyMovementSystem>(static_cast<float>(GameUtilities::SCREEN_WIDTH), GameUtilities::OFF_SCREEN_X,
+                                                  GameUtilities::ENEMY_SPEED, GameUtilities::SCREEN_HEIGHT - GameUtilities::ENEMY_HEIGHT);
+        registry.addSystem(enemyMovementSystem);
+        collisionSystem = std::make_shared<CollisionSystem>([this](int playerId) { handlePlayerCollision(playerId); }, activeEnemies);
+        registry.addSystem(collisionSystem);
+    }
+
+    /**
+     * @brief Reserves a slot for a client; it enters the match on the next tick.
+     *
+     * Called by the match manager from an IO thread, hence synchronized.
+     *
+     * @param client The newly connected client.
+     * @param token The session token the client can later resume with.
+     * @return true if the client was accepted, false if the match is full or already started.
+     */
+    bool join(const std::shared_ptr<Client>& client, std::uint64_t token) {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        if (reservedSlots_ >= maxPlayers_)
+            return false;
+        ++reservedSlots_;
+        pendingJoins_.push_back({client, token});
+        resumableTokens_.insert(token);
+        return true;
+    }
+
+    /**
+     * @brief Hands a reconnected client its player back; it takes over on the next tick.
+     *
+     * Called by the match manager from an IO thread, hence synchronized.
+     *
+     * @param client The reconnected client.
+     * @param token The session token the client presented.
+     * @return true if the token belongs to a player of the match, false otherwise.
+     */
+    bool resume(const std::shared_ptr<Client>& client, std::uint64_t token) {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        if (!resumableTokens_.contains(token))
+            return false;
+        pendingResumes_.push_back({client, token});
+        return true;
+    }
+
+    /**
+     * @brief Adds a read-only spectator; it starts receiving the match on the next tick.
+     *
+     * Called by the match manager from an IO thread, hence synchronized.
+     *
+     * @param client The spectator's session.
+     * @return true if the spectator was accepted, false if the match is over.
+     */
+    bool spectate(const std::shared_ptr<Client>& client) {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        if (!acceptingSpectators_)
+            return false;
+        pendingSpectators_.push_back(client);
+        return true;
+    }
+
+    /**
+     * @brief Checks whether the match still accepts players.
+     *
+     * @return true if a slot is free, false otherwise.
+     */
+    bool isOpen() {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        return reservedSlots_ < maxPlayers_;
+    }
+
+    /**
+     * @brief Checks whether the match is over and can be destroyed.
+     *
+     * @return true once every player of a started match is gone and its spectators saw the end, false otherwise.
+     */
+    bool isFinished() const { return state_ == State::FINISHED; }
+
+    /**
+     * @brief Gets the match's unique identifier.
+     *
+     * @return int The match ID.
+     */
+    int getId() const { return id_; }
+
+    /**
+     * @brief Runs one tick of the match.
+     *
+     * Admits the clients that joined or resumed since the previous tick and suspends those
+     * whose connection dropped, starts the game when it is due, then applies one input per
+     * player, updates the systems and streams the snapshot.
+     * Every tick ends with a flush, so the messages it produced leave in one write per client
+     * and the reliable packets due are queued on the snapshot channel. The tick is recorded
+     * for the spectators as long as a player is in the match, and streamed to them once the
+     * spectator delay elapsed.
+     *
+     * @param now The time of the tick.
+     */
+    void tick(Clock::time_point now) {
+        now_ = now;
+        admitPlayers(now);
+        suspendDisconnectedPlayers(now);
+        float deltaTime = registry.updateDeltaTime();
+
+        if (state_ == State::STARTING && now >= startTime_)
+            startGame(now);
+        if (state_ == State::RUNNING) {
+            processClientInputs();
+            if (now >= nextEnemySpawn_) {
+                createEnemy();
+                nextEnemySpawn_ = now + std::chrono::seconds(RandomUtilities::getRandomSpawnTime(2, 5));
+            }
+            updateGameState(deltaTime);
+            sendUpdates();
+            if (!players_.empty() || !departures_.empty())
+                spectatorFeed_.record(world_, [this](std::int32_t entityId) { return getEntityType(entityId); }, now);
+        }
+        spectatorFeed_.release(now);
+        flushClients(now);
+        if (state_ == State::RUNNING && players_.empty() && departures_.empty() && spectatorFeed_.isDrained())
+            finish();
+    }
+
+   private:
+    /**
+     * @enum State
+     * @brief Lifecycle of a match.
+     */
+    enum class State {
+        WAITING,   ///< Waiting for players.
+        STARTING,  ///< Full, waiting for the start delay to elapse.
+        RUNNING,   ///< Game in progress.
+        FINISHED   ///< Every player is gone.
+    };
+
+    /**
+     * @struct Player
+     * @brief A client taking part in the match.
+     */
+    struct Player {
+        /**
+         * @brief Constructs a player that just joined, without an entity yet.
+         *
+         * @param joined The player's session.
+         * @param token Token the client resumes the session with.
+         * @param view View rectangle of the player.
+         * @param weights How fast entities gain priority in the player's snapshots.
+         */
+        Player(std::shared_ptr<Client> joined, std::uint64_t token, const ViewRect& view, const PriorityWeights& weights)
+            : client(std::move(joined)),
+              interest(view),
+              priorities(weights),
+              budgetBytes(client->getSession().snapshotBudgetBytes),
+              sessionToken(token) {}
+
+        std::shared_ptr<Client> client;     ///< The player's session.
+        int entityId = 0;                   ///< The player's entity, 0 until the game starts.
+        AreaOfInterest interest;            ///< Entities the player's client was told about.
+        PriorityAccumulator priorities;     ///< Picks the entities of the interest set that fit in the budget.
+        std::size_t budgetBytes = 0;        ///< Largest snapshot sent to the player per tick.
+        SnapshotHistory history;            ///< Snapshots sent to the player, used as its delta baselines.
+        std::uint64_t sessionToken = 0;     ///< Token the client resumes the session with.
+        bool suspended = false;             ///< Whether the connection dropped and the player awaits a resume.
+        Clock::time_point resumeDeadline;   ///< When a suspended player is removed.
+        bool resync = false;                ///< Whether the client must be sent the entities it sees in a WORLD_STATE.
+        OutboundFrame events;               ///< Events of the tick, sent to the client when the tick is flushed.
+        bool reliableEvents = false;        ///< Whether the client's events moved from TCP to its reliable channel.
+    };
+
+    /**
+     * @struct PendingSession
+     * @brief A client that joined or resumed since the previous tick, with its session token.
+     */
+    struct PendingSession {
+        std::shared_ptr<Client> client;  ///< The client.
+        std::uint64_t token;             ///< The session token.
+    };
+
+    /**
+     * @struct Departure
+     * @brief A defeated player's client, kept until it acknowledges GAME_OVER.
+     */
+    struct Departure {
+        std::shared_ptr<Client> client;  ///< The defeated player's session.
+        Clock::time_point deadline;      ///< When the client is disconnected even without an acknowledgement.
+        OutboundFrame events;            ///< Events of the tick the player was defeated at, GAME_OVER last.
+        bool reliableEvents;             ///< Whether the client's events moved from TCP to its reliable channel.
+    };
+
+    /**
+     * @struct DeltaEntry
+     * @brief A delta encoded during the tick, reused by players with the same baseline and snapshot.
+     */
+    struct DeltaEntry {
+        const Snapshot* baseline;  ///< The baseline the delta was encoded against.
+        const Snapshot* current;   ///< The snapshot the delta describes.
+        SharedBuffer message;      ///< The encoded delta, or nullptr if it was not smaller than the full snapshot.
+    };
+
+    /**
+     * @brief Moves the clients that joined since the previous tick into the match, hands
+     * the resumed ones their players back, and adds the new spectators.
+     *
+     * Each new client is sent its session token.
+     *
+     * @param now The time of the tick.
+     */
+    void admitPlayers(Clock::time_point now) {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        for (PendingSession& join : pendingJoins_) {
+            std::cout << "Match " << id_ << ": client " << join.client->getId() << " joined." << std::endl;
+            sendSession(*join.client, join.token);
+            players_.emplace_back(std::move(join.client), join.token, view_, priorityWeights_);
+        }
+        pendingJoins_.clear();
+        for (PendingSession& resumed : pendingResumes_) {
+            auto player = std::find_if(players_.begin(), players_.end(), [&](const Player& p) { return p.sessionToken == resumed.token; });
+            if (player != players_.end()) {
+                resumePlayer(*player, resumed.client);
+                continue;
+            }
+            Protocol::SessionPayload refused;  // The session expired after the resume was accepted
+            std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::SessionPayload::SIZE> buffer;
+            resumed.client->send(std::span(buffer.data(), Message::serialize(refused, buffer)));
+            resumed.client->disconnectAfterFlush();
+        }
+        pendingResumes_.clear();
+        for (std::shared_ptr<Client>& client : pendingSpectators_) {
+            std::cout << "Match " << id_ << ": client " << client->getId() << " is spectating, " << spectatorFeed_.size() + 1
+                      << " spectator(s)." << std::endl;
+            spectatorFeed_.add(std::move(client));
+        }
+        pendingSpectators_.clear();
+        if (state_ == State::WAITING && static_cast<int>(players_.size()) == maxPlayers_) {
+            state_ = State::STARTING;
+            startTime_ = now + std::chrono::milliseconds(GameUtilities::MATCH_START_DELAY_MS);
+        }
+    }
+
+    /**
+     * @brief Hands a player over to the client that resumed its session.
+     *
+     * The previous connection is closed and forgotten by the snapshot channel. The new
+     * client inherits the settings the session negotiated and is sent WELCOME, SESSION and
+     * its player entity. Its replication state starts over: if the game is running, the
+     * next snapshot is preceded by a WORLD_STATE describing every entity it sees, and the
+     * UDP channel is only offered after it, so reliable events cannot overtake it.
+     *
+     * @param player The player.
+     * @param client The client that resumed the session.
+     */
+    void resumePlayer(Player& player, const std::shared_ptr<Client>& client) {
+        std::shared_ptr<Client> previous = std::move(player.client);
+        snapshotChannel_.unregisterClient(previous->getId());
+        if (!previous->isClosed())
+            previous->disconnect();
+        std::cout << "Match " << id_ << ": client " << client->getId() << " resumed the session of client " << previous->getId() << "."
+                  << std::endl;
+
+        const Protocol::WelcomePayload& welcome = previous->getSession();
+        client->setSession(welcome);
+        std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::WelcomePayload::SIZE> buffer;
+        client->send(std::span(buffer.data(), Message::serialize(welcome, buffer)));
+        sendSession(*client, player.sessionToken);
+
+        player.client = client;
+        player.suspended = false;
+        player.interest = AreaOfInterest(view_);
+        player.priorities = PriorityAccumulator(priorityWeights_);
+        player.history.clear();
+        player.events.clear();
+        player.reliableEvents = false;
+        player.resync = player.entityId != 0;
+        if (player.entityId != 0)
+            assignPlayer(player);
+        else
+            offerUdpBinding(*client);
+    }
+
+    /**
+     * @brief Suspends the players whose connection dropped, and removes those suspended for too long.
+     *
+     * A suspended player's entity stays in the world, without inputs, and nothing is sent
+     * to its client. Once RESUME_WINDOW_MS passed, the session can no longer be resumed
+     * and the entity is removed like a dead one.
+     *
+     * @param now The time of the tick.
+     */
+    void suspendDisconnectedPlayers(Clock::time_point now) {
+        for (auto it = players_.begin(); it != players_.end();) {
+            if (!it->suspended && it->client->isClosed()) {
+                std::cout << "Match " << id_ << ": client " << it->client->getId() << " lost its connection, keeping its player for "
+                          << GameUtilities::RESUME_WINDOW_MS << " ms." << std::endl;
+                it->suspended = true;
+                it->resumeDeadline = now + std::chrono::milliseconds(GameUtilities::RESUME_WINDOW_MS);
+                snapshotChannel_.unregisterClient(it->client->getId());
+            }
+            if (!it->suspended || now < it->resumeDeadline) {
+                ++it;
+                continue;
+            }
+            std::cout << "Match " << id_ << ": client " << it->client->getId() << " did not resume, removing its player." << std::endl;
+            int entityId = it->entityId;
+            forgetSession(it->sessionToken, state_ == State::WAITING);
+            it = players_.erase(it);
+            if (entityId != 0) {
+                registry.removeEntity(entityId);
+                notifyEntityDeath(entityId);
+            }
+        }
+    }
+
+    /**
+     * @brief Makes a session impossible to resume.
+     *
+     * @param token The session token.
+     * @param releaseSlot Whether the player's slot is freed for another client.
+     */
+    void forgetSession(std::uint64_t token, bool releaseSlot = false) {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        resumableTokens_.erase(token);
+        if (releaseSlot)
+            --reservedSlots_;
+    }
+
+    /**
+     * @brief Sends a client the token to resume its session with.
+     *
+     * @param client The client.
+     * @param token The session token.
+     */
+    void sendSession(Client& client, std::uint64_t token) {
+        Protocol::SessionPayload session;
+        session.token = token;
+        session.resumeWindowMs = static_cast<std::uint16_t>(GameUtilities::RESUME_WINDOW_MS);
+        std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::SessionPayload::SIZE> buffer;
+        client.send(std::span(buffer.data(), Message::serialize(session, buffer)));
+    }
+
+    /**
+     * @brief Registers a resumed client on the snapshot channel and sends it its UDP bind token.
+     *
+     * Does nothing if the session did not negotiate UDP_SNAPSHOTS.
+     *
+     * @param client The client.
+     */
+    void offerUdpBinding(Client& client) {
+        if (!client.getSession().has(Capability::UDP_SNAPSHOTS))
+            return;
+        Protocol::UdpBindPayload bind;
+        bind.token = snapshotChannel_.registerClient(client.getId());
+        std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::UdpBindPayload::SIZE> buffer;
+        client.send(std::span(buffer.data(), Message::serialize(bind, buffer)));
+    }
+
+    /**
+     * @brief Applies one input per player for the current tick.
+     *
+     * Each held key moves the player by a fixed step (see PlayerMovement), so the speed only
+     * depends on the tick rate, not on the client's frame rate or key repeat. The sequence
+     * of every applied input is recorded for the tick's snapshot, so predicting clients
+     * know which of their inputs it includes. Suspended players' entities stand still.
+     */
+    void processClientInputs() {
+        inputAcks_.clear();
+        for (Player& player : players_) {
+            Protocol::InputPayload input;
+            if (player.suspended || !player.client->getNextInput(input))
+                continue;
+            Entity playerEntity(player.entityId);
+            auto posComp = registry.getComponent<PositionComponent>(playerEntity);
+
+            if (!posComp)
+                continue;
+
+            PlayerMovement::apply(input, posComp->x, posComp->y);
+            inputAcks_.push_back({playerEntity.id(), input.sequence});
+        }
+    }
+
+    /**
+     * @brief Creates a new enemy entity and adds it to the game.
+     */
+    void createEnemy() {
+        if (activeEnemies.size() < GameUtilities::MAX_ENEMIES) {
+            Entity enemyEntity = registry.createEntity();
+            float randomY = RandomUtilities::getRandomY(GameUtilities::SCREEN_HEIGHT - GameUtilities::ENEMY_HEIGHT);
+            registry.addComponent<PositionComponent>(enemyEntity, GameUtilities::SCREEN_WIDTH, randomY);
+            registry.addComponent<HitboxComponent>(enemyEntity, GameUtilities::ENEMY_WIDTH, GameUtilities::ENEMY_HEIGHT);
+            activeEnemies.insert(enemyEntity.id());
+            collisionSystem->updateEnemyEntityIds(activeEnemies);
+        }
+    }
+
+    /**
+     * @brief Creates a player entity for each client of the match.
+     */
+    void createPlayers() {
+        int playerCount = static_cast<int>(players_.size());
+        for (int i = 0; i < playerCount; ++i) {
+            Entity player = registry.createEntity();
+            players_[i].entityId = player.id();
+            assignPlayer(players_[i]);
+            registry.addComponent<PositionComponent>(
+                player, 0.0f, (GameUtilities::SCREEN_HEIGHT / playerCount * i) + (GameUtilities::SCREEN_HEIGHT / playerCount) / 2);
+            registry.addComponent<PlayerComponent>(player, player.id());
+            registry.addComponent<HitboxComponent>(player, GameUtilities::PLAYER_WIDTH, GameUtilities::PLAYER_HEIGHT);
+        }
+    }
+
+    /**
+     * @brief Sends a client the events of the tick, reliably and in order with its previous events.
+     *
+     * Events go over TCP, as a single message buffer, until the session's UDP endpoint is
+     * bound, and for good when the session did not negotiate RELIABLE_EVENTS. The switch to
+     * the client's reliable channel waits for a tick that finds the TCP send queue empty,
+     * so events still queued on TCP cannot be overtaken by later ones sent over UDP; once
+     * made, it is never undone for this connection. A client that leaves
+     * ReliableChannel::WINDOW events unacknowledged stopped answering: it is disconnected
+     * rather than left to fall further behind.
+     *
+     * @param client The client.
+     * @param events The events of the tick; cleared once sent.
+     * @param reliable Whether the client's events moved to its reliable channel; set when they do.
+     */
+    void sendEvents(Client& client, OutboundFrame& events, bool& reliable) {
+        if (events.empty())
+            return;
+        int clientId = client.getId();
+        if (!reliable && client.getSession().has(Capability::RELIABLE_EVENTS) && snapshotChannel_.isBound(clientId))
+            reliable = client.getQueuedBytes() == 0;
+        if (!reliable) {
+            client.send(events.bytes());
+        } else if (!snapshotChannel_.sendReliable(clientId, events.bytes())) {
+            std::cout << "Match " << id_ << ": client " << clientId << " stopped acknowledging events." << std::endl;
+            snapshotChannel_.unregisterClient(clientId);
+            client.disconnect();
+        }
+        events.clear();
+    }
+
+    /**
+     * @brief Tells a player's client which player entity it controls.
+     *
+     * @param player The player, whose entity was created.
+     */
+    void assignPlayer(Player& player) {
+        Protocol::PlayerAssignedPayload assigned;
+        assigned.entityId = player.entityId;
+        player.events.add(assigned);
+    }
+
+    /**
+     * @brief Gets the kind of an entity, as announced to clients.
+     *
+     * @param entityId Unique identifier of the entity.
+     * @return EntityType PLAYER for player entities, ENEMY otherwise.
+     */
+    EntityType getEntityType(int entityId) {
+        return registry.getComponent<PlayerComponent>(Entity(entityId)) ? EntityType::PLAYER : EntityType::ENEMY;
+    }
+
+    /**
+     * @brief Spawns an entity that entered a player's area of interest on its client.
+     *
+     * @param player The player.
+     * @param entityId Unique identifier of the entity.
+     */
+    void notifySpawn(Player& player, int entityId) {
+        Protocol::NewEntityPayload newEntity;
+        newEntity.entityId = entityId;
+        newEntity.entityType = getEntityType(entityId);
+        player.events.add(newEntity);
+    }
+
+    /**
+     * @brief Despawns an entity that left a player's area of interest from its client.
+     *
+     * @param player The player.
+     * @param entityId Unique identifier of the entity.
+     */
+    void notifyDespawn(Player& player, int entityId) {
+        Protocol::EntityDespawnPayload despawn;
+        despawn.entityId = entityId;
+        player.events.add(despawn);
+    }
+
+    /**
+     * @brief Notifies the players who see an entity of its death, and the spectators.
+     *
+     * The entity leaves their areas of interest without a despawn, since ENTITY_DEAD
+     * already removes it.
+     *
+     * @param entityId Unique identifier of the dead entity.
+     */
+    void notifyEntityDeath(int entityId) {
+        Protocol::EntityDeadPayload death;
+        death.entityId = entityId;
+        spectatorFeed_.recordDeath(entityId);
+        for (Player& player : players_) {
+            if (player.interest.erase(entityId) && !player.suspended)
+                player.events.add(death);
+        }
+    }
+
+    /**
+     * @brief Starts the game once all players are connected and the start delay elapsed.
+     *
+     * @param now The time of the tick.
+     */
+    void startGame(Clock::time_point now) {
+        std::cout << "Match " << id_ << ": starting game with " << players_.size() << " players." << std::endl;
+        createPlayers();
+        nextEnemySpawn_ = now;
+        state_ = State::RUNNING;
+    }
+
+    /**
+     * @brief Ends the match: stops accepting spectators and disconnects those watching.
+     */
+    void finish() {
+        std::lock_guard<std::mutex> lock(joinMutex_);
+        acceptingSpectators_ = false;
+        for (std::shared_ptr<Client>& client : pendingSpectators_)
+            spectatorFeed_.add(std::move(client));
+        pendingSpectators_.clear();
+        spectatorFeed_.close();
+        state_ = State::FINISHED;
+    }
+
+    /**
+     * @brief Updates the game state based on the elapsed time since the last update.
+     *
+     * @param deltaTime Time elapsed since the last update.
+     */
+    void updateGameState(float deltaTime) { registry.updateSystems(deltaTime); }
+
+    /**
+     * @brief Handles the collision of a player with another entity.
+     *
+     * The player receives GAME_OVER, after the other events of the tick, and leaves the match,
+     * but its client is only disconnected once it acknowledged every event, or after
+     * GAME_OVER_LINGER_MS; the others are told the player's entity died. The session can no longer be resumed, and a suspended player
+     * simply leaves.
+     *
+     * @param entityId Unique identifier of the collided player.
+     */
+    void handlePlayerCollision(int entityId) {
+        auto playerIt = std::find_if(players_.begin(), players_.end(), [entityId](const Player& player) { return player.entityId == entityId; });
+        if (playerIt == players_.end())
+            return;
+
+        forgetSession(playerIt->sessionToken);
+        if (!playerIt->suspended) {
+            Protocol::GameOverPayload gameOver;
+            gameOver.playerId = entityId;
+            playerIt->events.add(gameOver);
+            departures_.push_back({playerIt->client, now_ + std::chrono::milliseconds(GameUtilities::GAME_OVER_LINGER_MS),
+                                   std::move(playerIt->events), playerIt->reliableEvents});
+        }
+        registry.removeEntity(entityId);
+        players_.erase(playerIt);
+        notifyEntityDeath(entityId);
+    }
+    /**
+     * @brief Sends state updates to all players.
+     *
+     * The world snapshot of the tick is indexed in a spatial grid, and each player's area of
+     * interest is updated around its entity; entities entering or leaving it are spawned or
+     * despawned on the client. Each player then receives the world snapshot restricted to
+     * its area of interest and fitted into its byte budget by its priority accumulator,
+     * recorded in its own history. Clients bound on the UDP snapshot channel that
+     * negotiated DELTA_SNAPSHOTS receive it as a delta against the newest snapshot they
+     * acknowledged, or in full when that baseline is unknown, too old, or the delta would
+     * not be smaller. Other bound clients receive the full snapshot over UDP, and unbound
+     * ones over TCP. UDP datagrams are sent by the worker's channel flush, together with
+     * those of the other matches it ticks.
+     *
+     * A resumed player's interest set starts empty, so the entities it sees all enter it at
+     * once; rather than one spawn each, its client is sent them in a single WORLD_STATE.
+     * Suspended players are skipped.
+     *
+     * Players who see the same entities share the same encoded bytes: each full snapshot is
+     * encoded once per distinct content, and each delta once per distinct baseline and
+     * content, so a small world seen whole by every player is still encoded once.
+     */
+    void sendUpdates() {
+        std::uint32_t sequence = snapshotSequence_++;
+        std::swap(world_, previousWorld_);
+        world_.sequence = sequence;
+        world_.states.clear();
+        for (const Entity& entity : registry.getEntities()) {
+            auto posComp = registry.getComponent<PositionComponent>(entity);
+            if (posComp) {
+                if (registry.getComponent<PlayerComponent>(entity) || registry.getComponent<HitboxComponent>(entity)) {
+                    world_.states.push_back({entity.id(), posComp->x, posComp->y});
+                }
+            }
+        }
+        world_.sort();
+        world_.inputAcks.assign(inputAcks_.begin(), inputAcks_.end());
+
+        grid_.clear();
+        for (const Protocol::EntityState& state : world_.states) {
+            grid_.insert(state.entityId, state.x, state.y);
+        }
+        grid_.build();
+        fullCache_.clear();
+        deltaCache_.clear();
+        auto isPlayer = [this](std::int32_t entityId) { return registry.getComponent<PlayerComponent>(Entity(entityId)) != nullptr; };
+
+        for (Player& player : players_) {
+            if (player.suspended)
+                continue;
+            if (const Protocol::EntityState* center = world_.find(player.entityId)) {
+                player.interest.update(
+                    grid_, center->x, center->y,
+                    [&](std::int32_t entityId) {
+                        if (!player.resync)
+                            notifySpawn(player, entityId);
+                    },
+                    [&](std::int32_t entityId) { notifyDespawn(player, entityId); });
+            }
+            if (player.resync)
+                sendWorldState(player);
+            Snapshot& current = player.history.push(sequence);
+            player.priorities.select(world_, previousWorld_, player.interest.getEntities(), player.entityId, isPlayer, player.budgetBytes, current);
+            SharedBuffer fullSnapshot = encodeFull(current);
+
+            int clientId = player.client->getId();
+            std::uint32_t ackedSequence = 0;
+            SharedBuffer delta;
+            const Snapshot* baseline = nullptr;
+            if (player.client->getSession().has(Capability::DELTA_SNAPSHOTS) && snapshotChannel_.getAcknowledged(clientId, ackedSequence))
+                baseline = player.history.find(ackedSequence);
+            if (baseline)
+                delta = encodeDelta(*baseline, current, fullSnapshot->size());
+
+            if (delta && snapshotChannel_.queue(clientId, delta, sequence))
+                continue;
+            if (!snapshotChannel_.queue(clientId, fullSnapshot, sequence))
+                player.client->sendSnapshot(fullSnapshot);
+        }
+    }
+
+    /**
+     * @brief Sends a resumed player's client every entity it sees, then offers it the UDP channel.
+     *
+     * @param player The resumed player, whose interest set was just rebuilt.
+     */
+    void sendWorldState(Player& player) {
+        worldEntities_.clear();
+        for (std::int32_t entityId : player.interest.getEntities()) {
+            if (const Protocol::EntityState* state = world_.find(entityId))
+                worldEntities_.push_back({entityId, getEntityType(entityId), state->x, state->y});
+        }
+        std::size_t size = Protocol::WorldState::encode(worldEntities_, sendBuffer_);
+        if (size > 0)
+            player.client->send(std::span(sendBuffer_.data(), size));
+        player.resync = false;
+        offerUdpBinding(*player.client);
+    }
+
+    /**
+     * @brief Gets the full snapshot message of a player, encoding it on first use this tick.
+     *
+     * @param current The snapshot sent to the player.
+     * @return SharedBuffer The encoded snapshot, shared with every player who sees the same entities.
+     */
+    SharedBuffer encodeFull(const Snapshot& current) {
+        auto cached = std::find_if(fullCache_.begin(), fullCache_.end(), [&](const auto& entry) { return entry.first->states == current.states; });
+        if (cached != fullCache_.end())
+            return cached->second;
+
+        Protocol::StateUpdateWriter update(sendBuffer_);
+        for (const Protocol::EntityState& state : current.states) {
+            update.add(state);
+        }
+        update.setInputAcks(current.inputAcks);
+        SharedBuffer message = makeSharedBuffer(std::span(sendBuffer_.data(), update.finish()));
+        fullCache_.emplace_back(&current, message);
+        return message;
+    }
+
+    /**
+     * @brief Gets the delta message of a player, encoding it on first use this tick.
+     *
+     * Two players share a delta when their baselines have the same sequence and content and
+     * their current snapshots have the same content.
+     *
+     * @param baseline The snapshot the player acknowledged.
+     * @param current The snapshot sent to the player.
+     * @param fullSize Size of the full snapshot message.
+     * @return SharedBuffer The encoded delta, or nullptr if the delta is not smaller.
+     */
+    SharedBuffer encodeDelta(const Snapshot& baseline, const Snapshot& current, std::size_t fullSize) {
+        auto cached = std::find_if(deltaCache_.begin(), deltaCache_.end(), [&](const DeltaEntry& entry) {
+            return entry.baseline->sequence == baseline.sequence && entry.baseline->states == baseline.states &&
+                   entry.current->states == current.states;
+        });
+        if (cached != deltaCache_.end())
+            return cached->message;
+
+        std::size_t deltaSize = Protocol::StateDelta::encode(baseline, current, deltaBuffer_);
+        SharedBuffer delta;
+        if (deltaSize > 0 && deltaSize < fullSize)
+            delta = makeSharedBuffer(std::span(deltaBuffer_.data(), deltaSize));
+        deltaCache_.push_back({&baseline, &current, delta});
+        return delta;
+    }
+
+    /**
+     * @brief Writes the messages queued for every player during the tick.
+     *
+     * Each client is sent the events of its tick as a single frame, ahead of its snapshot.
+     * Defeated players' clients are flushed too, and released once their events are delivered
+     * or their deadline passed.
+     *
+     * @param now The time of the tick.
+     */
+    void flushClients(Clock::time_point now) {
+        for (Player& player : players_) {
+            if (player.suspended)
+                continue;
+            sendEvents(*player.client, player.events, player.reliableEvents);
+            snapshotChannel_.flushReliable(player.client->getId(), now);
+            player.client->flush();
+        }
+        for (auto it = departures_.begin(); it != departures_.end();) {
+            int clientId = it->client->getId();
+            sendEvents(*it->client, it->events, it->reliableEvents);
+            snapshotChannel_.flushReliable(clientId, now);
+            it->client->flush();
+            if (!snapshotChannel_.isDelivered(clientId) && now < it->deadline) {
+                ++it;
+                continue;
+            }
+            it->client->disconnectAfterFlush();
+            snapshotChannel_.unregisterClient(clientId);
+            it = departures_.erase(it);
+        }
+    }
+
+    int id_;                                                            ///< Unique identifier of the match.
+    int maxPlayers_;                                                    ///< Number of players required to start.
+    SnapshotChannel& snapshotChannel_;                                  ///< UDP channel shared by every match.
+    State state_ = State::WAITING;                                      ///< Lifecycle state.
+    Clock::time_point now_;                                             ///< Time of the tick in progress, for the collision callback.
+    Clock::time_point startTime_;                                       ///< When a STARTING match starts.
+    Clock::time_point nextEnemySpawn_;                                  ///< When the next enemy spawns.
+    std::vector<Player> players_;                                       ///< Players of the match.
+    std::vector<Departure> departures_;                                 ///< Defeated players' clients waiting for their events to be delivered.
+    std::mutex joinMutex_;                                              ///< Protects the join fields below against the IO threads.
+    int reservedSlots_ = 0;                                             ///< Slots taken by joined clients, admitted or not.
+    std::vector<PendingSession> pendingJoins_;                          ///< Clients joined since the previous tick.
+    std::vector<PendingSession> pendingResumes_;                        ///< Clients resumed since the previous tick.
+    std::unordered_set<std::uint64_t> resumableTokens_;                 ///< Tokens of the sessions that can still be resumed.
+    std::vector<std::shared_ptr<Client>> pendingSpectators_;            ///< Spectators joined since the previous tick.
+    bool acceptingSpectators_ = true;                                   ///< Whether spectators can still join.
+    Registry registry;                                                  ///< Manages entities and components.
+    std::shared_ptr<EnemyMovementSystem> enemyMovementSystem;           ///< System for enemy movement logic.
+    std::shared_ptr<CollisionSystem> collisionSystem;                   ///< System for collision detection and handling.
+    std::set<int> activeEnemies;                                        ///< Set of active enemy entity IDs.
+    std::uint32_t snapshotSequence_ = 0;                                ///< Sequence number of the next snapshot.
+    std::vector<Protocol::InputAck> inputAcks_;                         ///< Inputs applied to each player during the tick.
+    ViewRect view_;                                                     ///< View rectangle of new players.
+    PriorityWeights priorityWeights_;                                   ///< How fast entities gain priority in snapshots.
+    Snapshot world_;                                                    ///< Every replicated entity at the current tick.
+    Snapshot previousWorld_;                                            ///< Every replicated entity at the previous tick, for speeds.
+    SpatialGrid grid_{GameUtilities::INTEREST_CELL_SIZE};               ///< Entities of world_ by position.
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> sendBuffer_;   ///< Scratch buffer full snapshots are encoded into.
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> deltaBuffer_;  ///< Scratch buffer deltas are encoded into.
+    std::vector<std::pair<const Snapshot*, SharedBuffer>> fullCache_;   ///< Full snapshots encoded this tick, by content; cleared, not freed.
+    std::vector<DeltaEntry> deltaCache_;                                ///< Deltas encoded this tick, by baseline and content; cleared, not freed.
+    std::vector<Protocol::WorldEntity> worldEntities_;                  ///< Scratch list of the entities of a WORLD_STATE.
+    SpectatorFeed spectatorFeed_;                                       ///< Streams the match to its spectators.
+};
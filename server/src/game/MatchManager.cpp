@@ -0,0 +1,201 @@
+#include "MatchManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "../utilities/RandomUtilities.hpp"
+
+/**
+ * @brief Constructs a new Match Manager object.
+ *
+ * @param snapshotChannel The UDP channel snapshots are streamed on.
+ * @param playersPerMatch The number of players required for a match to start.
+ * @param workerCount The number of worker threads; 0 starts one per hardware thread.
+ * @param maxMatches The largest number of matches hosted at once.
+ * @param spectatorDelay How far behind their match spectators are.
+ */
+MatchManager::MatchManager(SnapshotChannel& snapshotChannel, int playersPerMatch, unsigned workerCount, std::size_t maxMatches,
+                           std::chrono::milliseconds spectatorDelay)
+    : snapshotChannel_(snapshotChannel), playersPerMatch_(playersPerMatch), maxMatches_(maxMatches), spectatorDelay_(spectatorDelay) {
+    if (workerCount == 0)
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < workerCount; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+}
+
+/**
+ * @brief Places a newly connected client into an open match.
+ *
+ * Matches are filled in creation order, so players are not spread thinly over many
+ * waiting matches. The client's session token is recorded with the match it joins;
+ * tokens of finished matches are forgotten on the way.
+ *
+ * @param client The newly connected client.
+ */
+void MatchManager::place(const std::shared_ptr<Client>& client) {
+    std::lock_guard<std::mutex> lock(placementMutex_);
+    std::erase_if(openMatches_, [](const std::shared_ptr<Match>& match) { return !match->isOpen(); });
+    std::erase_if(sessions_, [](const auto& session) { return session.second.expired(); });
+    std::uint64_t token = RandomUtilities::getRandomSessionToken();
+    for (const std::shared_ptr<Match>& match : openMatches_) {
+        if (match->join(client, token)) {
+            sessions_[token] = match;
+            return;
+        }
+    }
+
+    std::shared_ptr<Match> match = openMatch();
+    if (!match) {
+        std::cerr << "Match limit of " << maxMatches_ << " reached, rejecting client " << client->getId() << "." << std::endl;
+        snapshotChannel_.unregisterClient(client->getId());
+        client->disconnectAfterFlush();
+        return;
+    }
+    match->join(client, token);
+    sessions_[token] = match;
+    openMatches_.push_back(std::move(match));
+}
+
+/**
+ * @brief Hands a reconnected client back to the match holding its session.
+ *
+ * A token whose match is gone, or whose player already left it, is forgotten.
+ *
+ * @param client The reconnected client.
+ * @param token The session token the client presented.
+ * @return true if the session's match took the client, false otherwise.
+ */
+bool MatchManager::resume(const std::shared_ptr<Client>& client, std::uint64_t token) {
+    std::lock_guard<std::mutex> lock(placementMutex_);
+    auto session = sessions_.find(token);
+    if (session == sessions_.end())
+        return false;
+    std::shared_ptr<Match> match = session->second.lock();
+    if (match && match->resume(client, token))
+        return true;
+    sessions_.erase(session);
+    return false;
+}
+
+/**
+ * @brief Adds a spectator to the oldest match still running.
+ *
+ * Matches that ended since the spectator was routed to them refuse it, so the next one
+ * is tried.
+ *
+ * @param client The spectator's session.
+ */
+void MatchManager::spectate(const std::shared_ptr<Client>& client) {
+    std::lock_guard<std::mutex> lock(placementMutex_);
+    std::erase_if(hostedMatches_, [](const std::weak_ptr<Match>& match) { return match.expired(); });
+    for (const std::weak_ptr<Match>& hosted : hostedMatches_) {
+        std::shared_ptr<Match> match = hosted.lock();
+        if (match && match->spectate(client))
+            return;
+    }
+
+    std::shared_ptr<Match> match = openMatch();
+    if (!match) {
+        std::cerr << "Match limit of " << maxMatches_ << " reached, rejecting spectator " << client->getId() << "." << std::endl;
+        snapshotChannel_.unregisterClient(client->getId());
+        client->disconnectAfterFlush();
+        return;
+    }
+    match->spectate(client);
+    openMatches_.push_back(std::move(match));
+}
+
+/**
+ * @brief Opens a new match on the least loaded worker.
+ *
+ * @return std::shared_ptr<Match> The new match, or nullptr if the match limit is reached.
+ */
+std::shared_ptr<Match> MatchManager::openMatch() {
+    if (getMatchCount() >= maxMatches_)
+        return nullptr;
+    Worker& worker = **std::min_element(workers_.begin(), workers_.end(),
+                                        [](const auto& a, const auto& b) { return a->load.load() < b->load.load(); });
+    auto match = std::make_shared<Match>(nextMatchId_++, playersPerMatch_, snapshotChannel_, spectatorDelay_);
+    hostedMatches_.push_back(match);
+    ++worker.load;
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.incoming.push_back(match);
+    return match;
+}
+
+/**
+ * @brief Runs the workers until stop() is called.
+ */
+void MatchManager::run() {
+    running_ = true;
+    std::cout << "Ticking matches on " << workers_.size() << " worker(s)." << std::endl;
+    for (std::unique_ptr<Worker>& worker : workers_) {
+        worker->thread = std::thread([this, &worker]() { runWorker(*worker); });
+    }
+    for (std::unique_ptr<Worker>& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+/**
+ * @brief Asks the workers to return after their current tick.
+ */
+void MatchManager::stop() {
+    running_ = false;
+}
+
+/**
+ * @brief Gets the number of matches currently hosted.
+ *
+ * @return std::size_t The match count.
+ */
+std::size_t MatchManager::getMatchCount() const {
+    std::size_t count = 0;
+    for (const std::unique_ptr<Worker>& worker : workers_) {
+        count += worker->load.load();
+    }
+    return count;
+}
+
+/**
+ * @brief Main loop of a worker.
+ *
+ * Ticks are scheduled every Protocol::TICK_INTERVAL_MS, the rate at which clients sample
+ * their input. A worker that falls behind skips the missed ticks rather than running them
+ * back to back.
+ *
+ * @param worker The worker.
+ */
+void MatchManager::runWorker(Worker& worker) {
+    const std::chrono::milliseconds tickInterval(Protocol::TICK_INTERVAL_MS);
+    auto nextTick = Match::Clock::now();
+
+    while (running_) {
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            for (std::shared_ptr<Match>& match : worker.incoming) {
+                worker.matches.push_back(std::move(match));
+            }
+            worker.incoming.clear();
+        }
+
+        auto tickTime = Match::Clock::now();
+        for (const std::shared_ptr<Match>& match : worker.matches) {
+            match->tick(tickTime);
+        }
+        std::erase_if(worker.matches, [&worker](const std::shared_ptr<Match>& match) {
+            if (!match->isFinished())
+                return false;
+            std::cout << "Match " << match->getId() << " finished." << std::endl;
+            --worker.load;
+            return true;
+        });
+        snapshotChannel_.flush();
+
+        nextTick += tickInterval;
+        auto now = Match::Clock::now();
+        if (nextTick < now)
+            nextTick = now;
+        std::this_thread::sleep_until(nextTick);
+    }
+}
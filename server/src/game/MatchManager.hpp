@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Client.hpp"
+#include "Match.hpp"
+#include "SnapshotChannel.hpp"
+
+/**
+ * @class MatchManager
+ * @brief Hosts many concurrent matches in one process.
+ *
+ * New clients are placed into the oldest match that still has a free slot, and a new
+ * match is opened when none has. Matches are sharded across a fixed pool of workers: each
+ * match is assigned to the least loaded worker when it is created and stays there, so its
+ * registry and systems are only ever touched by one thread. Every worker ticks all of its
+ * matches on the fixed server tick, then flushes the snapshot datagrams they queued in one
+ * batch. Finished matches are destroyed by their worker.
+ *
+ * Every placed client is given a random session token, recorded with its match, so a
+ * client whose connection drops can reconnect and be handed back to its match. Spectators
+ * are not placed: they watch the oldest match still running, without taking a slot.
+ */
+class MatchManager {
+   public:
+    /**
+     * @brief Constructs a new Match Manager object.
+     *
+     * @param snapshotChannel The UDP channel snapshots are streamed on.
+     * @param playersPerMatch The number of players required for a match to start.
+     * @param workerCount The number of worker threads; 0 starts one per hardware thread.
+     * @param maxMatches The largest number of matches hosted at once.
+     * @param spectatorDelay How far behind their match spectators are.
+     */
+    MatchManager(SnapshotChannel& snapshotChannel, int playersPerMatch, unsigned workerCount, std::size_t maxMatches,
+                 std::chrono::milliseconds spectatorDelay);
+
+    /**
+     * @brief Places a newly connected client into an open match.
+     *
+     * Called from the IO threads. If the match limit is reached, the client is disconnected.
+     *
+     * @param client The newly connected client.
+     */
+    void place(const std::shared_ptr<Client>& client);
+
+    /**
+     * @brief Hands a reconnected client back to the match holding its session.
+     *
+     * Called from the IO threads.
+     *
+     * @param client The reconnected client.
+     * @param token The session token the client presented.
+     * @return true if the session's match took the client, false if the token is unknown or expired.
+     */
+    bool resume(const std::shared_ptr<Client>& client, std::uint64_t token);
+
+    /**
+     * @brief Adds a spectator to the oldest match still running.
+     *
+     * Called from the IO threads. With no match to watch, a new one is opened, which the
+     * next players fill; if the match limit is reached, the spectator is disconnected.
+     *
+     * @param client The spectator's session.
+     */
+    void spectate(const std::shared_ptr<Client>& client);
+
+    /**
+     * @brief Runs the workers until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Asks the workers to return after their current tick.
+     */
+    void stop();
+
+    /**
+     * @brief Gets the number of matches currently hosted.
+     *
+     * @return std::size_t The match count.
+     */
+    std::size_t getMatchCount() const;
+
+   private:
+    /**
+     * @struct Worker
+     * @brief A thread ticking a shard of the matches.
+     */
+    struct Worker {
+        std::thread thread;                            ///< The worker thread.
+        std::mutex mutex;                              ///< Protects incoming between placement and the worker.
+        std::vector<std::shared_ptr<Match>> incoming;  ///< Matches assigned since the previous tick.
+        std::vector<std::shared_ptr<Match>> matches;   ///< Matches ticked by the worker; only touched by its thread.
+        std::atomic<std::size_t> load{0};              ///< Matches assigned and not finished yet.
+    };
+
+    /**
+     * @brief Main loop of a worker.
+     *
+     * @param worker The worker.
+     */
+    void runWorker(Worker& worker);
+
+    /**
+     * @brief Opens a new match on the least loaded worker.
+     *
+     * @return std::shared_ptr<Match> The new match, or nullptr if the match limit is reached.
+     */
+    std::shared_ptr<Match> openMatch();
+
+    SnapshotChannel& snapshotChannel_;                                  ///< UDP channel shared by every match.
+    int playersPerMatch_;                                               ///< Number of players required for a match to start.
+    std::size_t maxMatches_;                                            ///< Largest number of matches hosted at once.
+    std::chrono::milliseconds spectatorDelay_;                          ///< How far behind their match spectators are.
+    std::vector<std::unique_ptr<Worker>> workers_;                      ///< Worker pool.
+    std::mutex placementMutex_;                                         ///< Protects the placement fields below.
+    std::vector<std::shared_ptr<Match>> openMatches_;                   ///< Matches that may still have a free slot, oldest first.
+    std::vector<std::weak_ptr<Match>> hostedMatches_;                   ///< Every match opened, oldest first; expired ones are purged.
+    std::unordered_map<std::uint64_t, std::weak_ptr<Match>> sessions_;  ///< Match of every placed session, by token.
+    int nextMatchId_ = 1;                                               ///< Identifier of the next match.
+    std::atomic<bool> running_{false};                                  ///< Whether the workers keep ticking.
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Message.hpp"
+
+/**
+ * @class OutboundFrame
+ * @brief The events a match sends one client during a tick, encoded back to back.
+ *
+ * Spawns, despawns, deaths and game-over notices are appended as they happen during the
+ * tick, each encoded in place after the previous one, so the client receives them in the
+ * order the tick produced them. The whole frame is handed to the client's session once,
+ * when the tick is flushed: one send queue entry and one shared buffer per client per
+ * tick, rather than one per event. The buffer is cleared, not freed, so a steady tick
+ * does not allocate.
+ */
+class OutboundFrame {
+   public:
+    /**
+     * @brief Appends an event to the frame.
+     *
+     * @tparam Payload One of the fixed-size payload structs of the Protocol namespace.
+     * @param payload The event.
+     */
+    template <typename Payload>
+    void add(const Payload& payload) {
+        std::size_t offset = bytes_.size();
+        bytes_.resize(offset + Protocol::HEADER_SIZE + Payload::SIZE);
+        Message::serialize(payload, std::span<std::uint8_t>(bytes_).subspan(offset));
+    }
+
+    /**
+     * @brief Checks whether the frame holds no event.
+     *
+     * @return true if nothing was added since the last clear(), false otherwise.
+     */
+    bool empty() const { return bytes_.empty(); }
+
+    /**
+     * @brief Gets the encoded events.
+     *
+     * @return std::span<const std::uint8_t> The messages, back to back.
+     */
+    std::span<const std::uint8_t> bytes() const { return bytes_; }
+
+    /**
+     * @brief Discards the events, keeping the buffer for the next tick.
+     */
+    void clear() { bytes_.clear(); }
+
+   private:
+    std::vector<std::uint8_t> bytes_;  ///< Encoded events of the tick.
+};
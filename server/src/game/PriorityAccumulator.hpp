@@ -0,0 +1,208 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Message.hpp"
+#include "Quantization.hpp"
+#include "Snapshot.hpp"
+
+/**
+ * @struct PriorityWeights
+ * @brief How fast entities gain priority in a client's snapshots.
+ *
+ * Every tick an entity is out of date on the client, its priority grows by its type weight,
+ * scaled up by its speed and down by its distance to the client's player:
+ * weight * (1 + speed / speedScale) / (1 + distance / distanceScale).
+ */
+struct PriorityWeights {
+    float playerWeight;   ///< Priority gained per tick by a player entity.
+    float enemyWeight;    ///< Priority gained per tick by an enemy entity.
+    float speedScale;     ///< Speed, in units per tick, that doubles the priority gained.
+    float distanceScale;  ///< Distance at which the priority gained is halved.
+};
+
+/**
+ * @class PriorityAccumulator
+ * @brief Fits the snapshot of one client into a per-tick byte budget.
+ *
+ * Each entity of the client's area of interest accumulates priority for as long as the
+ * client's copy of it is out of date. Every tick, the out-of-date entities are taken by
+ * decreasing priority until the budget is spent; those sent start over from zero, the
+ * others keep their priority and are deferred to a later tick, where they will rank higher.
+ * The client's own player is always sent, since its prediction is reconciled against it.
+ *
+ * A deferred entity is not dropped from the snapshot: it keeps the state the client was
+ * last sent, so the client neither removes it nor sees it jump back, and a delta omits it
+ * as unchanged. Entities whose quantized state did not change cost nothing and never
+ * compete for the budget.
+ */
+class PriorityAccumulator {
+   public:
+    /**
+     * @brief Constructs an accumulator with no entity.
+     *
+     * @param weights How fast entities gain priority.
+     * @param quantization The position quantization snapshots are encoded with.
+     */
+    explicit PriorityAccumulator(const PriorityWeights& weights,
+                                 const Protocol::PositionQuantization& quantization = Protocol::DEFAULT_POSITION_QUANTIZATION)
+        : weights_(weights), quantization_(quantization) {}
+
+    /**
+     * @brief Builds the snapshot sent to the client this tick.
+     *
+     * @param world Every replicated entity at this tick, sorted.
+     * @param previousWorld Every replicated entity at the previous tick, sorted; used to estimate speeds.
+     * @param interest The entities of the client's area of interest, sorted.
+     * @param playerId The client's player entity, always sent.
+     * @param isPlayer Callable taking an entity ID, true if the entity is a player.
+     * @param budgetBytes The largest snapshot message to build.
+     * @param out Filled with the states to send and every input acknowledgement of world.
+     */
+    template <typename IsPlayer>
+    void select(const Snapshot& world, const Snapshot& previousWorld, const std::vector<std::int32_t>& interest, std::int32_t playerId,
+                IsPlayer&& isPlayer, std::size_t budgetBytes, Snapshot& out) {
+        track(interest);
+        const Protocol::EntityState* center = world.find(playerId);
+        candidates_.clear();
+        for (std::size_t i = 0; i < entries_.size(); ++i) {
+            Entry& entry = entries_[i];
+            const Protocol::EntityState* state = world.find(entry.entityId);
+            entry.fresh = state != nullptr;
+            if (!state)
+                continue;
+            entry.current = *state;
+            if (entry.sent && sameOnWire(entry.current, entry.lastSent))
+                continue;
+            if (entry.entityId != playerId)
+                entry.priority += gain(entry, previousWorld.find(entry.entityId), center, isPlayer(entry.entityId));
+            candidates_.push_back(i);
+        }
+        std::sort(candidates_.begin(), candidates_.end(),
+                  [&](std::size_t a, std::size_t b) { return ranksBefore(entries_[a], entries_[b], playerId); });
+
+        std::size_t budgetBits = budgetBytes * 8;
+        std::size_t usedBits = overheadBits(world.inputAcks.size());
+        std::size_t stateBits = 8 + 2 + quantization_.x.bits + quantization_.y.bits;  // Assumes a one-byte ID gap
+        deferred_ = 0;
+        for (std::size_t index : candidates_) {
+            Entry& entry = entries_[index];
+            if (entry.entityId != playerId && usedBits + stateBits > budgetBits) {
+                ++deferred_;
+                continue;
+            }
+            usedBits += stateBits;
+            entry.lastSent = entry.current;
+            entry.sent = true;
+            entry.priority = 0.0f;
+        }
+
+        for (const Entry& entry : entries_) {
+            if (entry.sent && entry.fresh)
+                out.states.push_back(entry.lastSent);
+        }
+        out.inputAcks.assign(world.inputAcks.begin(), world.inputAcks.end());
+    }
+
+    /**
+     * @brief Gets the number of out-of-date entities left out of the last snapshot.
+     *
+     * @return std::size_t The deferred entity count.
+     */
+    std::size_t getDeferredCount() const { return deferred_; }
+
+   private:
+    /**
+     * @struct Entry
+     * @brief Replication state of one entity for the client.
+     */
+    struct Entry {
+        std::int32_t entityId = 0;       ///< Identifier of the entity.
+        float priority = 0.0f;           ///< Priority accumulated since the entity was last sent.
+        bool sent = false;               ///< Whether the client was sent a state of the entity.
+        bool fresh = false;              ///< Whether the entity is in the world this tick.
+        Protocol::EntityState lastSent;  ///< State the client was last sent.
+        Protocol::EntityState current;   ///< State of the entity this tick.
+    };
+
+    /**
+     * @brief Aligns the entries with the area of interest, keeping the priority of the entities still in it.
+     *
+     * @param interest The entities of the area of interest, sorted.
+     */
+    void track(const std::vector<std::int32_t>& interest) {
+        next_.clear();
+        auto entry = entries_.begin();
+        for (std::int32_t entityId : interest) {
+            while (entry != entries_.end() && entry->entityId < entityId)
+                ++entry;
+            if (entry != entries_.end() && entry->entityId == entityId) {
+                next_.push_back(*entry);
+            } else {
+                next_.emplace_back();
+                next_.back().entityId = entityId;
+            }
+        }
+        entries_.swap(next_);
+    }
+
+    /**
+     * @brief Computes the priority an out-of-date entity gains this tick.
+     *
+     * @param entry The entity.
+     * @param previous The entity's state at the previous tick, or nullptr if it is new.
+     * @param center The client's player, or nullptr if it has no entity.
+     * @param player Whether the entity is a player.
+     * @return float The priority gained.
+     */
+    float gain(const Entry& entry, const Protocol::EntityState* previous, const Protocol::EntityState* center, bool player) const {
+        float speed = previous ? std::hypot(entry.current.x - previous->x, entry.current.y - previous->y) : 0.0f;
+        float distance = center ? std::hypot(entry.current.x - center->x, entry.current.y - center->y) : 0.0f;
+        float weight = player ? weights_.playerWeight : weights_.enemyWeight;
+        return weight * (1.0f + speed / weights_.speedScale) / (1.0f + distance / weights_.distanceScale);
+    }
+
+    /**
+     * @brief Orders the candidates: the client's player, then entities never sent, then by priority.
+     *
+     * @param a The first entity.
+     * @param b The second entity.
+     * @param playerId The client's player entity.
+     * @return true if a is sent before b.
+     */
+    static bool ranksBefore(const Entry& a, const Entry& b, std::int32_t playerId) {
+        if ((a.entityId == playerId) != (b.entityId == playerId))
+            return a.entityId == playerId;
+        if (a.sent != b.sent)
+            return !a.sent;
+        return a.priority > b.priority;
+    }
+
+    /**
+     * @brief Checks whether two states encode to the same position.
+     *
+     * @param a The first state.
+     * @param b The second state.
+     * @return true if the client would see no difference.
+     */
+    bool sameOnWire(const Protocol::EntityState& a, const Protocol::EntityState& b) const {
+        return quantization_.x.encode(a.x) == quantization_.x.encode(b.x) && quantization_.y.encode(a.y) == quantization_.y.encode(b.y);
+    }
+
+    /**
+     * @brief Estimates the size of a snapshot message carrying no entity.
+     *
+     * @param inputAcks The number of input acknowledgements it carries.
+     * @return std::size_t The header, counts, baseline and acknowledgement table, in bits.
+     */
+    static std::size_t overheadBits(std::size_t inputAcks) { return Protocol::HEADER_SIZE * 8 + 32 + 16 + 16 + 16 + inputAcks * (8 + 32); }
+
+    PriorityWeights weights_;                      ///< How fast entities gain priority.
+    Protocol::PositionQuantization quantization_;  ///< Quantization deciding whether a state changed on the wire.
+    std::vector<Entry> entries_;                   ///< Entities of the area of interest, sorted by ID.
+    std::vector<Entry> next_;                      ///< Scratch entries of the update in progress.
+    std::vector<std::size_t> candidates_;          ///< Out-of-date entities of the tick, by decreasing rank.
+    std::size_t deferred_ = 0;                     ///< Out-of-date entities left out of the last snapshot.
+};
@@ -0,0 +1,398 @@
+#include "SnapshotChannel.hpp"
+#include <array>
+#include <iostream>
+#include "../utilities/RandomUtilities.hpp"
+
+/**
+ * @brief Constructs a new Snapshot Channel bound to the given local endpoint.
+ *
+ * @param io_context ASIO IO context for asynchronous operations.
+ * @param endpoint The local UDP endpoint to listen on.
+ */
+SnapshotChannel::SnapshotChannel(asio::io_context& io_context, const asio::ip::udp::endpoint& endpoint)
+    : socket_(io_context, endpoint), receiveBuffer_(Datagram::MAX_SIZE) {}
+
+/**
+ * @brief Registers a client and generates its bind token.
+ *
+ * @param clientId The unique identifier of the client.
+ * @return std::uint32_t The bind token to send to the client over TCP.
+ */
+std::uint32_t SnapshotChannel::registerClient(int clientId) {
+    auto binding = std::make_unique<Binding>();
+    std::unique_lock<std::shared_mutex> lock(bindingsMutex_);
+    auto previous = bindings_.find(clientId);
+    if (previous != bindings_.end()) {
+        tokens_.erase(previous->second->token);
+        unbindEndpoint(clientId, *previous->second);
+    }
+    do {
+        binding->token = RandomUtilities::getRandomToken();
+    } while (tokens_.contains(binding->token));
+    std::uint32_t token = binding->token;
+    tokens_[token] = clientId;
+    bindings_[clientId] = std::move(binding);
+    return token;
+}
+
+/**
+ * @brief Forgets a client and its UDP endpoint.
+ *
+ * @param clientId The unique identifier of the client.
+ */
+void SnapshotChannel::unregisterClient(int clientId) {
+    std::unique_lock<std::shared_mutex> lock(bindingsMutex_);
+    auto it = bindings_.find(clientId);
+    if (it == bindings_.end())
+        return;
+    tokens_.erase(it->second->token);
+    unbindEndpoint(clientId, *it->second);
+    bindings_.erase(it);
+}
+
+/**
+ * @brief Checks whether a client's UDP endpoint is known.
+ *
+ * @param clientId The unique identifier of the client.
+ * @return true if the client is bound, false otherwise.
+ */
+bool SnapshotChannel::isBound(int clientId) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    return findBound(clientId) != nullptr;
+}
+
+/**
+ * @brief Gets the newest snapshot a client acknowledged.
+ *
+ * @param clientId The unique identifier of the client.
+ * @param sequence Filled with the sequence number of the acknowledged snapshot.
+ * @return true if the client acknowledged a snapshot, false otherwise.
+ */
+bool SnapshotChannel::getAcknowledged(int clientId, std::uint32_t& sequence) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    Binding* binding = findBound(clientId);
+    if (!binding)
+        return false;
+    std::lock_guard<std::mutex> bindingLock(binding->mutex);
+    if (!binding->acknowledged)
+        return false;
+    sequence = binding->ackedSequence;
+    return true;
+}
+
+/**
+ * @brief Starts an asynchronous receive for the next client datagram.
+ */
+void SnapshotChannel::startReceive() {
+    socket_.async_receive_from(asio::buffer(receiveBuffer_), senderEndpoint_, [this](std::error_code ec, std::size_t length) {
+        if (!ec) {
+            handleDatagram(length);
+            startReceive();
+        } else if (ec != asio::error::operation_aborted) {
+            std::cerr << "UDP receive failed: " << ec.message() << std::endl;
+            startReceive();
+        }
+    });
+}
+
+/**
+ * @brief Dispatches a datagram received from a client by message type.
+ *
+ * @param length Size of the datagram in bytes.
+ */
+void SnapshotChannel::handleDatagram(std::size_t length) {
+    std::uint32_t sequence = 0;
+    std::span<const std::uint8_t> bytes;
+    Message message;
+
+    if (!Datagram::decode(std::span<const std::uint8_t>(receiveBuffer_.data(), length), sequence, bytes) ||
+        !Message::deserialize(bytes, message))
+        return;
+
+    Protocol::UdpBindPayload bind;
+    Protocol::SnapshotAckPayload ack;
+    if (message.type() == RFC::RELIABLE)
+        handleReliable(message);
+    else if (message.decode(bind))
+        handleBind(bind);
+    else if (message.decode(ack))
+        handleAck(ack);
+}
+
+/**
+ * @brief Binds the sender's endpoint to the client whose token the message carries.
+ *
+ * Clients repeat their bind until it takes effect, so an already bound endpoint is only
+ * checked under the shared lock.
+ *
+ * @param bind The received bind payload.
+ */
+void SnapshotChannel::handleBind(const Protocol::UdpBindPayload& bind) {
+    {
+        std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+        auto token = tokens_.find(bind.token);
+        if (token == tokens_.end())
+            return;
+        Binding* binding = findBound(token->second);
+        if (binding && binding->endpoint == senderEndpoint_)
+            return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(bindingsMutex_);
+    auto token = tokens_.find(bind.token);
+    if (token == tokens_.end())
+        return;
+    int clientId = token->second;
+    Binding& binding = *bindings_.at(clientId);
+    if (!binding.bound)
+        std::cout << "Client " << clientId << " bound UDP endpoint " << senderEndpoint_ << std::endl;
+    unbindEndpoint(clientId, binding);
+    binding.endpoint = senderEndpoint_;
+    binding.bound = true;
+    endpoints_[senderEndpoint_] = clientId;
+}
+
+/**
+ * @brief Records the snapshot acknowledged by the client bound to the sender.
+ *
+ * Acknowledgements can arrive out of order; only the newest one is kept.
+ *
+ * @param ack The received acknowledgement payload.
+ */
+void SnapshotChannel::handleAck(const Protocol::SnapshotAckPayload& ack) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    Binding* binding = findSender();
+    if (!binding)
+        return;
+    std::lock_guard<std::mutex> bindingLock(binding->mutex);
+    if (!binding->acknowledged || Datagram::isNewer(ack.sequence, binding->ackedSequence)) {
+        binding->acknowledged = true;
+        binding->ackedSequence = ack.sequence;
+    }
+}
+
+/**
+ * @brief Passes a reliable packet to the channel of the client bound to the sender.
+ *
+ * Clients send no reliable messages of their own yet, so the packet only carries
+ * acknowledgements; anything it delivers is ignored.
+ *
+ * @param packet The received RELIABLE message.
+ */
+void SnapshotChannel::handleReliable(const Message& packet) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    Binding* binding = findSender();
+    if (!binding)
+        return;
+    std::lock_guard<std::mutex> bindingLock(binding->mutex);
+    binding->reliable.receive(packet, std::chrono::steady_clock::now(), [](const Message&) {});
+}
+
+/**
+ * @brief Finds the client bound to the sender of the datagram being received.
+ *
+ * Must be called with the binding tables locked.
+ *
+ * @return Binding* The client's binding, or nullptr if the sender is unknown.
+ */
+SnapshotChannel::Binding* SnapshotChannel::findSender() {
+    auto endpoint = endpoints_.find(senderEndpoint_);
+    return endpoint != endpoints_.end() ? findBound(endpoint->second) : nullptr;
+}
+
+/**
+ * @brief Forgets the endpoint a client was bound to, if it still designates that client.
+ *
+ * Another client may have bound the same endpoint since, in which case it keeps it. Must
+ * be called with the binding tables locked exclusively.
+ *
+ * @param clientId The unique identifier of the client.
+ * @param binding The client's binding.
+ */
+void SnapshotChannel::unbindEndpoint(int clientId, const Binding& binding) {
+    if (!binding.bound)
+        return;
+    auto endpoint = endpoints_.find(binding.endpoint);
+    if (endpoint != endpoints_.end() && endpoint->second == clientId)
+        endpoints_.erase(endpoint);
+}
+
+/**
+ * @brief Finds the binding of a client whose endpoint is known.
+ *
+ * Must be called with the binding tables locked.
+ *
+ * @param clientId The unique identifier of the client.
+ * @return Binding* The client's binding, or nullptr if the client is unknown or not bound yet.
+ */
+SnapshotChannel::Binding* SnapshotChannel::findBound(int clientId) {
+    auto it = bindings_.find(clientId);
+    return it != bindings_.end() && it->second->bound ? it->second.get() : nullptr;
+}
+
+/**
+ * @brief Appends datagrams to the batch of the next flush().
+ *
+ * May be called with a client locked: pendingMutex_ is always taken last.
+ *
+ * @param datagrams The datagrams; left empty.
+ */
+void SnapshotChannel::enqueue(std::vector<PendingDatagram>& datagrams) {
+    if (datagrams.empty())
+        return;
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    for (PendingDatagram& datagram : datagrams)
+        pending_.push_back(std::move(datagram));
+    datagrams.clear();
+}
+
+/**
+ * @brief Queues a shared message for a bound client.
+ *
+ * @param clientId The unique identifier of the client.
+ * @param message The shared encoded message.
+ * @param sequence The sequence number of the datagram.
+ * @return true if the message was queued, false otherwise.
+ */
+bool SnapshotChannel::queue(int clientId, const SharedBuffer& message, std::uint32_t sequence) {
+    if (message->size() > Datagram::MAX_MESSAGE_SIZE)
+        return false;
+
+    PendingDatagram datagram;
+    {
+        std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+        Binding* binding = findBound(clientId);
+        if (!binding)
+            return false;
+        datagram.endpoint = binding->endpoint;
+    }
+    Datagram::encodeHeader(sequence, datagram.prefix);
+    datagram.message = message;
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    pending_.push_back(std::move(datagram));
+    return true;
+}
+
+/**
+ * @brief Queues messages for reliable, ordered delivery to a bound client.
+ *
+ * Each message encoded back to back in the buffer is queued as its own reliable message,
+ * with the client locked once.
+ *
+ * @param clientId The unique identifier of the client.
+ * @param messages The encoded messages, back to back.
+ * @return true if every message was queued, false otherwise.
+ */
+bool SnapshotChannel::sendReliable(int clientId, std::span<const std::uint8_t> messages) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    Binding* binding = findBound(clientId);
+    if (!binding)
+        return false;
+    std::lock_guard<std::mutex> bindingLock(binding->mutex);
+    while (!messages.empty()) {
+        Message message;
+        if (!Message::deserialize(messages, message) || !binding->reliable.send(messages.first(message.size())))
+            return false;
+        messages = messages.subspan(message.size());
+    }
+    return true;
+}
+
+/**
+ * @brief Queues the reliable packets due to a client: new and timed out messages, and acknowledgements.
+ *
+ * Packets go out with sequence 0, like the other control datagrams; the snapshot sequence
+ * only orders snapshots, and a packet carries its own sequence. The packets are built
+ * into the client's outbox with only the client locked, then appended to the pending
+ * batch together; the outbox keeps its capacity for the next tick.
+ *
+ * @param clientId The unique identifier of the client.
+ * @param now The current time.
+ */
+void SnapshotChannel::flushReliable(int clientId, std::chrono::steady_clock::time_point now) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    Binding* binding = findBound(clientId);
+    if (!binding)
+        return;
+    std::array<std::uint8_t, ReliableChannel::MAX_PACKET_SIZE> buffer;
+    std::lock_guard<std::mutex> bindingLock(binding->mutex);
+    while (std::size_t size = binding->reliable.writePacket(now, buffer)) {
+        PendingDatagram& datagram = binding->outbox.emplace_back();
+        datagram.endpoint = binding->endpoint;
+        Datagram::encodeHeader(0, datagram.prefix);
+        datagram.message = makeSharedBuffer(std::span(buffer.data(), size));
+    }
+    enqueue(binding->outbox);
+}
+
+/**
+ * @brief Checks whether a client acknowledged every reliable message sent to it.
+ *
+ * @param clientId The unique identifier of the client.
+ * @return true if nothing is pending or the client is not bound, false otherwise.
+ */
+bool SnapshotChannel::isDelivered(int clientId) {
+    std::shared_lock<std::shared_mutex> lock(bindingsMutex_);
+    Binding* binding = findBound(clientId);
+    if (!binding)
+        return true;
+    std::lock_guard<std::mutex> bindingLock(binding->mutex);
+    return binding->reliable.getPendingCount() == 0;
+}
+
+/**
+ * @brief Sends every queued message as a datagram.
+ *
+ * On Linux the whole batch goes through sendmmsg, so the syscall count does not grow
+ * with the number of clients. Elsewhere, one send_to is issued per client. The batch is
+ * taken from the queue under its lock, and sent without holding any: workers flushing
+ * at once each send what they took, and the others keep queueing meanwhile.
+ *
+ * @return std::size_t The number of datagrams handed to the kernel.
+ */
+std::size_t SnapshotChannel::flush() {
+    std::size_t sent = 0;
+    Batch taken;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex_);
+        if (!spareBatches_.empty()) {
+            taken = std::move(spareBatches_.back());
+            spareBatches_.pop_back();
+        }
+        taken.datagrams.swap(pending_);  // pending_ inherits the spare's capacity
+    }
+    std::vector<PendingDatagram>& batch = taken.datagrams;
+
+#ifdef __linux__
+    std::vector<mmsghdr>& headers = taken.headers;
+    std::vector<iovec>& iovecs = taken.iovecs;
+    headers.assign(batch.size(), mmsghdr{});
+    iovecs.resize(batch.size() * 2);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        iovecs[i * 2] = {batch[i].prefix.data(), batch[i].prefix.size()};
+        iovecs[i * 2 + 1] = {const_cast<std::uint8_t*>(batch[i].message->data()), batch[i].message->size()};
+        headers[i].msg_hdr.msg_name = batch[i].endpoint.data();
+        headers[i].msg_hdr.msg_namelen = static_cast<socklen_t>(batch[i].endpoint.size());
+        headers[i].msg_hdr.msg_iov = &iovecs[i * 2];
+        headers[i].msg_hdr.msg_iovlen = 2;
+    }
+    while (sent < headers.size()) {
+        int result = ::sendmmsg(socket_.native_handle(), headers.data() + sent, static_cast<unsigned int>(headers.size() - sent), 0);
+        if (result <= 0)
+            break;  // Socket buffer full or error: the remaining snapshots are dropped, the next tick supersedes them
+        sent += static_cast<std::size_t>(result);
+    }
+#else
+    for (const PendingDatagram& datagram : batch) {
+        std::array<asio::const_buffer, 2> buffers = {asio::buffer(datagram.prefix), asio::buffer(datagram.message->data(), datagram.message->size())};
+        asio::error_code ec;
+        socket_.send_to(buffers, datagram.endpoint, 0, ec);
+        if (!ec)
+            ++sent;
+    }
+#endif
+    batch.clear();
+    std::lock_guard<std::mutex> lock(pendingMutex_);
+    spareBatches_.push_back(std::move(taken));
+    return sent;
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include <array>
+#include <asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+#include "../../libs/ecs/Datagram.hpp"
+#include "../../libs/ecs/Message.hpp"
+#include "../../libs/ecs/ReliableChannel.hpp"
+#include "../../libs/ecs/SharedBuffer.hpp"
+
+/**
+ * @class SnapshotChannel
+ * @brief UDP channel used to stream state snapshots and events to clients.
+ *
+ * Snapshots are superseded every tick, so retransmitting a lost one (as TCP does) only
+ * delays the newer ones behind it. This channel sends each snapshot as a sequenced
+ * datagram instead and lets clients discard late ones. Events (new entities, deaths,
+ * game over) must arrive, in order, and go through each client's ReliableChannel: its
+ * packets travel in their own datagrams, so an event is neither held back by a lost
+ * snapshot nor stuck behind queued ones in the TCP stream.
+ *
+ * A client's UDP endpoint is learned by having it echo a random token, sent to it over
+ * TCP in a UDP_BIND message, in a datagram to the server. Until then, callers should keep
+ * sending snapshots over TCP. Clients acknowledge the snapshots they apply with SNAPSHOT_ACK
+ * datagrams, which lets the server delta-encode against them.
+ *
+ * Datagrams are queued per client then sent together by flush(); on Linux, the whole
+ * batch is issued as a single sendmmsg call. Queued messages are shared buffers, so a
+ * message sent to many clients is stored once. Each datagram carries its own sequence
+ * number, so the matches ticked by one worker share a single flush per tick.
+ *
+ * Match workers and IO threads use the channel concurrently. The binding tables are only
+ * locked exclusively to register, bind or forget a client; every other call shares them,
+ * and then locks the one client it touches. Received datagrams find their client by
+ * token or endpoint in constant time, whatever the number of clients. The queue of pending datagrams is locked
+ * only to append to it or take it, and flush() sends the batch it took without holding
+ * any lock, so workers never wait for each other's syscalls. Batches and their syscall
+ * descriptors are recycled, so flushing does not allocate once the queue reached its size.
+ */
+class SnapshotChannel {
+   public:
+    /**
+     * @brief Constructs a new Snapshot Channel bound to the given local endpoint.
+     *
+     * @param io_context ASIO IO context for asynchronous operations.
+     * @param endpoint The local UDP endpoint to listen on.
+     */
+    SnapshotChannel(asio::io_context& io_context, const asio::ip::udp::endpoint& endpoint);
+
+    /**
+     * @brief Registers a client and generates the token it must echo to bind its endpoint.
+     *
+     * @param clientId The unique identifier of the client.
+     * @return std::uint32_t The bind token to send to the client over TCP.
+     */
+    std::uint32_t registerClient(int clientId);
+
+    /**
+     * @brief Forgets a client and its UDP endpoint.
+     *
+     * @param clientId The unique identifier of the client.
+     */
+    void unregisterClient(int clientId);
+
+    /**
+     * @brief Checks whether a client's UDP endpoint is known.
+     *
+     * @param clientId The unique identifier of the client.
+     * @return true if snapshots can be sent to the client over UDP, false otherwise.
+     */
+    bool isBound(int clientId);
+
+    /**
+     * @brief Starts asynchronously receiving bind and acknowledgement datagrams from clients.
+     */
+    void startReceive();
+
+    /**
+     * @brief Gets the newest snapshot a client acknowledged.
+     *
+     * @param clientId The unique identifier of the client.
+     * @param sequence Filled with the sequence number of the acknowledged snapshot.
+     * @return true if the client acknowledged a snapshot since it was registered, false otherwise.
+     */
+    bool getAcknowledged(int clientId, std::uint32_t& sequence);
+
+    /**
+     * @brief Queues a message for a bound client; it is sent by the next flush().
+     *
+     * @param clientId The unique identifier of the client.
+     * @param message The shared encoded message, at most Datagram::MAX_MESSAGE_SIZE bytes.
+     * @param sequence The sequence number of the datagram.
+     * @return true if the message was queued, false if the client is not bound or the message is too large.
+     */
+    bool queue(int clientId, const SharedBuffer& message, std::uint32_t sequence);
+
+    /**
+     * @brief Queues messages for reliable, ordered delivery to a bound client.
+     *
+     * @param clientId The unique identifier of the client.
+     * @param messages The encoded messages, back to back, each at most ReliableChannel::MAX_MESSAGE_SIZE bytes.
+     * @return true if every message was queued, false if the client is not bound, a message is malformed or too large, or too many are unacknowledged.
+     */
+    bool sendReliable(int clientId, std::span<const std::uint8_t> messages);
+
+    /**
+     * @brief Queues the reliable packets due to a client; they are sent by the next flush().
+     *
+     * @param clientId The unique identifier of the client.
+     * @param now The current time.
+     */
+    void flushReliable(int clientId, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Checks whether a client acknowledged every reliable message sent to it.
+     *
+     * @param clientId The unique identifier of the client.
+     * @return true if nothing is pending or the client is not bound, false otherwise.
+     */
+    bool isDelivered(int clientId);
+
+    /**
+     * @brief Sends every queued message as a datagram.
+     *
+     * @return std::size_t The number of datagrams handed to the kernel.
+     */
+    std::size_t flush();
+
+   private:
+    /**
+     * @struct PendingDatagram
+     * @brief A message queued for the next flush().
+     */
+    struct PendingDatagram {
+        asio::ip::udp::endpoint endpoint;                        ///< Destination of the datagram.
+        std::array<std::uint8_t, Datagram::HEADER_SIZE> prefix;  ///< Encoded sequence number.
+        SharedBuffer message;                                    ///< The message the datagram carries.
+    };
+
+    /**
+     * @struct Binding
+     * @brief UDP binding state of a registered client.
+     *
+     * The token, bound flag and endpoint only change with the binding tables locked
+     * exclusively, so they can be read under the shared lock alone.
+     */
+    struct Binding {
+        std::uint32_t token = 0;              ///< Token the client must echo.
+        bool bound = false;                   ///< Whether the endpoint below is known.
+        asio::ip::udp::endpoint endpoint;     ///< The client's UDP endpoint.
+        std::mutex mutex;                     ///< Protects the fields below between the IO threads and the match's worker.
+        bool acknowledged = false;            ///< Whether ackedSequence below is known.
+        std::uint32_t ackedSequence = 0;      ///< Newest snapshot the client acknowledged.
+        ReliableChannel reliable;             ///< Events sent to the client and their acknowledgements.
+        std::vector<PendingDatagram> outbox;  ///< Reliable packets being built; emptied into the batch, capacity kept.
+    };
+
+    /**
+     * @struct EndpointHash
+     * @brief Hash function object for UDP endpoints, by address and port.
+     */
+    struct EndpointHash {
+        /**
+         * @brief Generates a hash value for an endpoint.
+         *
+         * @param endpoint The endpoint to hash.
+         * @return std::size_t The resulting hash value.
+         */
+        std::size_t operator()(const asio::ip::udp::endpoint& endpoint) const {
+            std::size_t hash = std::hash<unsigned short>()(endpoint.port());
+            const asio::ip::address& address = endpoint.address();
+            if (address.is_v4()) {
+                hash ^= std::hash<std::uint32_t>()(address.to_v4().to_uint()) * 31;
+            } else {
+                for (unsigned char byte : address.to_v6().to_bytes())
+                    hash = hash * 31 + byte;
+            }
+            return hash;
+        }
+    };
+
+    /**
+     * @struct Batch
+     * @brief Datagrams taken by a flush(), with the syscall descriptors built for them.
+     *
+     * Batches are returned to a spare list once sent and swapped with the pending queue by
+     * the next flush(), so in a steady state no flush allocates.
+     */
+    struct Batch {
+        std::vector<PendingDatagram> datagrams;  ///< The datagrams to send.
+#ifdef __linux__
+        std::vector<mmsghdr> headers;  ///< Per-datagram headers of the sendmmsg call.
+        std::vector<iovec> iovecs;     ///< Prefix and message buffers of every datagram.
+#endif
+    };
+
+    /**
+     * @brief Handles a datagram received from a client.
+     *
+     * @param length Size of the datagram in bytes.
+     */
+    void handleDatagram(std::size_t length);
+
+    /**
+     * @brief Binds the sender to the client whose token the message carries.
+     *
+     * @param bind The received bind payload.
+     */
+    void handleBind(const Protocol::UdpBindPayload& bind);
+
+    /**
+     * @brief Records the snapshot acknowledged by the client bound to the sender.
+     *
+     * @param ack The received acknowledgement payload.
+     */
+    void handleAck(const Protocol::SnapshotAckPayload& ack);
+
+    /**
+     * @brief Passes a reliable packet to the channel of the client bound to the sender.
+     *
+     * @param packet The received RELIABLE message.
+     */
+    void handleReliable(const Message& packet);
+
+    /**
+     * @brief Finds the client bound to the sender of the datagram being received.
+     *
+     * @return Binding* The client's binding, or nullptr if the sender is unknown.
+     */
+    Binding* findSender();
+
+    /**
+     * @brief Forgets the endpoint a client was bound to, if it still designates that client.
+     *
+     * @param clientId The unique identifier of the client.
+     * @param binding The client's binding.
+     */
+    void unbindEndpoint(int clientId, const Binding& binding);
+
+    /**
+     * @brief Finds the binding of a client whose endpoint is known.
+     *
+     * @param clientId The unique identifier of the client.
+     * @return Binding* The client's binding, or nullptr if the client is not bound.
+     */
+    Binding* findBound(int clientId);
+
+    /**
+     * @brief Appends datagrams to the batch of the next flush().
+     *
+     * @param datagrams The datagrams; left empty.
+     */
+    void enqueue(std::vector<PendingDatagram>& datagrams);
+
+    asio::ip::udp::socket socket_;                                              ///< The UDP socket shared by all clients.
+    asio::ip::udp::endpoint senderEndpoint_;                                    ///< Sender of the datagram being received.
+    std::vector<std::uint8_t> receiveBuffer_;                                   ///< Buffer for receiving client datagrams.
+    std::unordered_map<int, std::unique_ptr<Binding>> bindings_;                ///< UDP binding state, by client ID.
+    std::unordered_map<std::uint32_t, int> tokens_;                             ///< Client ID of every bind token.
+    std::unordered_map<asio::ip::udp::endpoint, int, EndpointHash> endpoints_;  ///< Client ID of every bound endpoint.
+    std::shared_mutex bindingsMutex_;                                           ///< Protects the three tables above; shared by lookups.
+    std::vector<PendingDatagram> pending_;                                      ///< Datagrams queued for the next flush.
+    std::vector<Batch> spareBatches_;                                           ///< Sent batches, reused by the next flushes.
+    std::mutex pendingMutex_;                                                   ///< Protects pending_ and spareBatches_ only.
+};
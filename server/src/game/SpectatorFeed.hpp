@@ -0,0 +1,302 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "Client.hpp"
+#include "Message.hpp"
+#include "SharedBuffer.hpp"
+#include "Snapshot.hpp"
+#include "SnapshotChannel.hpp"
+
+/**
+ * @class SpectatorFeed
+ * @brief Streams a match to its spectators, optionally delayed.
+ *
+ * Every tick, the match records its world: the state of every entity, and which entities
+ * appeared, died or vanished since the previous tick. A recorded tick is released once
+ * it is older than the delay: its events and its snapshot are encoded once, into shared
+ * buffers, and every spectator is handed the same buffers. A spectator therefore costs a
+ * queued pointer per message rather than an encoding, and the match's tick time barely
+ * depends on how many watch it.
+ *
+ * The feed keeps a copy of the world as of the last released tick. A joining spectator is
+ * sent it as a WORLD_STATE, then follows the broadcast. Unlike players, spectators see
+ * the whole match. Snapshots go over UDP to spectators that bound it and over TCP to the
+ * others; events always go over TCP, in order.
+ *
+ * Only used by the worker ticking the match.
+ */
+class SpectatorFeed {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< Clock the ticks are recorded with.
+
+    /**
+     * @brief Constructs a feed without spectators.
+     *
+     * @param snapshotChannel The UDP channel snapshots are streamed on.
+     * @param delay How far behind the match the spectators are.
+     */
+    SpectatorFeed(SnapshotChannel& snapshotChannel, std::chrono::milliseconds delay) : snapshotChannel_(snapshotChannel), delay_(delay) {}
+
+    /**
+     * @brief Adds a spectator; it is sent the world with the next released tick.
+     *
+     * @param client The spectator's session.
+     */
+    void add(std::shared_ptr<Client> client) { spectators_.push_back({std::move(client), false}); }
+
+    /**
+     * @brief Gets the number of spectators.
+     *
+     * @return std::size_t The spectator count.
+     */
+    std::size_t size() const { return spectators_.size(); }
+
+    /**
+     * @brief Checks whether every recorded tick was released.
+     *
+     * @return true if no tick waits for the delay to elapse, false otherwise.
+     */
+    bool isDrained() const { return frames_.empty(); }
+
+    /**
+     * @brief Records that an entity died this tick, rather than just vanished.
+     *
+     * @param entityId Unique identifier of the dead entity.
+     */
+    void recordDeath(std::int32_t entityId) { deaths_.push_back(entityId); }
+
+    /**
+     * @brief Records the world at the end of a tick.
+     *
+     * @tparam TypeOf Callable taking the std::int32_t ID of an entity and returning its EntityType.
+     * @param world Every replicated entity at this tick, sorted.
+     * @param typeOf Gives the type of the entities that appeared this tick.
+     * @param now The time of the tick.
+     */
+    template <typename TypeOf>
+    void record(const Snapshot& world, TypeOf&& typeOf, Clock::time_point now) {
+        Frame frame;
+        if (!spare_.empty()) {
+            frame = std::move(spare_.back());
+            spare_.pop_back();
+        }
+        frame.time = now;
+        frame.world.sequence = world.sequence;
+        frame.world.states.assign(world.states.begin(), world.states.end());
+        frame.spawned.clear();
+        frame.died.clear();
+        frame.vanished.clear();
+
+        auto live = live_.begin();
+        for (const Protocol::EntityState& state : world.states) {
+            for (; live != live_.end() && *live < state.entityId; ++live)
+                recordRemoval(*live, frame);
+            if (live != live_.end() && *live == state.entityId)
+                ++live;
+            else
+                frame.spawned.push_back({state.entityId, typeOf(state.entityId), state.x, state.y});
+        }
+        for (; live != live_.end(); ++live)
+            recordRemoval(*live, frame);
+        deaths_.clear();
+
+        live_.clear();
+        for (const Protocol::EntityState& state : world.states)
+            live_.push_back(state.entityId);
+        frames_.push_back(std::move(frame));
+    }
+
+    /**
+     * @brief Streams the recorded ticks that are older than the delay.
+     *
+     * The events of every released tick are sent to the spectators already following the
+     * broadcast. The joining spectators are then sent the world as a WORLD_STATE, and every
+     * spectator the snapshot of the newest released tick, before its session is flushed.
+     * Spectators whose connection dropped are forgotten.
+     *
+     * @param now The time of the tick.
+     */
+    void release(Clock::time_point now) {
+        std::erase_if(spectators_, [this](const Spectator& spectator) {
+            if (!spectator.client->isClosed())
+                return false;
+            snapshotChannel_.unregisterClient(spectator.client->getId());
+            return true;
+        });
+
+        bool released = false;
+        while (!frames_.empty() && now - frames_.front().time >= delay_) {
+            Frame& frame = frames_.front();
+            if (!spectators_.empty())
+                broadcastEvents(frame);
+            apply(frame);
+            spare_.push_back(std::move(frame));
+            frames_.pop_front();
+            released = true;
+        }
+        if (!released || spectators_.empty())
+            return;
+
+        SharedBuffer worldState;
+        Protocol::StateUpdateWriter update(buffer_);
+        for (const Protocol::WorldEntity& entity : world_)
+            update.add({entity.entityId, entity.x, entity.y});
+        SharedBuffer snapshot = makeSharedBuffer(std::span(buffer_.data(), update.finish()));
+        for (Spectator& spectator : spectators_) {
+            if (!spectator.synced) {
+                if (!worldState)
+                    worldState = makeSharedBuffer(std::span(buffer_.data(), Protocol::WorldState::encode(world_, buffer_)));
+                spectator.client->send(worldState);
+                spectator.synced = true;
+            }
+            if (!snapshotChannel_.queue(spectator.client->getId(), snapshot, sequence_))
+                spectator.client->sendSnapshot(snapshot);
+            spectator.client->flush();
+        }
+    }
+
+    /**
+     * @brief Disconnects every spectator once its queued messages are written.
+     */
+    void close() {
+        for (Spectator& spectator : spectators_) {
+            snapshotChannel_.unregisterClient(spectator.client->getId());
+            spectator.client->disconnectAfterFlush();
+        }
+        spectators_.clear();
+    }
+
+   private:
+    /**
+     * @struct Spectator
+     * @brief A client watching the match.
+     */
+    struct Spectator {
+        std::shared_ptr<Client> client;  ///< The spectator's session.
+        bool synced;                     ///< Whether it was sent the world and follows the broadcast.
+    };
+
+    /**
+     * @struct Frame
+     * @brief A recorded tick, waiting for the delay to elapse.
+     */
+    struct Frame {
+        Clock::time_point time;                      ///< When the tick ran.
+        Snapshot world;                              ///< Every replicated entity at the tick.
+        std::vector<Protocol::WorldEntity> spawned;  ///< Entities that appeared at the tick.
+        std::vector<std::int32_t> died;              ///< Entities that died at the tick.
+        std::vector<std::int32_t> vanished;          ///< Entities removed at the tick without dying.
+    };
+
+    /**
+     * @brief Records an entity of the previous tick missing from the current one.
+     *
+     * @param entityId Unique identifier of the entity.
+     * @param frame The frame being recorded.
+     */
+    void recordRemoval(std::int32_t entityId, Frame& frame) {
+        if (std::find(deaths_.begin(), deaths_.end(), entityId) != deaths_.end())
+            frame.died.push_back(entityId);
+        else
+            frame.vanished.push_back(entityId);
+    }
+
+    /**
+     * @brief Sends the events of a released tick to the spectators following the broadcast.
+     *
+     * The events are encoded back to back into one shared message buffer. A tick with more
+     * events than fit in buffer_ is sent as several buffers, in order.
+     *
+     * @param frame The released tick.
+     */
+    void broadcastEvents(const Frame& frame) {
+        std::size_t size = 0;
+        auto add = [this, &size](const auto& payload) {
+            std::size_t written = Message::serialize(payload, std::span(buffer_).subspan(size));
+            if (written == 0) {
+                sendToSynced(size);
+                size = 0;
+                written = Message::serialize(payload, buffer_);
+            }
+            size += written;
+        };
+        for (const Protocol::WorldEntity& entity : frame.spawned) {
+            Protocol::NewEntityPayload newEntity;
+            newEntity.entityId = entity.entityId;
+            newEntity.entityType = entity.entityType;
+            add(newEntity);
+        }
+        for (std::int32_t entityId : frame.died) {
+            Protocol::EntityDeadPayload death;
+            death.entityId = entityId;
+            add(death);
+        }
+        for (std::int32_t entityId : frame.vanished) {
+            Protocol::EntityDespawnPayload despawn;
+            despawn.entityId = entityId;
+            add(despawn);
+        }
+        sendToSynced(size);
+    }
+
+    /**
+     * @brief Sends the start of buffer_ to the spectators following the broadcast.
+     *
+     * @param size Number of encoded bytes at the start of buffer_; nothing is sent if 0.
+     */
+    void sendToSynced(std::size_t size) {
+        if (size == 0)
+            return;
+        SharedBuffer events = makeSharedBuffer(std::span(buffer_.data(), size));
+        for (Spectator& spectator : spectators_) {
+            if (spectator.synced)
+                spectator.client->send(events);
+        }
+    }
+
+    /**
+     * @brief Moves the feed's copy of the world to a released tick.
+     *
+     * @param frame The released tick.
+     */
+    void apply(const Frame& frame) {
+        next_.clear();
+        auto previous = world_.begin();
+        auto spawned = frame.spawned.begin();
+        for (const Protocol::EntityState& state : frame.world.states) {
+            while (previous != world_.end() && previous->entityId < state.entityId)
+                ++previous;
+            EntityType type = EntityType::ENEMY;
+            if (previous != world_.end() && previous->entityId == state.entityId) {
+                type = previous->entityType;
+            } else {
+                while (spawned != frame.spawned.end() && spawned->entityId < state.entityId)
+                    ++spawned;
+                if (spawned != frame.spawned.end() && spawned->entityId == state.entityId)
+                    type = spawned->entityType;
+            }
+            next_.push_back({state.entityId, type, state.x, state.y});
+        }
+        std::swap(world_, next_);
+        sequence_ = frame.world.sequence;
+    }
+
+    SnapshotChannel& snapshotChannel_;                             ///< UDP channel shared by every match.
+    std::chrono::milliseconds delay_;                              ///< How far behind the match the spectators are.
+    std::vector<Spectator> spectators_;                            ///< Spectators of the match.
+    std::deque<Frame> frames_;                                     ///< Recorded ticks not released yet, oldest first.
+    std::vector<Frame> spare_;                                     ///< Released frames, reused by the next records.
+    std::vector<std::int32_t> live_;                               ///< Entities of the last recorded tick, sorted.
+    std::vector<std::int32_t> deaths_;                             ///< Entities that died since the last recorded tick.
+    std::vector<Protocol::WorldEntity> world_;                     ///< Every entity as of the last released tick, sorted.
+    std::vector<Protocol::WorldEntity> next_;                      ///< Scratch copy of the world being released.
+    std::uint32_t sequence_ = 0;                                   ///< Sequence number of the last released tick.
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> buffer_;  ///< Scratch buffer the broadcast is encoded into.
+};
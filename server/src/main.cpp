@@ -3,14 +3,40 @@
  * @brief Entry point for the server application.
  *
  * This file contains the main function, which is the starting point for the server.
- * It initializes the MainServer object and starts the server. If the application
- * receives any command-line arguments, it displays help information.
+ * It initializes the MainServer object and starts the server. If the command-line
+ * arguments are invalid, it displays help information.
  */
 
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
 #include "CommonDefs.hpp"
 #include "core/MainServer.hpp"
 #include "utilities/HelpUtilities.hpp"
 
+/**
+ * @brief Parses a non-negative integer argument, such as a thread count or a delay.
+ *
+ * @param arg The argument.
+ * @param name The name of the argument, used in the error message.
+ * @param count Filled with the parsed value; for thread counts, 0 means one per hardware thread.
+ * @return true if the whole argument is a non-negative integer, false otherwise.
+ */
+static bool parseCount(const char* arg, const char* name, unsigned& count) {
+    const char* end = arg + std::strlen(arg);
+    unsigned parsed = 0;
+    auto [stop, error] = std::from_chars(arg, end, parsed);
+    if (error != std::errc() || stop != end) {
+        std::cerr << "Error: " << name << " must be a non-negative integer." << std::endl;
+        return false;
+    }
+    count = parsed;
+    return true;
+}
+
 /**
  * @brief The main function, entry point for the server application.
  *
@@ -20,16 +46,47 @@
  *         non-zero otherwise.
  */
 int main(int ac, char** av) {
-    if (ac != 2) {
+    std::vector<const char*> args;
+    std::optional<NetworkConditions> conditions;
+    std::chrono::milliseconds spectatorDelay(GameUtilities::SPECTATOR_DELAY_MS);
+    for (int i = 1; i < ac; i++) {
+        if (std::string(av[i]) == "--spectator-delay") {
+            unsigned delay = 0;
+            if (++i >= ac || !parseCount(av[i], "--spectator-delay", delay))
+                return ServerUtilities::help(84);
+            spectatorDelay = std::chrono::milliseconds(delay);
+            continue;
+        }
+        if (std::string(av[i]) != "--netsim") {
+            args.push_back(av[i]);
+            continue;
+        }
+        NetworkConditions parsed;
+        if (++i >= ac || !NetworkConditions::parse(av[i], parsed)) {
+            std::cerr << "Error: --netsim expects settings such as latency=80,jitter=20,loss=2." << std::endl;
+            return ServerUtilities::help(84);
+        }
+        conditions = parsed;
+    }
+    if (args.empty() || args.size() > 3) {
         return ServerUtilities::help(84);
     }
 
-    int maxPlayers = std::stoi(av[1]);
+    unsigned maxPlayers = 0;
+    if (!parseCount(args[0], "max_players", maxPlayers))
+        return ServerUtilities::help(84);
     if (maxPlayers < 1 || maxPlayers > 4) {
         std::cerr << "Error: max_players must be between 1 and 4." << std::endl;
         return ServerUtilities::help(84);
     }
 
+    unsigned ioThreads = GameUtilities::IO_THREADS;
+    unsigned matchWorkers = GameUtilities::MATCH_WORKERS;
+    if (args.size() >= 2 && !parseCount(args[1], "io_threads", ioThreads))
+        return ServerUtilities::help(84);
+    if (args.size() >= 3 && !parseCount(args[2], "match_workers", matchWorkers))
+        return ServerUtilities::help(84);
+
     MainServer server;
-    return server.start(maxPlayers);
+    return server.start(static_cast<int>(maxPlayers), ioThreads, matchWorkers, conditions, spectatorDelay);
 }
\ No newline at end of file
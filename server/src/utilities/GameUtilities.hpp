@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <random>
 #include <string>
 
@@ -12,14 +14,37 @@
  */
 namespace GameUtilities {
 
-const int SERVER_PORT = 4242;             ///< The port number for the server.
-const int SCREEN_WIDTH = 1920;            ///< The width of the game screen.
-const int SCREEN_HEIGHT = 1000;           ///< The height of the game screen.
-const int MAX_ENEMIES = 5;                ///< The maximum number of enemies allowed on screen.
-const float ENEMY_SPEED = 300.0f;         ///< The speed of enemy entities.
-const float ENEMY_WIDTH = 50.0f;          ///< The width of enemy entities.
-const float ENEMY_HEIGHT = 50.0f;         ///< The height of enemy entities.
-const float PLAYER_WIDTH = 40.0f;         ///< The width of player entities.
-const float PLAYER_HEIGHT = 30.0f;        ///< The height of player entities.
-const float OFF_SCREEN_X = -ENEMY_WIDTH;  ///< X-coordinate value representing an off-screen position to the left.
+const int SERVER_PORT = 4242;                                 ///< The port number for the server.
+const int SIMULATED_SERVER_PORT = SERVER_PORT + 1;            ///< The port the server moves to when the network simulator takes SERVER_PORT.
+const int SCREEN_WIDTH = 1920;                                ///< The width of the game screen.
+const int SCREEN_HEIGHT = 1000;                               ///< The height of the game screen.
+const int MAX_ENEMIES = 5;                                    ///< The maximum number of enemies allowed on screen.
+const float ENEMY_SPEED = 300.0f;                             ///< The speed of enemy entities.
+const float ENEMY_WIDTH = 50.0f;                              ///< The width of enemy entities.
+const float ENEMY_HEIGHT = 50.0f;                             ///< The height of enemy entities.
+const float PLAYER_WIDTH = 40.0f;                             ///< The width of player entities.
+const float PLAYER_HEIGHT = 30.0f;                            ///< The height of player entities.
+const float OFF_SCREEN_X = -ENEMY_WIDTH;                      ///< X-coordinate value representing an off-screen position to the left.
+const bool FLUSH_PER_TICK = true;                             ///< Whether TCP messages are held until the end of the tick and written together.
+const std::size_t SEND_QUEUE_THROTTLE_BYTES = 64 * 1024;      ///< Per-client send queue size from which snapshots are dropped.
+const std::size_t SEND_QUEUE_DISCONNECT_BYTES = 1024 * 1024;  ///< Per-client send queue size from which the client is disconnected.
+const unsigned IO_THREADS = 0;                                ///< Threads running network IO; 0 starts one per hardware thread.
+const unsigned MATCH_WORKERS = 0;                             ///< Threads ticking matches; 0 starts one per hardware thread.
+const std::size_t MAX_MATCHES = 512;                          ///< Largest number of matches hosted by one process.
+const int MATCH_START_DELAY_MS = 1000;                        ///< Delay between a match filling up and its start.
+const float VIEW_HALF_WIDTH = SCREEN_WIDTH;                   ///< Horizontal reach of a player's view; covers the screen from anywhere on it.
+const float VIEW_HALF_HEIGHT = SCREEN_HEIGHT;                 ///< Vertical reach of a player's view; covers the screen from anywhere on it.
+const float VIEW_MARGIN = 100.0f;                             ///< Distance past the view edge before an entity is despawned.
+const float INTEREST_CELL_SIZE = 256.0f;                      ///< Cell side of the spatial grid used to find the entities in view.
+const std::size_t SNAPSHOT_BUDGET_BYTES = 1200;               ///< Default per-client snapshot size per tick; fits one datagram.
+const std::size_t MIN_SNAPSHOT_BUDGET_BYTES = 256;            ///< Smallest snapshot size per tick a client can ask for.
+const int HANDSHAKE_TIMEOUT_MS = 5000;                        ///< Time a new connection has to send HELLO.
+const std::uint32_t CAPABILITIES = ~0u;                       ///< Capability bits offered to clients; clear one to roll its feature back.
+const int RESUME_WINDOW_MS = 10000;                           ///< Time a player whose connection dropped is kept for it to resume.
+const int SPECTATOR_DELAY_MS = 0;                             ///< Default delay of the spectators behind their match.
+const int GAME_OVER_LINGER_MS = 2000;                         ///< Longest wait for a defeated player to acknowledge GAME_OVER.
+const float PLAYER_PRIORITY_WEIGHT = 2.0f;                    ///< Priority a player entity gains per tick while out of date.
+const float ENEMY_PRIORITY_WEIGHT = 1.0f;                     ///< Priority an enemy entity gains per tick while out of date.
+const float PRIORITY_SPEED_SCALE = 10.0f;                     ///< Speed, in units per tick, that doubles the priority gained.
+const float PRIORITY_DISTANCE_SCALE = 960.0f;                 ///< Distance to the player at which the priority gained is halved.
 }  // namespace GameUtilities
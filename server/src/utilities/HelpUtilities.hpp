@@ -1,5 +1,6 @@
 #pragma once
 #include <iostream>
+#include "GameUtilities.hpp"
 
 /**
  * @namespace ServerUtilities
@@ -20,8 +21,15 @@ namespace ServerUtilities {
      * @return int The return value provided as an argument (used for exiting the program with a specific status).
      */
 static int help(const int returnValue) {
-    std::cout << "USAGE:\n\t./r-type_server [max_players]\n"
-              << "max_players: 1, 2, or 3 - Maximum number of players required for the game to start." << std::endl;
+    std::cout << "USAGE:\n\t./r-type_server [max_players] [io_threads] [match_workers] [--netsim settings] [--spectator-delay ms]\n"
+              << "max_players: 1 to 4 - Number of players required for each match to start.\n"
+              << "io_threads: optional - Number of network IO threads, 0 (default) for one per hardware thread.\n"
+              << "match_workers: optional - Number of threads ticking matches, 0 (default) for one per hardware thread.\n"
+              << "--netsim: optional - Impairs every client's traffic, e.g. latency=80,jitter=20,loss=2,reorder=1,bandwidth=512,seed=7\n"
+              << "          (milliseconds, percents and kilobits per second); the server then also listens on port "
+              << GameUtilities::SIMULATED_SERVER_PORT << ".\n"
+              << "--spectator-delay: optional - Milliseconds spectators are kept behind the match, " << GameUtilities::SPECTATOR_DELAY_MS
+              << " by default." << std::endl;
     return returnValue;
 }
 }  // namespace ServerUtilities
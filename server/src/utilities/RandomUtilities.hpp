@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <random>
 
 /**
@@ -42,4 +43,34 @@ class RandomUtilities {
         std::uniform_int_distribution<> dis(minSeconds, maxSeconds);
         return dis(gen);
     }
+
+    /**
+     * @brief Generates a random 32-bit token.
+     *
+     * This function is used to create hard-to-guess identifiers, such as the token
+     * a client echoes to bind its UDP endpoint to its session.
+     * 
+     * @return std::uint32_t A random non-zero token.
+     */
+    static std::uint32_t getRandomToken() {
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<std::uint32_t> dis(1, UINT32_MAX);
+        return dis(gen);
+    }
+
+    /**
+     * @brief Generates a random 64-bit token.
+     *
+     * This function is used for secrets that outlive a connection, such as the token
+     * a client presents to resume its session after reconnecting.
+     *
+     * @return std::uint64_t A random non-zero token.
+     */
+    static std::uint64_t getRandomSessionToken() {
+        std::random_device rd;
+        std::mt19937_64 gen((static_cast<std::uint64_t>(rd()) << 32) | rd());
+        std::uniform_int_distribution<std::uint64_t> dis(1, UINT64_MAX);
+        return dis(gen);
+    }
 };
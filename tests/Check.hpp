@@ -0,0 +1,52 @@
+#pragma once
+
+#include <iostream>
+
+/**
+ * @namespace Check
+ * @brief Minimal assertion helpers shared by the test executables.
+ *
+ * A failed CHECK prints its location and expression and the test goes on, so one run
+ * reports every failure; the executable returns Check::result() to CTest.
+ */
+namespace Check {
+
+/**
+ * @brief Gets the number of failed checks, shared by the whole executable.
+ *
+ * @return int& The failure count.
+ */
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+/**
+ * @brief Records the outcome of a check.
+ *
+ * @param passed Whether the checked expression held.
+ * @param expression The checked expression, as written.
+ * @param file The file of the check.
+ * @param line The line of the check.
+ */
+inline void record(bool passed, const char* expression, const char* file, int line) {
+    if (passed)
+        return;
+    ++failures();
+    std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+}
+
+/**
+ * @brief Gets the exit code of the test executable.
+ *
+ * @return int 0 if every check passed, 1 otherwise.
+ */
+inline int result() {
+    if (failures() != 0)
+        std::cerr << failures() << " check(s) failed." << std::endl;
+    return failures() == 0 ? 0 : 1;
+}
+
+}  // namespace Check
+
+#define CHECK(expression) Check::record(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,155 @@
+#include <array>
+#include <cstdint>
+#include <span>
+#include "BitStream.hpp"
+#include "Check.hpp"
+#include "Quantization.hpp"
+
+namespace {
+
+void testFieldsRoundTrip() {
+    std::array<std::uint8_t, 32> buffer{};
+    BitWriter writer(buffer);
+    writer.writeBits(5, 3);
+    writer.writeBool(true);
+    writer.writeBits(0xABCD, 16);
+    writer.writeBits(0xFFFFFFFFu, 32);
+    writer.writeBits(0x12345678u, 32);
+    writer.writeBits(0x1FFF, 13);
+    writer.writeBits(0, 1);
+    CHECK(writer.ok());
+    CHECK(writer.bitSize() == 3 + 1 + 16 + 32 + 32 + 13 + 1);
+    CHECK(writer.size() == (writer.bitSize() + 7) / 8);
+
+    BitReader reader(std::span<const std::uint8_t>(buffer.data(), writer.size()));
+    CHECK(reader.readBits(3) == 5);
+    CHECK(reader.readBool());
+    CHECK(reader.readBits(16) == 0xABCD);
+    CHECK(reader.readBits(32) == 0xFFFFFFFFu);
+    CHECK(reader.readBits(32) == 0x12345678u);
+    CHECK(reader.readBits(13) == 0x1FFF);
+    CHECK(!reader.readBool());
+    CHECK(reader.ok());
+    CHECK(reader.atEnd());
+}
+
+void testByteAlignedLayoutIsLittleEndian() {
+    std::array<std::uint8_t, 2> buffer{};
+    BitWriter writer(buffer);
+    writer.writeBits(0x1234, 16);
+    CHECK(buffer[0] == 0x34 && buffer[1] == 0x12);
+}
+
+void testHighBitsAreIgnored() {
+    std::array<std::uint8_t, 2> buffer{};
+    BitWriter writer(buffer);
+    writer.writeBits(0xFF, 3);
+    writer.writeBits(0, 5);
+    CHECK(buffer[0] == 0x07);
+}
+
+void testVarUIntRoundTrip() {
+    const std::array<std::uint32_t, 9> values = {0, 1, 127, 128, 16383, 16384, 0x0FFFFFFFu, 0x10000000u, 0xFFFFFFFFu};
+    const std::array<std::size_t, 9> widths = {8, 8, 8, 16, 16, 24, 32, 40, 40};
+    std::array<std::uint8_t, 64> buffer{};
+    BitWriter writer(buffer);
+    writer.writeBits(1, 3);  // Misaligns every following group
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        std::size_t before = writer.bitSize();
+        writer.writeVarUInt(values[i]);
+        CHECK(writer.bitSize() - before == widths[i]);
+    }
+    CHECK(writer.ok());
+
+    BitReader reader(std::span<const std::uint8_t>(buffer.data(), writer.size()));
+    CHECK(reader.readBits(3) == 1);
+    for (std::uint32_t value : values)
+        CHECK(reader.readVarUInt() == value);
+    CHECK(reader.ok());
+}
+
+void testVarUIntTooLongIsRejected() {
+    std::array<std::uint8_t, 6> buffer;
+    buffer.fill(0x80);
+    BitReader reader(buffer);
+    CHECK(reader.readVarUInt() == 0);
+    CHECK(!reader.ok());
+}
+
+void testWriterOverflow() {
+    std::array<std::uint8_t, 2> buffer{};
+    BitWriter writer(buffer);
+    writer.writeBits(0x3FF, 10);
+    writer.writeBits(0x7F, 7);
+    CHECK(!writer.ok());
+    CHECK(writer.bitSize() == 10);
+    writer.writeBits(1, 1);
+    CHECK(!writer.ok());
+    CHECK(writer.bitSize() == 10);
+
+    std::array<std::uint8_t, 1> small{};
+    BitWriter varint(small);
+    varint.writeVarUInt(300);
+    CHECK(!varint.ok());
+}
+
+void testReaderUnderflow() {
+    std::array<std::uint8_t, 2> buffer = {0xFF, 0x01};
+    BitReader reader(buffer);
+    CHECK(reader.readBits(9) == 0x1FF);
+    CHECK(reader.readBits(8) == 0);
+    CHECK(!reader.ok());
+    CHECK(reader.readBits(1) == 0);
+    CHECK(!reader.ok());
+
+    BitReader skipper(buffer);
+    skipper.skipBits(16);
+    CHECK(skipper.ok() && skipper.atEnd());
+    skipper.skipBits(1);
+    CHECK(!skipper.ok());
+}
+
+void testPatchBits() {
+    std::array<std::uint8_t, 8> buffer{};
+    BitWriter writer(buffer);
+    writer.writeBits(1, 3);
+    std::size_t offset = writer.bitSize();
+    writer.writeBits(0, 16);
+    writer.writeBits(0x5, 3);
+    writer.patchBits(offset, 0xBEEF, 16);
+    writer.patchBits(writer.bitSize() - 1, 1, 2);  // Past the written bits: ignored
+
+    BitReader reader(std::span<const std::uint8_t>(buffer.data(), writer.size()));
+    CHECK(reader.readBits(3) == 1);
+    CHECK(reader.readBits(16) == 0xBEEF);
+    CHECK(reader.readBits(3) == 0x5);
+    CHECK(reader.ok());
+}
+
+void testQuantizerBounds() {
+    const Quantizer& x = Protocol::DEFAULT_POSITION_QUANTIZATION.x;
+    CHECK(x.encode(x.min) == 0);
+    CHECK(x.encode(x.max) == x.maxValue());
+    CHECK(x.encode(x.min - 1000.0f) == 0);
+    CHECK(x.encode(x.max + 1000.0f) == x.maxValue());
+    for (float value = x.min; value <= x.max; value += 7.3f) {
+        std::uint32_t quantized = x.encode(value);
+        CHECK(quantized <= x.maxValue());
+        CHECK(x.decode(quantized) - value <= x.maxError() * 1.01f && value - x.decode(quantized) <= x.maxError() * 1.01f);
+    }
+}
+
+}  // namespace
+
+int main() {
+    testFieldsRoundTrip();
+    testByteAlignedLayoutIsLittleEndian();
+    testHighBitsAreIgnored();
+    testVarUIntRoundTrip();
+    testVarUIntTooLongIsRejected();
+    testWriterOverflow();
+    testReaderUnderflow();
+    testPatchBits();
+    testQuantizerBounds();
+    return Check::result();
+}
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <vector>
+#include "ByteStream.hpp"
+#include "Check.hpp"
+#include "FrameAssembler.hpp"
+
+namespace {
+
+constexpr std::size_t MESSAGES = 200000;  ///< Messages in the replayed stream.
+
+/**
+ * @brief Gets a byte of a message's payload.
+ *
+ * @param index The message's position in the stream.
+ * @param offset The byte's offset in the payload.
+ * @return std::uint8_t The byte, derived from both so a misplaced byte is noticed.
+ */
+std::uint8_t payloadByte(std::size_t index, std::size_t offset) {
+    return static_cast<std::uint8_t>(index * 31 + offset * 7);
+}
+
+/**
+ * @brief Appends an encoded message to a stream.
+ *
+ * @param stream The stream.
+ * @param index The message's position in the stream.
+ * @param payloadSize The size of its payload.
+ */
+void appendMessage(std::vector<std::uint8_t>& stream, std::size_t index, std::size_t payloadSize) {
+    std::size_t start = stream.size();
+    stream.resize(start + Protocol::HEADER_SIZE + payloadSize);
+    Protocol::MessageHeader header;
+    header.type = RFC::ENTITY_DEAD;
+    header.payloadSize = static_cast<std::uint16_t>(payloadSize);
+    ByteWriter writer(std::span<std::uint8_t>(stream.data() + start, Protocol::HEADER_SIZE));
+    header.encode(writer);
+    for (std::size_t offset = 0; offset < payloadSize; ++offset)
+        stream[start + Protocol::HEADER_SIZE + offset] = payloadByte(index, offset);
+}
+
+void testRandomSplitsDeliverEveryMessage() {
+    std::mt19937 random(42);
+    std::vector<std::size_t> sizes;
+    std::vector<std::uint8_t> stream;
+    std::uniform_int_distribution<std::size_t> smallPayload(0, 64);
+    std::uniform_int_distribution<std::size_t> largePayload(0, Protocol::MAX_PAYLOAD_SIZE);
+    for (std::size_t index = 0; index < MESSAGES; ++index) {
+        // Mostly event-sized messages, with the occasional one up to the largest a header allows
+        std::size_t size = index % 5000 == 0 ? largePayload(random) : smallPayload(random);
+        sizes.push_back(size);
+        appendMessage(stream, index, size);
+    }
+
+    FrameAssembler assembler;
+    std::size_t delivered = 0;
+    bool intact = true;
+    bool roomy = true;
+    std::uniform_int_distribution<std::size_t> readSize(1, 3 * FrameAssembler::MIN_READ_SIZE);
+    for (std::size_t sent = 0; sent < stream.size();) {
+        std::span<std::uint8_t> space = assembler.prepare();
+        roomy = roomy && space.size() >= FrameAssembler::MIN_READ_SIZE;
+        std::size_t length = std::min({space.size(), readSize(random), stream.size() - sent});
+        std::memcpy(space.data(), stream.data() + sent, length);
+        sent += length;
+        assembler.commit(length);
+        CHECK(assembler.consume([&](const Message& message) {
+            bool expected = delivered < MESSAGES && message.type() == RFC::ENTITY_DEAD && message.payload.size() == sizes[delivered];
+            for (std::size_t offset = 0; expected && offset < message.payload.size(); ++offset)
+                expected = message.payload[offset] == payloadByte(delivered, offset);
+            intact = intact && expected;
+            ++delivered;
+        }));
+    }
+    CHECK(intact);
+    CHECK(roomy);
+    CHECK(delivered == MESSAGES);
+    CHECK(assembler.pending() == 0);
+
+    // Only the partial message left at the end of a lap is moved, never the stream itself
+    CHECK(assembler.compactedBytes() < stream.size() / 50);
+}
+
+void testPartialMessageWaits() {
+    std::vector<std::uint8_t> stream;
+    appendMessage(stream, 0, 10);
+    FrameAssembler assembler;
+    std::size_t delivered = 0;
+    auto count = [&delivered](const Message&) { ++delivered; };
+
+    std::span<std::uint8_t> space = assembler.prepare();
+    std::memcpy(space.data(), stream.data(), Protocol::HEADER_SIZE + 4);
+    assembler.commit(Protocol::HEADER_SIZE + 4);
+    CHECK(assembler.consume(count));
+    CHECK(delivered == 0 && assembler.pending() == Protocol::HEADER_SIZE + 4);
+
+    space = assembler.prepare();
+    std::memcpy(space.data(), stream.data() + Protocol::HEADER_SIZE + 4, 6);
+    assembler.commit(6);
+    CHECK(assembler.consume(count));
+    CHECK(delivered == 1 && assembler.pending() == 0);
+}
+
+void testUndecodableStreamIsRejected() {
+    std::vector<std::uint8_t> stream;
+    appendMessage(stream, 0, 4);
+    stream[0] = Protocol::VERSION + 1;
+    FrameAssembler assembler;
+    std::span<std::uint8_t> space = assembler.prepare();
+    std::memcpy(space.data(), stream.data(), stream.size());
+    assembler.commit(stream.size());
+    CHECK(!assembler.consume([](const Message&) {}));
+}
+
+}  // namespace
+
+int main() {
+    testRandomSplitsDeliverEveryMessage();
+    testPartialMessageWaits();
+    testUndecodableStreamIsRejected();
+    return Check::result();
+}
@@ -0,0 +1,88 @@
+#include <cstdint>
+#include "Check.hpp"
+#include "InputQueue.hpp"
+
+namespace {
+
+/**
+ * @brief Builds an input holding one key.
+ *
+ * @param sequence The input's sequence number.
+ * @param action The held key.
+ * @return Protocol::InputPayload The input.
+ */
+Protocol::InputPayload makeInput(std::uint32_t sequence, InputAction action = InputAction::RIGHT) {
+    Protocol::InputPayload input;
+    input.sequence = sequence;
+    input.press(action);
+    return input;
+}
+
+void testNothingBeforeFirstInput() {
+    InputQueue queue;
+    Protocol::InputPayload input;
+    CHECK(!queue.next(input));
+}
+
+void testInputsInOrder() {
+    InputQueue queue;
+    Protocol::InputPayload input;
+    for (std::uint32_t sequence = 0; sequence < 3; ++sequence) {
+        CHECK(queue.push(makeInput(sequence)));
+        CHECK(queue.next(input) && input.sequence == sequence);
+    }
+}
+
+void testLateInputIsStoodInFor() {
+    InputQueue queue;
+    Protocol::InputPayload input;
+    CHECK(queue.push(makeInput(0, InputAction::UP)));
+    CHECK(queue.next(input) && input.sequence == 0);
+
+    // Input 1 is late: the keys of input 0 stand in for it, under its sequence number
+    CHECK(queue.next(input));
+    CHECK(input.sequence == 1 && input.isHeld(InputAction::UP));
+
+    // Once it arrives, it is dropped rather than applied a second time
+    CHECK(queue.push(makeInput(1, InputAction::UP)));
+    CHECK(queue.push(makeInput(2, InputAction::DOWN)));
+    CHECK(queue.next(input));
+    CHECK(input.sequence == 2 && input.isHeld(InputAction::DOWN));
+}
+
+void testStalledClientStandsStill() {
+    InputQueue queue;
+    Protocol::InputPayload input;
+    CHECK(queue.push(makeInput(0)));
+    CHECK(queue.next(input));
+    for (unsigned repeat = 1; repeat <= InputQueue::MAX_REPEATS; ++repeat)
+        CHECK(queue.next(input) && input.sequence == repeat && input.isHeld(InputAction::RIGHT));
+
+    // Past MAX_REPEATS, no key is held and the acknowledged sequence no longer advances
+    CHECK(queue.next(input));
+    CHECK(input.buttons == 0 && input.sequence == InputQueue::MAX_REPEATS);
+
+    CHECK(queue.push(makeInput(InputQueue::MAX_REPEATS + 1)));
+    CHECK(queue.next(input) && input.sequence == InputQueue::MAX_REPEATS + 1 && input.isHeld(InputAction::RIGHT));
+}
+
+void testBacklogIsBounded() {
+    InputQueue queue;
+    Protocol::InputPayload input;
+    for (std::uint32_t sequence = 0; sequence < 10; ++sequence)
+        CHECK(queue.push(makeInput(sequence)));
+    CHECK(queue.next(input) && input.sequence == 10 - 1 - InputQueue::MAX_BACKLOG);
+    for (std::uint32_t sequence = 10 - InputQueue::MAX_BACKLOG; sequence < 10; ++sequence)
+        CHECK(queue.next(input) && input.sequence == sequence);
+}
+
+}  // namespace
+
+int main() {
+    testNothingBeforeFirstInput();
+    testInputsInOrder();
+    testLateInputIsStoodInFor();
+    testStalledClientStandsStill();
+    testBacklogIsBounded();
+    return Check::result();
+}
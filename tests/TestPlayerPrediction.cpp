@@ -0,0 +1,120 @@
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "Check.hpp"
+#include "InputQueue.hpp"
+#include "PlayerMovement.hpp"
+#include "PlayerPrediction.hpp"
+
+namespace {
+
+constexpr std::int32_t PLAYER = 7;          ///< Entity of the predicted player.
+constexpr float START_X = 100.0f;           ///< Where the player starts.
+constexpr float START_Y = 100.0f;           ///< Where the player starts.
+constexpr unsigned SNAPSHOT_DELAY = 2;      ///< Ticks a snapshot takes to reach the client.
+
+/**
+ * @struct ServerPlayer
+ * @brief The server's side of one player: its queued inputs and its authoritative position.
+ */
+struct ServerPlayer {
+    InputQueue inputs;  ///< Inputs received from the client.
+    float x = START_X;  ///< Authoritative X coordinate.
+    float y = START_Y;  ///< Authoritative Y coordinate.
+
+    /**
+     * @brief Applies the input of a tick, like Match::processClientInputs, and takes the snapshot.
+     *
+     * @param sequence The snapshot's sequence number.
+     * @return Snapshot The snapshot of the tick.
+     */
+    Snapshot tick(std::uint32_t sequence) {
+        Snapshot snapshot;
+        snapshot.sequence = sequence;
+        Protocol::InputPayload input;
+        if (inputs.next(input)) {
+            PlayerMovement::apply(input, x, y);
+            snapshot.inputAcks.push_back({PLAYER, input.sequence});
+        }
+        snapshot.states.push_back({PLAYER, x, y});
+        return snapshot;
+    }
+};
+
+/**
+ * @brief Gets the keys the client holds at a tick.
+ *
+ * @param tick The tick.
+ * @return Protocol::InputPayload The input sampled at the tick, stamped with the tick as sequence.
+ */
+Protocol::InputPayload sample(std::uint32_t tick) {
+    Protocol::InputPayload input;
+    input.sequence = tick;
+    input.press(InputAction::RIGHT);
+    if (tick >= 6 && tick <= 9)
+        input.press(InputAction::DOWN);
+    return input;
+}
+
+/**
+ * @brief Gets the tick an input reaches the server at.
+ *
+ * @param sequence The input's sequence number.
+ * @return std::uint32_t The tick: the one it was sampled at, except for the late inputs.
+ */
+std::uint32_t arrival(std::uint32_t sequence) {
+    if (sequence == 3)
+        return 4;  // One tick late
+    if (sequence == 11 || sequence == 12)
+        return 13;  // Two inputs late, stood in for by MAX_REPEATS repeats
+    return sequence;
+}
+
+void testLateInputsDoNotSnapTheShip() {
+    constexpr std::uint32_t TICKS = 20;
+    ServerPlayer server;
+    PlayerPrediction prediction;
+    prediction.setPlayer(PLAYER);
+    Snapshot initial;
+    initial.states.push_back({PLAYER, START_X, START_Y});
+    Protocol::EntityState predicted;
+    CHECK(prediction.reconcile(initial, predicted));
+
+    // What the player sees with no server at all: every sample applied once, in order
+    float localX = START_X;
+    float localY = START_Y;
+    std::vector<Protocol::InputPayload> sent;
+    std::deque<std::pair<std::uint32_t, Snapshot>> inFlight;
+    bool smooth = true;
+    for (std::uint32_t tick = 0; tick < TICKS; ++tick) {
+        Protocol::InputPayload input = sample(tick);
+        sent.push_back(input);
+        PlayerMovement::apply(input, localX, localY);
+        CHECK(prediction.predict(input, predicted));
+        smooth = smooth && predicted.x == localX && predicted.y == localY;
+
+        for (const Protocol::InputPayload& queued : sent) {
+            if (arrival(queued.sequence) == tick)
+                CHECK(server.inputs.push(queued));
+        }
+        inFlight.emplace_back(tick + SNAPSHOT_DELAY, server.tick(tick));
+        while (!inFlight.empty() && inFlight.front().first == tick) {
+            CHECK(prediction.reconcile(inFlight.front().second, predicted));
+            smooth = smooth && predicted.x == localX && predicted.y == localY;
+            inFlight.pop_front();
+        }
+    }
+    CHECK(smooth);
+    CHECK(server.x == localX && server.y == localY);
+    for (auto& [at, snapshot] : inFlight)
+        CHECK(prediction.reconcile(snapshot, predicted));
+    CHECK(predicted.x == server.x && predicted.y == server.y);
+    CHECK(prediction.getPendingCount() == 0);
+}
+
+}  // namespace
+
+int main() {
+    testLateInputsDoNotSnapTheShip();
+    return Check::result();
+}
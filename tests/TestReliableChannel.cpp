@@ -0,0 +1,331 @@
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Check.hpp"
+#include "ReliableChannel.hpp"
+
+namespace {
+
+using Clock = ReliableChannel::Clock;
+using namespace std::chrono_literals;
+
+/**
+ * @struct Peer
+ * @brief A channel and the entity IDs of the ENTITY_DEAD messages it delivered.
+ */
+struct Peer {
+    ReliableChannel channel;               ///< The channel under test.
+    std::vector<std::int32_t> deliveries;  ///< Delivered messages, in delivery order.
+};
+
+/**
+ * @brief Queues an ENTITY_DEAD message carrying an ID.
+ *
+ * @param peer The sending peer.
+ * @param id The ID to carry.
+ * @return true if the channel accepted the message, false otherwise.
+ */
+bool send(Peer& peer, std::int32_t id) {
+    Protocol::EntityDeadPayload death;
+    death.entityId = id;
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::EntityDeadPayload::SIZE> buffer;
+    return peer.channel.send(std::span(buffer.data(), Message::serialize(death, buffer)));
+}
+
+/**
+ * @brief Builds every packet a peer owes at a given time.
+ *
+ * @param peer The sending peer.
+ * @param now The current time.
+ * @return std::vector<std::vector<std::uint8_t>> The packets, in the order they were built.
+ */
+std::vector<std::vector<std::uint8_t>> collect(Peer& peer, Clock::time_point now) {
+    std::vector<std::vector<std::uint8_t>> packets;
+    std::array<std::uint8_t, ReliableChannel::MAX_PACKET_SIZE> buffer;
+    while (std::size_t size = peer.channel.writePacket(now, buffer))
+        packets.emplace_back(buffer.begin(), buffer.begin() + size);
+    return packets;
+}
+
+/**
+ * @brief Hands a packet to a peer.
+ *
+ * @param peer The receiving peer.
+ * @param packet The packet bytes.
+ * @param now The current time.
+ * @return true if the packet was well-formed, false otherwise.
+ */
+bool deliver(Peer& peer, const std::vector<std::uint8_t>& packet, Clock::time_point now) {
+    Message message;
+    if (!Message::deserialize(packet, message))
+        return false;
+    return peer.channel.receive(message, now, [&peer](const Message& delivered) {
+        Protocol::EntityDeadPayload death;
+        if (delivered.decode(death))
+            peer.deliveries.push_back(death.entityId);
+    });
+}
+
+/**
+ * @brief Exchanges every due packet between two peers, without loss, until both are idle.
+ *
+ * @param a The first peer.
+ * @param b The second peer.
+ * @param now The current time.
+ */
+void pump(Peer& a, Peer& b, Clock::time_point now) {
+    for (int round = 0; round < 8; ++round) {
+        auto fromA = collect(a, now);
+        auto fromB = collect(b, now);
+        if (fromA.empty() && fromB.empty())
+            return;
+        for (const auto& packet : fromA)
+            deliver(b, packet, now);
+        for (const auto& packet : fromB)
+            deliver(a, packet, now);
+    }
+}
+
+/**
+ * @brief Checks that a peer delivered consecutive IDs from 0, in order, each once.
+ *
+ * @param peer The receiving peer.
+ * @param count The number of IDs expected, starting at 0.
+ * @return true if the deliveries are exactly 0, 1, ..., count - 1.
+ */
+bool deliveredInOrder(const Peer& peer, std::int32_t count) {
+    if (peer.deliveries.size() != static_cast<std::size_t>(count))
+        return false;
+    for (std::int32_t i = 0; i < count; ++i) {
+        if (peer.deliveries[i] != i)
+            return false;
+    }
+    return true;
+}
+
+void testLosslessDelivery() {
+    Peer a, b;
+    Clock::time_point now{};
+    for (std::int32_t i = 0; i < 100; ++i)
+        CHECK(send(a, i));
+    CHECK(a.channel.getPendingCount() == 100);
+    pump(a, b, now);
+    CHECK(deliveredInOrder(b, 100));
+    CHECK(a.channel.getPendingCount() == 0);
+    CHECK(a.channel.getResentCount() == 0);
+    CHECK(collect(a, now).empty());
+}
+
+void testLossIsResentAfterTimeout() {
+    Peer a, b;
+    Clock::time_point now{};
+    CHECK(send(a, 0));
+    CHECK(send(a, 1));
+    CHECK(collect(a, now).size() == 1);  // Lost
+    CHECK(collect(a, now + 10ms).empty());
+
+    now += RttEstimator::INITIAL_TIMEOUT;
+    pump(a, b, now);
+    CHECK(deliveredInOrder(b, 2));
+    CHECK(a.channel.getResentCount() == 2);
+    CHECK(a.channel.getPendingCount() == 0);
+}
+
+void testNoAcknowledgementBeforeReceipt() {
+    Peer a, b;
+    Clock::time_point now{};
+    CHECK(send(a, 0));
+    CHECK(collect(a, now).size() == 1);  // Lost
+
+    // b received nothing yet: its packet must not acknowledge a's packet 0
+    CHECK(send(b, 1));
+    auto packets = collect(b, now + 20ms);
+    CHECK(packets.size() == 1);
+    CHECK(deliver(a, packets.front(), now + 20ms));
+    CHECK(a.deliveries.size() == 1);
+    CHECK(a.channel.getPendingCount() == 1);
+    CHECK(a.channel.getRtt().getSmoothed() == Clock::duration::zero());
+
+    now += RttEstimator::INITIAL_TIMEOUT;
+    pump(a, b, now);
+    CHECK(deliveredInOrder(b, 1));
+    CHECK(a.channel.getResentCount() == 1);
+    CHECK(a.channel.getPendingCount() == 0);
+}
+
+void testReorderAndDuplicates() {
+    Peer a, b;
+    Clock::time_point now{};
+    std::vector<std::vector<std::uint8_t>> packets;
+    for (std::int32_t i = 0; i < 3; ++i) {
+        CHECK(send(a, i));
+        auto built = collect(a, now);
+        CHECK(built.size() == 1);
+        packets.push_back(built.front());
+    }
+
+    CHECK(deliver(b, packets[2], now));
+    CHECK(deliver(b, packets[1], now));
+    CHECK(b.deliveries.empty());  // Held back behind message 0
+    CHECK(deliver(b, packets[0], now));
+    CHECK(deliveredInOrder(b, 3));
+    CHECK(deliver(b, packets[1], now));
+    CHECK(deliver(b, packets[0], now));
+    CHECK(deliveredInOrder(b, 3));
+
+    for (const auto& packet : collect(b, now))
+        deliver(a, packet, now);
+    CHECK(a.channel.getPendingCount() == 0);
+}
+
+void testLostAcknowledgementIsRepeated() {
+    Peer a, b;
+    Clock::time_point now{};
+    CHECK(send(a, 0));
+    for (const auto& packet : collect(a, now))
+        deliver(b, packet, now);
+    CHECK(collect(b, now).size() == 1);  // B's acknowledgement is lost
+
+    CHECK(send(a, 1));
+    for (const auto& packet : collect(a, now))
+        deliver(b, packet, now);
+    for (const auto& packet : collect(b, now))
+        deliver(a, packet, now);
+    CHECK(deliveredInOrder(b, 2));
+    CHECK(a.channel.getPendingCount() == 0);  // Message 0 acknowledged by the bitfield
+    CHECK(a.channel.getResentCount() == 0);
+}
+
+void testWindowAndSizeLimits() {
+    Peer a, b;
+    Clock::time_point now{};
+    for (std::size_t i = 0; i < ReliableChannel::WINDOW; ++i)
+        CHECK(send(a, static_cast<std::int32_t>(i)));
+    CHECK(!send(a, -1));
+    CHECK(a.channel.getPendingCount() == ReliableChannel::WINDOW);
+
+    std::vector<std::uint8_t> large(ReliableChannel::MAX_MESSAGE_SIZE + 1, 0);
+    Peer c;
+    CHECK(!c.channel.send(large));
+
+    pump(a, b, now);
+    CHECK(deliveredInOrder(b, static_cast<std::int32_t>(ReliableChannel::WINDOW)));
+    CHECK(send(a, static_cast<std::int32_t>(ReliableChannel::WINDOW)));
+}
+
+void testIdWrapAround() {
+    constexpr std::int32_t COUNT = 70000;  // Past 2^16 message IDs and packet sequences
+    Peer a, b;
+    Clock::time_point now{};
+    std::int32_t next = 0;
+    while (next < COUNT) {
+        for (int i = 0; i < 8 && next < COUNT; ++i)
+            CHECK(send(a, next++));
+        pump(a, b, now);
+        now += 1ms;
+    }
+    CHECK(deliveredInOrder(b, COUNT));
+    CHECK(a.channel.getPendingCount() == 0);
+    CHECK(a.channel.getResentCount() == 0);
+}
+
+void testLossyLinkDeliversInOrder() {
+    constexpr std::int32_t COUNT = 2000;
+    Peer a, b;
+    Clock::time_point now{};
+    std::int32_t next = 0;
+    unsigned counter = 0;
+    std::vector<std::vector<std::uint8_t>> delayed;
+    for (int tick = 0; tick < 20000 && (b.deliveries.size() < COUNT || a.channel.getPendingCount() > 0); ++tick) {
+        for (int i = 0; i < 4 && next < COUNT; ++i) {
+            if (send(a, next))
+                ++next;
+        }
+        // Every third packet is lost, both ways, and every fifth one from A arrives a tick late
+        auto fromA = collect(a, now);
+        auto fromB = collect(b, now);
+        for (const auto& packet : delayed)
+            deliver(b, packet, now);
+        delayed.clear();
+        for (const auto& packet : fromA) {
+            ++counter;
+            if (counter % 3 == 0)
+                continue;
+            if (counter % 5 == 0)
+                delayed.push_back(packet);
+            else
+                deliver(b, packet, now);
+        }
+        for (const auto& packet : fromB) {
+            if (++counter % 3 != 0)
+                deliver(a, packet, now);
+        }
+        now += 16ms;
+    }
+    CHECK(deliveredInOrder(b, COUNT));
+    CHECK(a.channel.getPendingCount() == 0);
+    CHECK(a.channel.getResentCount() > 0);
+}
+
+void testRttEstimator() {
+    RttEstimator rtt;
+    CHECK(rtt.getTimeout() == RttEstimator::INITIAL_TIMEOUT);
+    rtt.sample(100ms);
+    CHECK(rtt.getSmoothed() == 100ms);
+    CHECK(rtt.getTimeout() == 300ms);  // 100 + 4 * 50
+    CHECK(rtt.getTimeout(2) == 600ms);
+    CHECK(rtt.getTimeout(20) == RttEstimator::MAX_TIMEOUT);
+    for (int i = 0; i < 100; ++i)
+        rtt.sample(1ms);
+    CHECK(rtt.getTimeout() == RttEstimator::MIN_TIMEOUT);
+}
+
+void testRttSampledFromAcknowledgement() {
+    Peer a, b;
+    Clock::time_point now{};
+    CHECK(send(a, 0));
+    for (const auto& packet : collect(a, now))
+        deliver(b, packet, now + 30ms);
+    for (const auto& packet : collect(b, now + 30ms))
+        deliver(a, packet, now + 60ms);
+    CHECK(a.channel.getRtt().getSmoothed() == 60ms);
+}
+
+void testMalformedPacketIsRejected() {
+    Peer a, b;
+    Clock::time_point now{};
+    CHECK(send(a, 0));
+    auto packets = collect(a, now);
+    CHECK(packets.size() == 1);
+    std::vector<std::uint8_t> truncated(packets.front().begin(), packets.front().end() - 2);
+    truncated[Protocol::PAYLOAD_SIZE_OFFSET] = static_cast<std::uint8_t>(truncated.size() - Protocol::HEADER_SIZE);
+    truncated[Protocol::PAYLOAD_SIZE_OFFSET + 1] = 0;
+    CHECK(!deliver(b, truncated, now));
+    CHECK(b.deliveries.empty());
+
+    Protocol::EntityDeadPayload death;
+    std::array<std::uint8_t, Protocol::HEADER_SIZE + Protocol::EntityDeadPayload::SIZE> buffer;
+    Message::serialize(death, buffer);
+    Message notPacket;
+    CHECK(Message::deserialize(buffer, notPacket));
+    CHECK(!b.channel.receive(notPacket, now, [](const Message&) {}));
+}
+
+}  // namespace
+
+int main() {
+    testLosslessDelivery();
+    testLossIsResentAfterTimeout();
+    testNoAcknowledgementBeforeReceipt();
+    testReorderAndDuplicates();
+    testLostAcknowledgementIsRepeated();
+    testWindowAndSizeLimits();
+    testIdWrapAround();
+    testLossyLinkDeliversInOrder();
+    testRttEstimator();
+    testRttSampledFromAcknowledgement();
+    testMalformedPacketIsRejected();
+    return Check::result();
+}
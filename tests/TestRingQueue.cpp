@@ -0,0 +1,128 @@
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "RingQueue.hpp"
+
+namespace {
+
+void testSpscOrderAndBounds() {
+    SpscRing<int, 4> ring;
+    int value = 0;
+    CHECK(!ring.tryPop(value));
+    for (int i = 0; i < 4; ++i)
+        CHECK(ring.tryPush(i));
+    CHECK(!ring.tryPush(4));
+    CHECK(ring.size() == 4);
+
+    // Many laps, so the indices wrap around the slots repeatedly
+    for (int i = 4; i < 1000; ++i) {
+        CHECK(ring.tryPop(value) && value == i - 4);
+        CHECK(ring.tryPush(i));
+    }
+    for (int i = 996; i < 1000; ++i)
+        CHECK(ring.tryPop(value) && value == i);
+    CHECK(!ring.tryPop(value));
+    CHECK(ring.size() == 0);
+}
+
+void testSpscAcrossThreads() {
+    constexpr int COUNT = 200000;
+    SpscRing<int, 64> ring;
+    std::thread producer([&ring] {
+        for (int i = 0; i < COUNT; ++i) {
+            while (!ring.tryPush(i))
+                std::this_thread::yield();
+        }
+    });
+    int expected = 0;
+    int value = 0;
+    while (expected < COUNT) {
+        if (!ring.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (value != expected)
+            break;
+        ++expected;
+    }
+    producer.join();
+    CHECK(expected == COUNT);
+}
+
+void testMpscOrderAndBounds() {
+    MpscRing<int, 4> ring;
+    int value = 0;
+    CHECK(!ring.tryPop(value));
+    for (int i = 0; i < 4; ++i)
+        CHECK(ring.tryPush(int(i)));
+    CHECK(!ring.tryPush(4));
+    for (int i = 4; i < 1000; ++i) {
+        CHECK(ring.tryPop(value) && value == i - 4);
+        CHECK(ring.tryPush(int(i)));
+    }
+    for (int i = 996; i < 1000; ++i)
+        CHECK(ring.tryPop(value) && value == i);
+    CHECK(!ring.tryPop(value));
+}
+
+void testMpscReleasesPoppedElements() {
+    MpscRing<std::shared_ptr<int>, 2> ring;
+    std::shared_ptr<int> element = std::make_shared<int>(7);
+    CHECK(ring.tryPush(std::shared_ptr<int>(element)));
+    CHECK(element.use_count() == 2);
+    std::shared_ptr<int> popped;
+    CHECK(ring.tryPop(popped) && *popped == 7);
+    popped.reset();
+    CHECK(element.use_count() == 1);
+}
+
+void testMpscAcrossThreads() {
+    constexpr int PRODUCERS = 4;
+    constexpr int COUNT = 50000;
+    MpscRing<int, 128> ring;
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < PRODUCERS; ++producer) {
+        producers.emplace_back([&ring, producer] {
+            for (int i = 0; i < COUNT; ++i) {
+                while (!ring.tryPush(producer * COUNT + i))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    // Each producer's elements must come out in the order it pushed them
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    bool ordered = true;
+    int value = 0;
+    while (received < PRODUCERS * COUNT) {
+        if (!ring.tryPop(value)) {
+            std::this_thread::yield();
+            continue;
+        }
+        int producer = value / COUNT;
+        ordered = ordered && producer >= 0 && producer < PRODUCERS && value % COUNT == next[producer];
+        if (producer >= 0 && producer < PRODUCERS)
+            ++next[producer];
+        ++received;
+    }
+    for (std::thread& producer : producers)
+        producer.join();
+    CHECK(ordered);
+    CHECK(!ring.tryPop(value));
+    for (int count : next)
+        CHECK(count == COUNT);
+}
+
+}  // namespace
+
+int main() {
+    testSpscOrderAndBounds();
+    testSpscAcrossThreads();
+    testMpscOrderAndBounds();
+    testMpscReleasesPoppedElements();
+    testMpscAcrossThreads();
+    return Check::result();
+}
@@ -0,0 +1,306 @@
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Check.hpp"
+#include "Datagram.hpp"
+#include "Snapshot.hpp"
+#include "SnapshotStream.hpp"
+
+namespace {
+
+/**
+ * @brief Checks that a decoded snapshot matches the encoded one, up to quantization.
+ *
+ * @param decoded The snapshot rebuilt by the receiver.
+ * @param expected The snapshot the sender encoded.
+ * @return true if both hold the same entities at the same quantized positions and the same acknowledgements.
+ */
+bool matches(const Snapshot& decoded, const Snapshot& expected) {
+    float tolerance = Protocol::DEFAULT_POSITION_QUANTIZATION.maxError() * 1.01f;
+    if (decoded.states.size() != expected.states.size() || decoded.inputAcks.size() != expected.inputAcks.size())
+        return false;
+    for (std::size_t i = 0; i < expected.states.size(); ++i) {
+        const Protocol::EntityState& a = decoded.states[i];
+        const Protocol::EntityState& b = expected.states[i];
+        if (a.entityId != b.entityId || std::fabs(a.x - b.x) > tolerance || std::fabs(a.y - b.y) > tolerance)
+            return false;
+    }
+    for (std::size_t i = 0; i < expected.inputAcks.size(); ++i) {
+        if (decoded.inputAcks[i].entityId != expected.inputAcks[i].entityId || decoded.inputAcks[i].sequence != expected.inputAcks[i].sequence)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Encodes a delta and applies it back onto its baseline.
+ *
+ * @param baseline The acknowledged snapshot.
+ * @param current The snapshot to send.
+ * @param out Filled with the rebuilt snapshot.
+ * @return std::size_t The encoded size, or 0 if encoding or applying failed.
+ */
+std::size_t roundTrip(const Snapshot& baseline, const Snapshot& current, Snapshot& out) {
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> buffer;
+    std::size_t size = Protocol::StateDelta::encode(baseline, current, buffer);
+    Message message;
+    if (size == 0 || !Message::deserialize(std::span(buffer.data(), size), message) || message.type() != RFC::STATE_DELTA)
+        return 0;
+    std::uint32_t baselineSequence = 0;
+    if (!Protocol::StateDelta::baselineOf(message, baselineSequence) || baselineSequence != baseline.sequence)
+        return 0;
+    return Protocol::StateDelta::apply(message, baseline, out) ? size : 0;
+}
+
+Snapshot makeBaseline() {
+    Snapshot snapshot;
+    snapshot.sequence = 41;
+    snapshot.states = {{1, 100.0f, 200.0f}, {2, 300.0f, 400.0f}, {3, 500.0f, 600.0f}, {9, 10.0f, 20.0f}};
+    snapshot.inputAcks = {{1, 7}};
+    return snapshot;
+}
+
+void testDeltaRoundTrip() {
+    Snapshot baseline = makeBaseline();
+    Snapshot current = baseline;
+    current.sequence = 42;
+    current.states[0].x = 104.0f;                                         // Moved along X only
+    current.states[2].y = 612.5f;                                         // Moved along Y only
+    current.states.erase(current.states.begin() + 1);                     // Entity 2 removed
+    current.states.push_back({5, 1000.0f, 900.0f});                       // Entity 5 appeared
+    current.states.push_back({70000, -100.0f, 1080.0f});                  // Large ID gap
+    current.inputAcks = {{1, 8}, {5, 1}};
+    current.sort();
+
+    Snapshot out;
+    CHECK(roundTrip(baseline, current, out) != 0);
+    CHECK(matches(out, current));
+}
+
+void testUnchangedDeltaIsSmall() {
+    Snapshot baseline = makeBaseline();
+    Snapshot current = baseline;
+    current.sequence = 42;
+
+    Snapshot out;
+    std::size_t size = roundTrip(baseline, current, out);
+    CHECK(size != 0);
+    CHECK(matches(out, current));
+
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> full;
+    Protocol::StateUpdateWriter update(full);
+    for (const Protocol::EntityState& state : current.states)
+        update.add(state);
+    update.setInputAcks(current.inputAcks);
+    CHECK(size < update.finish());
+}
+
+void testMovementBelowQuantizationIsOmitted() {
+    Snapshot baseline = makeBaseline();
+    Snapshot still = baseline;
+    still.sequence = 42;
+    still.states[0].x += Protocol::DEFAULT_POSITION_QUANTIZATION.x.step() / 10.0f;
+
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> stillBuffer;
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> sameBuffer;
+    Snapshot same = baseline;
+    same.sequence = 42;
+    CHECK(Protocol::StateDelta::encode(baseline, still, stillBuffer) == Protocol::StateDelta::encode(baseline, same, sameBuffer));
+}
+
+void testDeltaFromEmptyBaseline() {
+    Snapshot baseline;
+    baseline.sequence = 0;
+    Snapshot current = makeBaseline();
+
+    Snapshot out;
+    CHECK(roundTrip(baseline, current, out) != 0);
+    CHECK(matches(out, current));
+
+    Snapshot empty;
+    empty.sequence = 43;
+    CHECK(roundTrip(current, empty, out) != 0);
+    CHECK(out.states.empty());
+}
+
+void testDeltaRejectsWrongBaseline() {
+    Snapshot baseline = makeBaseline();
+    Snapshot current = baseline;
+    current.sequence = 42;
+    current.states[0].x = 150.0f;
+
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> buffer;
+    std::size_t size = Protocol::StateDelta::encode(baseline, current, buffer);
+    Message message;
+    CHECK(Message::deserialize(std::span(buffer.data(), size), message));
+
+    Snapshot other = baseline;
+    other.sequence = 40;
+    Snapshot out;
+    CHECK(!Protocol::StateDelta::apply(message, other, out));
+}
+
+void testDeltaRejectsTruncatedPayload() {
+    Snapshot baseline = makeBaseline();
+    Snapshot current = baseline;
+    current.sequence = 42;
+    current.states.push_back({12, 700.0f, 800.0f});
+
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> buffer;
+    std::size_t size = Protocol::StateDelta::encode(baseline, current, buffer);
+    Message message;
+    CHECK(Message::deserialize(std::span(buffer.data(), size), message));
+    Snapshot out;
+    for (std::size_t length = 0; length < message.payload.size(); ++length) {
+        Message truncated = message;
+        truncated.payload = message.payload.first(length);
+        CHECK(!Protocol::StateDelta::apply(truncated, baseline, out));
+    }
+}
+
+void testDeltaRejectsSmallBuffer() {
+    Snapshot baseline;
+    Snapshot current = makeBaseline();
+    std::array<std::uint8_t, 12> buffer;
+    CHECK(Protocol::StateDelta::encode(baseline, current, buffer) == 0);
+}
+
+void testStateUpdateRoundTrip() {
+    Snapshot current = makeBaseline();
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> buffer;
+    Protocol::StateUpdateWriter update(buffer);
+    for (const Protocol::EntityState& state : current.states)
+        CHECK(update.add(state));
+    update.setInputAcks(current.inputAcks);
+    std::size_t size = update.finish();
+
+    Message message;
+    CHECK(Message::deserialize(std::span(buffer.data(), size), message));
+    Snapshot out;
+    CHECK(Protocol::decodeStateUpdate(message, out));
+    CHECK(matches(out, current));
+}
+
+void testHistoryEviction() {
+    SnapshotHistory history;
+    for (std::uint32_t sequence = 0; sequence <= 40; ++sequence)
+        history.push(sequence).states.push_back({static_cast<std::int32_t>(sequence), 0.0f, 0.0f});
+    CHECK(history.find(0) == nullptr);
+    CHECK(history.find(8) == nullptr);
+    CHECK(history.find(9) != nullptr);
+    CHECK(history.find(40) != nullptr && history.find(40)->states.front().entityId == 40);
+    CHECK(history.find(41) == nullptr);
+
+    history.push(0xFFFFFFFFu);
+    CHECK(history.find(0xFFFFFFFFu) != nullptr);
+    history.clear();
+    CHECK(history.find(40) == nullptr);
+}
+
+void testSequenceWrapAround() {
+    CHECK(Datagram::isNewer(1, 0));
+    CHECK(!Datagram::isNewer(0, 1));
+    CHECK(!Datagram::isNewer(5, 5));
+    CHECK(Datagram::isNewer(0, 0xFFFFFFFFu));
+    CHECK(Datagram::isNewer(10, 0xFFFFFFF0u));
+    CHECK(!Datagram::isNewer(0xFFFFFFF0u, 10));
+    CHECK(Datagram::isNewer(0x7FFFFFFFu, 0));
+    CHECK(!Datagram::isNewer(0x80000000u, 0));
+}
+
+void testDatagramFraming() {
+    std::array<std::uint8_t, 16> buffer{};
+    CHECK(Datagram::encodeHeader(0xDEADBEEFu, buffer));
+    buffer[Datagram::HEADER_SIZE] = 42;
+
+    std::uint32_t sequence = 0;
+    std::span<const std::uint8_t> message;
+    CHECK(Datagram::decode(buffer, sequence, message));
+    CHECK(sequence == 0xDEADBEEFu);
+    CHECK(message.size() == buffer.size() - Datagram::HEADER_SIZE && message[0] == 42);
+    CHECK(!Datagram::decode(std::span(buffer.data(), Datagram::HEADER_SIZE - 1), sequence, message));
+    CHECK(!Datagram::encodeHeader(1, std::span(buffer.data(), Datagram::HEADER_SIZE - 1)));
+}
+
+/**
+ * @brief Wraps an encoded message in a datagram.
+ *
+ * @param sequence The datagram's sequence number.
+ * @param message The encoded message.
+ * @return std::vector<std::uint8_t> The datagram bytes.
+ */
+std::vector<std::uint8_t> frame(std::uint32_t sequence, std::span<const std::uint8_t> message) {
+    std::vector<std::uint8_t> datagram(Datagram::HEADER_SIZE);
+    Datagram::encodeHeader(sequence, datagram);
+    datagram.insert(datagram.end(), message.begin(), message.end());
+    return datagram;
+}
+
+void testStreamDropsStaleAndAppliesDeltas() {
+    SnapshotStream stream;
+    std::array<std::uint8_t, SnapshotStream::PACKET_DATAGRAM_SIZE> packetBuffer;
+    std::vector<Snapshot> delivered;
+    std::vector<std::uint32_t> acknowledged;
+    auto receive = [&](const std::vector<std::uint8_t>& datagram) {
+        return stream.receive(
+            datagram, SnapshotStream::Clock::now(), packetBuffer, [&](const Snapshot& snapshot) { delivered.push_back(snapshot); },
+            [](const Message&) {},
+            [&](std::span<const std::uint8_t> reply) {
+                std::uint32_t sequence = 0;
+                std::span<const std::uint8_t> bytes;
+                Message message;
+                Protocol::SnapshotAckPayload ack;
+                if (Datagram::decode(reply, sequence, bytes) && Message::deserialize(bytes, message) && message.decode(ack))
+                    acknowledged.push_back(ack.sequence);
+            });
+    };
+
+    Snapshot baseline = makeBaseline();
+    std::array<std::uint8_t, Protocol::MAX_MESSAGE_SIZE> buffer;
+    Protocol::StateUpdateWriter update(buffer);
+    for (const Protocol::EntityState& state : baseline.states)
+        update.add(state);
+    update.setInputAcks(baseline.inputAcks);
+    std::vector<std::uint8_t> full = frame(baseline.sequence, std::span(buffer.data(), update.finish()));
+
+    Snapshot current = baseline;
+    current.sequence = 42;
+    current.states[0].x = 150.0f;
+    std::vector<std::uint8_t> delta = frame(current.sequence, std::span(buffer.data(), Protocol::StateDelta::encode(baseline, current, buffer)));
+
+    CHECK(!stream.isReceiving());
+    CHECK(!receive(delta));  // Baseline not received yet
+    CHECK(receive(full));
+    CHECK(stream.isReceiving());
+    CHECK(receive(delta));
+    CHECK(!receive(full));  // Older than the delta
+    CHECK(!receive(delta));  // Duplicate
+    CHECK(!receive(std::vector<std::uint8_t>(Datagram::HEADER_SIZE - 1, 0)));
+    CHECK(delivered.size() == 2 && matches(delivered[0], baseline) && matches(delivered[1], current));
+    CHECK(acknowledged.size() == 2 && acknowledged[0] == baseline.sequence && acknowledged[1] == current.sequence);
+
+    stream.reset();
+    CHECK(!stream.isReceiving());
+    CHECK(!receive(delta));  // Baselines forgotten
+    CHECK(receive(full));
+}
+
+}  // namespace
+
+int main() {
+    testDeltaRoundTrip();
+    testUnchangedDeltaIsSmall();
+    testMovementBelowQuantizationIsOmitted();
+    testDeltaFromEmptyBaseline();
+    testDeltaRejectsWrongBaseline();
+    testDeltaRejectsTruncatedPayload();
+    testDeltaRejectsSmallBuffer();
+    testStateUpdateRoundTrip();
+    testHistoryEviction();
+    testSequenceWrapAround();
+    testDatagramFraming();
+    testStreamDropsStaleAndAppliesDeltas();
+    return Check::result();
+}